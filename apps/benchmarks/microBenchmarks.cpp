@@ -0,0 +1,281 @@
+#include <TFile.h>
+#include <TRandom3.h>
+#include <TTree.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <unistd.h>
+
+#include "ArgsManager.hpp"
+#include "ConfigManager.hpp"
+#include "CutFlowManager.hpp"
+#include "EventReader.hpp"
+#include "EventWriter.hpp"
+#include "HistogramsHandler.hpp"
+#include "Logger.hpp"
+#include "ScaleFactorsManager.hpp"
+
+using namespace std;
+
+// Measures the time per call of the framework's inner-loop operations, to catch regressions before they show up in
+// full jobs. Fixtures (a small NanoAOD-like file, a correctionlib json and a config) are created in a temporary
+// directory when the app starts, so it doesn't need any input:
+//
+//   ./microBenchmarks [--filter Event] [--output_path micro_benchmarks.json]
+
+const int nFixtureEvents = 1000;
+const int nMuonsPerEvent = 4;
+const int nRepetitions = 5;
+const double minRepetitionTime = 0.1;  // seconds
+
+// Prevents the compiler from optimizing away results which are not used otherwise
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchmarkResult {
+  string name;
+  double nsPerOperation;
+  long long nOperations;
+};
+
+class MicroBenchmarks {
+ public:
+  MicroBenchmarks(string filter_) : filter(filter_) {}
+
+  // Runs the function (which performs operationsPerCall operations) in batches until a repetition takes at least
+  // minRepetitionTime, and keeps the fastest of nRepetitions repetitions
+  void Run(string name, function<void()> function, int operationsPerCall = 1) {
+    if (!filter.empty() && name.find(filter) == string::npos) return;
+
+    long long nCalls = 1;
+    double bestTime = numeric_limits<double>::max();
+    long long nCallsForBest = 1;
+
+    for (int iRepetition = 0; iRepetition < nRepetitions;) {
+      auto start = now();
+      for (long long i = 0; i < nCalls; i++) function();
+      double time = duration(start, now());
+
+      if (time < minRepetitionTime) {
+        nCalls *= 2;
+        continue;
+      }
+      if (time / nCalls < bestTime / nCallsForBest) {
+        bestTime = time;
+        nCallsForBest = nCalls;
+      }
+      iRepetition++;
+    }
+
+    long long nOperations = nCallsForBest * operationsPerCall;
+    results.push_back({name, 1e9 * bestTime / nOperations, nOperations});
+    info() << setw(45) << left << name << setw(12) << right << fixed << setprecision(1) << results.back().nsPerOperation
+           << " ns" << endl;
+  }
+
+  void Save(string outputPath) {
+    nlohmann::json output = nlohmann::json::array();
+    for (auto &result : results) {
+      output.push_back({{"name", result.name}, {"ns_per_operation", result.nsPerOperation}, {"n_operations", result.nOperations}});
+    }
+    ofstream outputFile(outputPath);
+    outputFile << output.dump(2) << endl;
+    info() << "Results stored in " << outputPath << endl;
+  }
+
+ private:
+  string filter;
+  vector<BenchmarkResult> results;
+};
+
+void CreateInputFile(string path) {
+  auto file = new TFile(path.c_str(), "recreate");
+  auto tree = new TTree("Events", "Events");
+
+  UInt_t run = 1;
+  ULong64_t event;
+  Float_t metPt, genWeight;
+  Bool_t trigger;
+  Int_t nMuon = nMuonsPerEvent;
+  Float_t muonPt[nMuonsPerEvent], muonEta[nMuonsPerEvent], muonPhi[nMuonsPerEvent];
+  Int_t muonCharge[nMuonsPerEvent];
+
+  tree->Branch("run", &run, "run/i");
+  tree->Branch("event", &event, "event/l");
+  tree->Branch("MET_pt", &metPt, "MET_pt/F");
+  tree->Branch("genWeight", &genWeight, "genWeight/F");
+  tree->Branch("HLT_IsoMu24", &trigger, "HLT_IsoMu24/O");
+  tree->Branch("nMuon", &nMuon, "nMuon/I");
+  tree->Branch("Muon_pt", muonPt, "Muon_pt[nMuon]/F");
+  tree->Branch("Muon_eta", muonEta, "Muon_eta[nMuon]/F");
+  tree->Branch("Muon_phi", muonPhi, "Muon_phi[nMuon]/F");
+  tree->Branch("Muon_charge", muonCharge, "Muon_charge[nMuon]/I");
+
+  TRandom3 random(1);
+  for (int iEvent = 0; iEvent < nFixtureEvents; iEvent++) {
+    event = iEvent;
+    metPt = random.Exp(30);
+    genWeight = 1;
+    trigger = random.Uniform() < 0.5;
+    for (int i = 0; i < nMuon; i++) {
+      muonPt[i] = 5 + random.Exp(20);
+      muonEta[i] = random.Uniform(-2.4, 2.4);
+      muonPhi[i] = random.Uniform(-3.14, 3.14);
+      muonCharge[i] = random.Uniform() < 0.5 ? -1 : 1;
+    }
+    tree->Fill();
+  }
+  file->cd();
+  tree->Write();
+  file->Close();
+}
+
+// A correction in the format of muon POG scale factors: abseta x pt bins, with nominal value and variations
+void CreateCorrectionFile(string path) {
+  vector<double> etaEdges = {0, 0.9, 1.2, 2.1, 2.4};
+  vector<double> ptEdges = {15, 20, 25, 30, 40, 50, 60, 120};
+
+  nlohmann::json etaBins = nlohmann::json::array();
+  for (size_t iEta = 0; iEta + 1 < etaEdges.size(); iEta++) {
+    nlohmann::json ptBins = nlohmann::json::array();
+    for (size_t iPt = 0; iPt + 1 < ptEdges.size(); iPt++) {
+      double value = 0.95 + 0.01 * iEta + 0.001 * iPt;
+      ptBins.push_back({{"nodetype", "category"},
+                        {"input", "scale_factors"},
+                        {"content",
+                         {{{"key", "nominal"}, {"value", value}},
+                          {{"key", "systup"}, {"value", value + 0.01}},
+                          {{"key", "systdown"}, {"value", value - 0.01}}}}});
+    }
+    etaBins.push_back(
+        {{"nodetype", "binning"}, {"input", "pt"}, {"edges", ptEdges}, {"flow", "clamp"}, {"content", ptBins}});
+  }
+
+  nlohmann::json correction = {
+      {"name", "NUM_TightID_DEN_TrackerMuons"},
+      {"version", 1},
+      {"inputs",
+       {{{"name", "abseta"}, {"type", "real"}}, {{"name", "pt"}, {"type", "real"}}, {{"name", "scale_factors"}, {"type", "string"}}}},
+      {"output", {{"name", "weight"}, {"type", "real"}}},
+      {"data", {{"nodetype", "binning"}, {"input", "abseta"}, {"edges", etaEdges}, {"flow", "clamp"}, {"content", etaBins}}},
+  };
+  nlohmann::json correctionSet = {{"schema_version", 2}, {"corrections", {correction}}};
+
+  ofstream file(path);
+  file << correctionSet.dump() << endl;
+}
+
+void CreateConfig(string path, filesystem::path fixturesDir) {
+  ofstream config(path);
+  config << "nEvents = -1\n"
+         << "inputFilePath = \"" << (fixturesDir / "events.root").string() << "\"\n"
+         << "treeOutputFilePath = \"" << (fixturesDir / "output_trees.root").string() << "\"\n"
+         << "histogramsOutputFilePath = \"" << (fixturesDir / "output_histograms.root").string() << "\"\n"
+         << "weightsBranchName = \"genWeight\"\n"
+         << "extraEventCollections = {\n"
+         << "  \"GoodMuons\": {\"inputCollections\": (\"Muon\",), \"pt\": (20., 9999999.), \"eta\": (-2.4, 2.4)},\n"
+         << "}\n"
+         << "defaultHistParams = (\n"
+         << "  (\"Muon\", \"pt\", 400, 0, 200, \"\"),\n"
+         << "  (\"Event\", \"MET_pt\", 400, 0, 200, \"\"),\n"
+         << ")\n"
+         << "applyScaleFactors = {\"muon\": [True, True]}\n"
+         << "scaleFactors = {\n"
+         << "  \"muonIDTight\": {\n"
+         << "    \"path\": \"" << (fixturesDir / "corrections.json").string() << "\",\n"
+         << "    \"type\": \"NUM_TightID_DEN_TrackerMuons\",\n"
+         << "    \"systematic\": \"nominal\",\n"
+         << "    \"variations\": \"systup,systdown\",\n"
+         << "  },\n"
+         << "}\n";
+}
+
+int main(int argc, char **argv) {
+  vector<string> requiredArgs = {};
+  vector<string> optionalArgs = {"filter", "output_path"};
+  auto args = make_unique<ArgsManager>(argc, argv, requiredArgs, optionalArgs);
+
+  auto fixturesDir = filesystem::temp_directory_path() / ("tea_micro_benchmarks_" + to_string(getpid()));
+  filesystem::create_directories(fixturesDir);
+  CreateInputFile((fixturesDir / "events.root").string());
+  CreateCorrectionFile((fixturesDir / "corrections.json").string());
+  CreateConfig((fixturesDir / "config.py").string(), fixturesDir);
+  ConfigManager::Initialize((fixturesDir / "config.py").string());
+
+  auto eventReader = make_shared<EventReader>();
+  auto eventWriter = make_shared<EventWriter>(eventReader);
+  auto histogramsHandler = make_shared<HistogramsHandler>();
+  auto cutFlowManager = make_shared<CutFlowManager>(eventReader, eventWriter);
+  auto &scaleFactorsManager = ScaleFactorsManager::GetInstance();
+  int initialCutId = cutFlowManager->RegisterCut("initial");
+  eventReader->SetShowProgress(false);
+
+  auto event = eventReader->GetEvent(0);
+  auto muons = event->GetCollection("Muon");
+  auto muon = muons->at(0);
+
+  MicroBenchmarks benchmarks(args->GetString("filter").value_or(""));
+  info() << "Time per operation:" << endl;
+
+  int iEvent = 0;
+  benchmarks.Run("EventReader::GetEvent", [&]() { DoNotOptimize(eventReader->GetEvent(iEvent++ % nFixtureEvents)); });
+  event = eventReader->GetEvent(0);
+
+  benchmarks.Run("Event::Get", [&]() {
+    float value = event->Get("MET_pt");
+    DoNotOptimize(value);
+  });
+  benchmarks.Run("Event::GetAs<float>", [&]() { DoNotOptimize(event->GetAs<float>("MET_pt")); });
+  benchmarks.Run("Event::GetAs<double> (conversion)", [&]() { DoNotOptimize(event->GetAs<double>("MET_pt")); });
+  benchmarks.Run("Event::GetCollection", [&]() { DoNotOptimize(event->GetCollection("Muon")); });
+  benchmarks.Run("Event::GetCollection (extra, built)", [&]() { DoNotOptimize(event->GetCollection("GoodMuons")); });
+
+  benchmarks.Run("PhysicsObject::Get", [&]() {
+    float value = muon->Get("pt");
+    DoNotOptimize(value);
+  });
+  benchmarks.Run("PhysicsObject::GetAs<float>", [&]() { DoNotOptimize(muon->GetAs<float>("pt")); });
+  benchmarks.Run("PhysicsObject::GetAs<double> (conversion)", [&]() { DoNotOptimize(muon->GetAs<double>("pt")); });
+
+  benchmarks.Run("Collection iteration (per object)", [&]() {
+    for (auto &object : *muons) DoNotOptimize(object);
+  }, nMuonsPerEvent);
+  benchmarks.Run("Collection iteration + GetAs (per object)", [&]() {
+    float sum = 0;
+    for (auto &object : *muons) sum += object->GetAs<float>("pt");
+    DoNotOptimize(sum);
+  }, nMuonsPerEvent);
+
+  float value = 0;
+  benchmarks.Run("HistogramsHandler::Fill", [&]() { histogramsHandler->Fill("Muon_pt", value += 0.1); });
+  auto muonPtHistogram = histogramsHandler->GetHandle("Muon_pt");
+  benchmarks.Run("HistogramHandle::Fill", [&]() { muonPtHistogram.Fill(value += 0.1); });
+
+  benchmarks.Run("CutFlowManager::UpdateCutFlow", [&]() { cutFlowManager->UpdateCutFlow("initial"); });
+  benchmarks.Run("CutFlowManager::UpdateCutFlow (ID)", [&]() { cutFlowManager->UpdateCutFlow(initialCutId); });
+
+  benchmarks.Run("EventWriter::AddCurrentEvent", [&]() { eventWriter->AddCurrentEvent("Events"); });
+
+  float muonEta = muon->GetAs<float>("eta");
+  float muonPt = muon->GetAs<float>("pt");
+  benchmarks.Run("ScaleFactorsManager::GetMuonScaleFactors", [&]() {
+    DoNotOptimize(scaleFactorsManager.GetMuonScaleFactors("muonIDTight", muonEta, muonPt));
+  });
+
+  vector<float> muonEtas(nMuonsPerEvent, muonEta), muonPts(nMuonsPerEvent, muonPt);
+  ScaleFactorsBatch muonBatch;
+  benchmarks.Run("ScaleFactorsManager::GetMuonScaleFactors (batch)", [&]() {
+    scaleFactorsManager.GetMuonScaleFactors("muonIDTight", muonEtas.data(), muonPts.data(), nMuonsPerEvent, muonBatch);
+    DoNotOptimize(muonBatch.products);
+  }, nMuonsPerEvent);
+
+  auto outputPath = args->GetString("output_path");
+  if (outputPath.has_value()) benchmarks.Save(outputPath.value());
+
+  filesystem::remove_all(fixturesDir);
+  return 0;
+}
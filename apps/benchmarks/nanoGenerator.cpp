@@ -0,0 +1,182 @@
+#include <Compression.h>
+#include <TFile.h>
+#include <TMath.h>
+#include <TRandom3.h>
+#include <TTree.h>
+
+#include "ArgsManager.hpp"
+#include "ConfigManager.hpp"
+#include "EventReader.hpp"
+#include "Logger.hpp"
+
+using namespace std;
+
+// Writes a NanoAOD-like Events tree filled with random values, to benchmark tea apps without access to real data.
+// The number of events, collections, branches and compression settings are taken from the config
+// (see configs/benchmarks/benchmark_generator_config.py). The same config and seed always give the same file.
+
+// Generated collection: multiplicity fluctuates around the mean (Poisson) up to the maximum, and objects have
+// pt/eta/phi/mass/charge plus extra float variables up to the requested number of branches
+struct GeneratedCollection {
+  string name;
+  float meanMultiplicity;
+  int maxMultiplicity;
+  int nExtraBranches;
+
+  Int_t size;
+  vector<Float_t> pt, eta, phi, mass;
+  vector<Int_t> charge;
+  vector<vector<Float_t>> extraVariables;
+};
+
+int GetCompressionAlgorithm(string name) {
+  map<string, int> algorithms = {
+      {"ZLIB", ROOT::RCompressionSetting::EAlgorithm::kZLIB},
+      {"LZMA", ROOT::RCompressionSetting::EAlgorithm::kLZMA},
+      {"LZ4", ROOT::RCompressionSetting::EAlgorithm::kLZ4},
+      {"ZSTD", ROOT::RCompressionSetting::EAlgorithm::kZSTD},
+  };
+  if (algorithms.count(name) == 0) {
+    fatal() << "Unknown compression algorithm: " << name << " (options: ZLIB, LZMA, LZ4, ZSTD)" << endl;
+    exit(1);
+  }
+  return algorithms[name];
+}
+
+vector<GeneratedCollection> GetCollections(ConfigManager &config) {
+  map<string, vector<float>> collectionsParams;
+  config.GetMap("collections", collectionsParams);
+
+  vector<GeneratedCollection> collections;
+  for (auto &[name, params] : collectionsParams) {
+    if (params.size() != 3) {
+      fatal() << "Collection " << name << " should be defined as (mean multiplicity, max multiplicity, n branches)" << endl;
+      exit(1);
+    }
+    GeneratedCollection collection;
+    collection.name = name;
+    collection.meanMultiplicity = params[0];
+    collection.maxMultiplicity = (int)params[1];
+    collection.nExtraBranches = max(0, (int)params[2] - 5);
+    collections.push_back(collection);
+  }
+  return collections;
+}
+
+void SetupBranches(TTree *tree, GeneratedCollection &collection) {
+  int maxSize = collection.maxMultiplicity;
+  string sizeName = "n" + collection.name;
+  auto leafList = [&](string variable, string type) { return collection.name + "_" + variable + "[" + sizeName + "]/" + type; };
+
+  collection.pt.resize(maxSize);
+  collection.eta.resize(maxSize);
+  collection.phi.resize(maxSize);
+  collection.mass.resize(maxSize);
+  collection.charge.resize(maxSize);
+  collection.extraVariables.assign(collection.nExtraBranches, vector<Float_t>(maxSize));
+
+  tree->Branch(sizeName.c_str(), &collection.size, (sizeName + "/I").c_str());
+  tree->Branch((collection.name + "_pt").c_str(), collection.pt.data(), leafList("pt", "F").c_str());
+  tree->Branch((collection.name + "_eta").c_str(), collection.eta.data(), leafList("eta", "F").c_str());
+  tree->Branch((collection.name + "_phi").c_str(), collection.phi.data(), leafList("phi", "F").c_str());
+  tree->Branch((collection.name + "_mass").c_str(), collection.mass.data(), leafList("mass", "F").c_str());
+  tree->Branch((collection.name + "_charge").c_str(), collection.charge.data(), leafList("charge", "I").c_str());
+
+  for (int i = 0; i < collection.nExtraBranches; i++) {
+    string variable = "var" + to_string(i);
+    tree->Branch((collection.name + "_" + variable).c_str(), collection.extraVariables[i].data(),
+                 leafList(variable, "F").c_str());
+  }
+}
+
+void FillCollection(TRandom3 &random, GeneratedCollection &collection) {
+  collection.size = min(random.Poisson(collection.meanMultiplicity), collection.maxMultiplicity);
+
+  for (int i = 0; i < collection.size; i++) {
+    collection.pt[i] = 5 + random.Exp(20);
+    collection.eta[i] = random.Uniform(-2.5, 2.5);
+    collection.phi[i] = random.Uniform(-TMath::Pi(), TMath::Pi());
+    collection.mass[i] = random.Exp(5);
+    collection.charge[i] = random.Uniform() < 0.5 ? -1 : 1;
+    for (auto &values : collection.extraVariables) values[i] = random.Gaus();
+  }
+}
+
+int main(int argc, char **argv) {
+  vector<string> requiredArgs = {"config"};
+  vector<string> optionalArgs = {"output_trees_path"};
+  auto args = make_unique<ArgsManager>(argc, argv, requiredArgs, optionalArgs);
+  ConfigManager::Initialize(args);
+  auto &config = ConfigManager::GetInstance();
+
+  int nEvents, nEventBranches, nTriggerBranches, compressionLevel, seed;
+  string outputFilePath, compressionAlgorithm;
+  config.GetValue("nEvents", nEvents);
+  config.GetValue("treeOutputFilePath", outputFilePath);
+  config.GetValue("nEventBranches", nEventBranches);
+  config.GetValue("nTriggerBranches", nTriggerBranches);
+  config.GetValue("compressionAlgorithm", compressionAlgorithm);
+  config.GetValue("compressionLevel", compressionLevel);
+  config.GetValue("seed", seed);
+
+  auto collections = GetCollections(config);
+
+  auto outputFile = new TFile(outputFilePath.c_str(), "recreate");
+  outputFile->SetCompressionSettings(
+      ROOT::CompressionSettings((ROOT::RCompressionSetting::EAlgorithm::EValues)GetCompressionAlgorithm(compressionAlgorithm),
+                                compressionLevel));
+  auto tree = new TTree("Events", "Events");
+
+  UInt_t run, luminosityBlock;
+  ULong64_t event;
+  Float_t genWeight, metPt, metPhi;
+  vector<Float_t> eventVariables(nEventBranches);
+  // std::vector<bool> doesn't give access to its elements' addresses
+  unique_ptr<Bool_t[]> triggers(new Bool_t[nTriggerBranches]);
+
+  tree->Branch("run", &run, "run/i");
+  tree->Branch("luminosityBlock", &luminosityBlock, "luminosityBlock/i");
+  tree->Branch("event", &event, "event/l");
+  tree->Branch("genWeight", &genWeight, "genWeight/F");
+  tree->Branch("MET_pt", &metPt, "MET_pt/F");
+  tree->Branch("MET_phi", &metPhi, "MET_phi/F");
+  for (int i = 0; i < nEventBranches; i++) {
+    string name = "Event_var" + to_string(i);
+    tree->Branch(name.c_str(), &eventVariables[i], (name + "/F").c_str());
+  }
+  for (int i = 0; i < nTriggerBranches; i++) {
+    string name = "HLT_Trigger" + to_string(i);
+    tree->Branch(name.c_str(), &triggers[i], (name + "/O").c_str());
+  }
+  for (auto &collection : collections) SetupBranches(tree, collection);
+
+  TRandom3 random(seed);
+  info() << "Generating " << nEvents << " events with " << collections.size() << " collections to " << outputFilePath
+         << endl;
+
+  for (int iEvent = 0; iEvent < nEvents; iEvent++) {
+    if (iEvent % 10000 == 0 || iEvent == nEvents - 1) EventReader::PrintProgress(iEvent, nEvents);
+
+    run = 1;
+    luminosityBlock = 1 + iEvent / 1000;
+    event = iEvent;
+    genWeight = random.Uniform() < 0.05 ? -1 : 1;
+    metPt = random.Exp(30);
+    metPhi = random.Uniform(-TMath::Pi(), TMath::Pi());
+    for (auto &value : eventVariables) value = random.Gaus();
+    for (int i = 0; i < nTriggerBranches; i++) triggers[i] = random.Uniform() < 0.3;
+    for (auto &collection : collections) FillCollection(random, collection);
+
+    tree->Fill();
+  }
+
+  outputFile->cd();
+  tree->Write();
+  outputFile->Close();
+  info() << "Output file: " << outputFilePath << endl;
+
+  auto &logger = Logger::GetInstance();
+  logger.Print();
+
+  return 0;
+}
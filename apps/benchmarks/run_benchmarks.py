@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+# Measures throughput of tea apps on a synthetic NanoAOD-like file (generated with nanoGenerator if it doesn't exist
+# yet). For each app, it reports events/s and MB/s read in the event loop, peak RSS and startup time (the time it
+# takes to run on a single event). Results are printed and stored in a json file, so that they can be compared
+# between commits:
+#
+#   python3 run_benchmarks.py --work_dir ../benchmarks --settings nThreads=4 lazyBranchLoading=True
+
+import argparse
+import json
+import os
+from pathlib import Path
+import re
+import statistics
+import subprocess
+import time
+
+from Logger import info, error, fatal
+
+
+BYTES_READ_PATTERN = re.compile(r"bytes read: (\d+) MB")
+
+
+def get_args():
+  script_dir = Path(os.path.abspath(__file__)).parent
+
+  parser = argparse.ArgumentParser(description="Runs tea apps on synthetic NanoAOD-like files and reports throughput")
+  parser.add_argument("--bin_dir", type=str, default=str(script_dir), help="directory with tea executables")
+  parser.add_argument("--configs_dir", type=str, default=str(script_dir), help="directory with benchmark configs")
+  parser.add_argument("--work_dir", type=str, default="benchmarks", help="directory for generated files and logs")
+  parser.add_argument("--apps", type=str, nargs="+", default=["histogrammer", "skimmer"], help="apps to benchmark")
+  parser.add_argument("--settings", type=str, nargs="*", default=[],
+                      help="config values to override in all app configs, e.g. nThreads=4 treeCacheSize=50")
+  parser.add_argument("--repeat", type=int, default=3, help="number of runs of each app (the median is reported)")
+  parser.add_argument("--regenerate", action="store_true", help="regenerate the input file even if it exists")
+  parser.add_argument("--generate_only", action="store_true", help="only generate the input file")
+  parser.add_argument("--output", type=str, default="benchmark_results.json", help="output json file name")
+  return parser.parse_args()
+
+
+def run(command, log_path):
+  """Runs the command, returning wall time (s) and peak RSS (MB) of the process"""
+  with open(log_path, "w") as log_file:
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stdout=log_file, stderr=subprocess.STDOUT)
+    _, status, usage = os.wait4(process.pid, 0)
+    wall_time = time.perf_counter() - start
+
+  if os.waitstatus_to_exitcode(status) != 0:
+    fatal(f"Command failed (see {log_path}): {' '.join(command)}")
+    exit(1)
+
+  # ru_maxrss is in kB on Linux and in bytes on macOS
+  peak_rss = usage.ru_maxrss / 1024 if os.uname().sysname != "Darwin" else usage.ru_maxrss / 1024**2
+  return wall_time, peak_rss
+
+
+def get_bytes_read(log_path):
+  """Bytes read as reported by the app (only printed with the TTreeCache enabled), None otherwise"""
+  with open(log_path) as log_file:
+    matches = BYTES_READ_PATTERN.findall(log_file.read())
+  return float(matches[-1]) if matches else None
+
+
+def get_n_events(input_path):
+  import ROOT
+  input_file = ROOT.TFile.Open(str(input_path))
+  n_events = input_file.Get("Events").GetEntries()
+  input_file.Close()
+  return n_events
+
+
+def write_config(base_config_path, output_path, settings):
+  with open(base_config_path) as base_config:
+    config = base_config.read()
+  config += "\n# added by run_benchmarks.py\n"
+  for key, value in settings.items():
+    config += f"{key} = {value}\n"
+  with open(output_path, "w") as output_config:
+    output_config.write(config)
+
+
+def generate_input(args, work_dir):
+  input_path = work_dir / "nano_benchmark.root"
+  if input_path.exists() and not args.regenerate:
+    info(f"Using existing input file: {input_path}")
+    return input_path
+
+  info(f"Generating input file: {input_path}")
+  command = [str(Path(args.bin_dir) / "nanoGenerator"),
+             "--config", str(Path(args.configs_dir) / "benchmark_generator_config.py"),
+             "--output_trees_path", str(input_path)]
+  wall_time, _ = run(command, work_dir / "nanoGenerator.log")
+  info(f"Input file generated in {wall_time:.1f} s")
+  return input_path
+
+
+def benchmark_app(args, app, input_path, n_events, work_dir):
+  settings = dict(setting.split("=", 1) for setting in args.settings)
+  base_config_path = Path(args.configs_dir) / f"benchmark_{app}_config.py"
+  output_arg = "--output_hists_path" if app == "histogrammer" else "--output_trees_path"
+
+  def run_app(name, n_events_to_process):
+    config_path = work_dir / f"{app}_{name}_config.py"
+    write_config(base_config_path, config_path, {**settings, "nEvents": n_events_to_process})
+    command = [str(Path(args.bin_dir) / app), "--config", str(config_path),
+               "--input_path", str(input_path), output_arg, str(work_dir / f"{app}_{name}_output.root")]
+    log_path = work_dir / f"{app}_{name}.log"
+    wall_time, peak_rss = run(command, log_path)
+    return wall_time, peak_rss, get_bytes_read(log_path)
+
+  startup_times = [run_app("startup", 1)[0] for _ in range(args.repeat)]
+  full_runs = [run_app("full", -1) for _ in range(args.repeat)]
+
+  startup_time = statistics.median(startup_times)
+  wall_time = statistics.median(full_run[0] for full_run in full_runs)
+  peak_rss = max(full_run[1] for full_run in full_runs)
+  loop_time = max(wall_time - startup_time, 1e-6)
+
+  # Without the I/O statistics from the app, all of the (compressed) input is assumed to be read
+  mb_read = full_runs[-1][2]
+  mb_read_source = "app"
+  if mb_read is None:
+    mb_read = input_path.stat().st_size / 1024**2
+    mb_read_source = "input file size"
+
+  return {
+      "app": app,
+      "settings": settings,
+      "n_events": n_events,
+      "startup_time_s": startup_time,
+      "wall_time_s": wall_time,
+      "events_per_s": n_events / loop_time,
+      "mb_read": mb_read,
+      "mb_read_source": mb_read_source,
+      "mb_per_s": mb_read / loop_time,
+      "peak_rss_mb": peak_rss,
+  }
+
+
+def main():
+  args = get_args()
+  work_dir = Path(args.work_dir).absolute()
+  work_dir.mkdir(parents=True, exist_ok=True)
+
+  input_path = generate_input(args, work_dir)
+  if args.generate_only:
+    return
+
+  n_events = get_n_events(input_path)
+
+  results = []
+  for app in args.apps:
+    info(f"Benchmarking {app} ({args.repeat} runs)...")
+    try:
+      results.append(benchmark_app(args, app, input_path, n_events, work_dir))
+    except FileNotFoundError as e:
+      error(f"Couldn't run {app}: {e}")
+
+  info(f"\n{'app':<15}{'events/s':>12}{'MB/s':>10}{'peak RSS (MB)':>15}{'startup (s)':>13}")
+  for result in results:
+    info(f"{result['app']:<15}{result['events_per_s']:>12.0f}{result['mb_per_s']:>10.1f}"
+         f"{result['peak_rss_mb']:>15.0f}{result['startup_time_s']:>13.2f}")
+
+  output_path = work_dir / args.output
+  with open(output_path, "w") as output_file:
+    json.dump(results, output_file, indent=2)
+  info(f"\nResults stored in {output_path}")
+
+
+if __name__ == "__main__":
+  main()
@@ -1,5 +1,6 @@
 #include "ConfigManager.hpp"
 #include "CutFlowManager.hpp"
+#include "EventLoop.hpp"
 #include "EventReader.hpp"
 #include "ExtensionsHelpers.hpp"
 #include "HistogramsFiller.hpp"
@@ -12,30 +13,48 @@
 
 using namespace std;
 
+// Everything filled in the event loop. With nThreads > 1 in the config, each thread gets its own worker.
+struct Worker {
+  Worker() {
+    eventReader = make_shared<EventReader>();
+    histogramsHandler = make_shared<HistogramsHandler>();
+    cutFlowManager = make_shared<CutFlowManager>(eventReader);
+    histogramsFiller = make_unique<HistogramsFiller>(histogramsHandler);
+    eventProcessor = make_unique<EventProcessor>();
+    nanoEventProcessor = make_unique<NanoEventProcessor>();
+
+    cutFlowManager->RegisterCut("initial");
+  }
+
+  void Merge(Worker &other) {
+    histogramsHandler->Merge(*other.histogramsHandler);
+    cutFlowManager->Merge(*other.cutFlowManager);
+  }
+
+  shared_ptr<EventReader> eventReader;
+  shared_ptr<HistogramsHandler> histogramsHandler;
+  shared_ptr<CutFlowManager> cutFlowManager;
+  unique_ptr<HistogramsFiller> histogramsFiller;
+  unique_ptr<EventProcessor> eventProcessor;
+  unique_ptr<NanoEventProcessor> nanoEventProcessor;
+};
+
 int main(int argc, char **argv) {
   vector<string> requiredArgs = {"config"};
   vector<string> optionalArgs = {"input_path", "output_hists_path"};
   auto args = make_unique<ArgsManager>(argc, argv, requiredArgs, optionalArgs);
   ConfigManager::Initialize(args);
   
-  auto eventReader = make_shared<EventReader>();
-  auto histogramsHandler = make_shared<HistogramsHandler>();
-  auto cutFlowManager = make_shared<CutFlowManager>(eventReader);
-  auto histogramsFiller = make_unique<HistogramsFiller>(histogramsHandler);
-  auto eventProcessor = make_unique<EventProcessor>();
-  auto nanoEventProcessor = make_unique<NanoEventProcessor>();
-
-  cutFlowManager->RegisterCut("initial");
-
-  for (int iEvent = 0; iEvent < eventReader->GetNevents(); iEvent++) {
-    auto event = eventReader->GetEvent(iEvent);
-    cutFlowManager->UpdateCutFlow("initial");
-    histogramsFiller->FillDefaultVariables(event);
-  }
+  EventLoop eventLoop;
+  auto worker = eventLoop.Run<Worker>([](int iWorker) { return make_shared<Worker>(); },
+                                      [](Worker &worker, const shared_ptr<Event> &event) {
+                                        worker.cutFlowManager->UpdateCutFlow("initial");
+                                        worker.histogramsFiller->FillDefaultVariables(event);
+                                      });
 
-  cutFlowManager->Print();
-  histogramsFiller->FillCutFlow(cutFlowManager);
-  histogramsHandler->SaveHistograms();
+  worker->cutFlowManager->Print();
+  worker->histogramsFiller->FillCutFlow(worker->cutFlowManager);
+  worker->histogramsHandler->SaveHistograms();
 
   auto &logger = Logger::GetInstance();
   logger.Print();
@@ -4,6 +4,7 @@
 
 #include "ConfigManager.hpp"
 #include "Event.hpp"
+#include "EventLoop.hpp"
 #include "EventReader.hpp"
 #include "ExtensionsHelpers.hpp"
 #include "EventWriter.hpp"
@@ -14,54 +15,77 @@
 
 using namespace std;
 
+// Everything filled in the event loop. With nThreads > 1 in the config, each thread gets its own worker writing events
+// to a separate part file, and the parts are merged into the output file at the end.
+struct Worker {
+  Worker(int iWorker, bool multithreaded) {
+    eventReader = make_shared<EventReader>();
+    eventWriter = make_shared<EventWriter>(eventReader, multithreaded ? iWorker : -1);
+    cutFlowManager = make_shared<CutFlowManager>(eventReader, eventWriter);
+    eventProcessor = make_unique<EventProcessor>();
+    nanoEventProcessor = make_unique<NanoEventProcessor>();
+
+    cutFlowManager->RegisterCut("initial");
+    cutFlowManager->RegisterCut("trigger");
+    eventProcessor->RegisterCuts(cutFlowManager);
+  }
+
+  void Merge(Worker &other) {
+    cutFlowManager->Merge(*other.cutFlowManager);
+    eventWriter->Merge(*other.eventWriter);
+  }
+
+  shared_ptr<EventReader> eventReader;
+  shared_ptr<EventWriter> eventWriter;
+  shared_ptr<CutFlowManager> cutFlowManager;
+  unique_ptr<EventProcessor> eventProcessor;
+  unique_ptr<NanoEventProcessor> nanoEventProcessor;
+};
+
+void ProcessEvent(Worker &worker, const shared_ptr<Event> &event) {
+  auto &cutFlowManager = worker.cutFlowManager;
+
+  cutFlowManager->UpdateCutFlow("initial");
+  if(!worker.eventProcessor->PassesTriggerCuts(event)) return;
+  cutFlowManager->UpdateCutFlow("trigger");
+
+  if(!worker.eventProcessor->PassesEventCuts(event, cutFlowManager)) return;
+
+  auto muons = event->GetCollection("Muon");
+  if (muons->size() >= 2) {
+    auto p1 = muons->at(0)->GetFourVector();
+    auto p2 = muons->at(1)->GetFourVector();
+    event->Set<float>("dimuonMass", static_cast<float>((p1 + p2).M()));
+  }
+
+  vector<float> muonPts;
+  for (auto &muon : *muons) muonPts.push_back(muon->GetAs<float>("pt"));
+  event->SetVector<float>("muonPt", muonPts);
+
+  // Branches declared without a varexp are only filled where the app sets them, and get a default
+  // value (zero) everywhere else - both for objects skipped here and for entire events skipped below
+  for (auto &muon : *muons) {
+    float pt = muon->GetAs<float>("pt");
+    if (pt > 30) muon->Set<float>("ptIfGood", pt);
+  }
+
+  worker.eventWriter->AddCurrentEvent("Events");
+}
+
 int main(int argc, char **argv) {
   vector<string> requiredArgs = {"config"};
   vector<string> optionalArgs = {"input_path", "output_trees_path"};
   auto args = make_unique<ArgsManager>(argc, argv, requiredArgs, optionalArgs);
   ConfigManager::Initialize(args);
   
-  auto eventReader = make_shared<EventReader>();
-  auto eventWriter = make_shared<EventWriter>(eventReader);
-  auto cutFlowManager = make_shared<CutFlowManager>(eventReader, eventWriter);
-  auto eventProcessor = make_unique<EventProcessor>();
-  auto nanoEventProcessor = make_unique<NanoEventProcessor>();
-  
-  cutFlowManager->RegisterCut("initial");
-  cutFlowManager->RegisterCut("trigger");
-  eventProcessor->RegisterCuts(cutFlowManager);
-
-  for (int iEvent = 0; iEvent < eventReader->GetNevents(); iEvent++) {    
-    auto event = eventReader->GetEvent(iEvent);
-
-    cutFlowManager->UpdateCutFlow("initial");
-    if(!eventProcessor->PassesTriggerCuts(event)) continue;
-    cutFlowManager->UpdateCutFlow("trigger");
-
-    if(!eventProcessor->PassesEventCuts(event, cutFlowManager)) continue;
-
-    auto muons = event->GetCollection("Muon");
-    if (muons->size() >= 2) {
-      auto p1 = muons->at(0)->GetFourVector();
-      auto p2 = muons->at(1)->GetFourVector();
-      event->Set<float>("dimuonMass", static_cast<float>((p1 + p2).M()));
-    }
-
-    vector<float> muonPts;
-    for (auto &muon : *muons) muonPts.push_back(muon->GetAs<float>("pt"));
-    event->SetVector<float>("muonPt", muonPts);
-
-    // Branches declared without a varexp are only filled where the app sets them, and get a default
-    // value (zero) everywhere else - both for objects skipped here and for entire events skipped below
-    for (auto &muon : *muons) {
-      float pt = muon->GetAs<float>("pt");
-      if (pt > 30) muon->Set<float>("ptIfGood", pt);
-    }
-
-    eventWriter->AddCurrentEvent("Events");
-  }
-  cutFlowManager->SaveCutFlow();
-  cutFlowManager->Print();
-  eventWriter->Save();
+  EventLoop eventLoop;
+  bool multithreaded = eventLoop.GetNthreads() > 1;
+  auto worker = eventLoop.Run<Worker>([multithreaded](int iWorker) { return make_shared<Worker>(iWorker, multithreaded); },
+                                      ProcessEvent);
+
+  worker->cutFlowManager->SaveCutFlow();
+  worker->cutFlowManager->Print();
+  worker->eventWriter->Save();
 
   return 0;
 }
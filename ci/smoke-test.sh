@@ -82,3 +82,83 @@ for i in range(n_entries):
             raise SystemExit(f"muonPt[{j}] ({muon_pts[j]}) != expected ({expected}) at entry {i}")
 skim_file.Close()
 PY
+
+# Skimming the skim again on two threads - cut flows read from the input have to be counted once, with events counted
+# by both workers added on top of them, giving the same result as on a single thread
+cat > "${output_dir}/skimmer_two_threads_config.py" <<PY
+exec(open("${source_dir}/configs/examples/skimmer_config.py").read())
+nThreads = 2
+PY
+
+"${bin_dir}/skimmer" \
+  --config "${source_dir}/configs/examples/skimmer_config.py" \
+  --input_path "${output_dir}/skim.root" \
+  --output_trees_path "${output_dir}/reskim_one_thread.root"
+
+"${bin_dir}/skimmer" \
+  --config "${output_dir}/skimmer_two_threads_config.py" \
+  --input_path "${output_dir}/skim.root" \
+  --output_trees_path "${output_dir}/reskim_two_threads.root"
+
+python3 - "${output_dir}/skim.root" "${output_dir}/reskim_one_thread.root" "${output_dir}/reskim_two_threads.root" <<'PY'
+import sys
+import ROOT
+
+
+def read_cut_flow(path, cut_flow_name):
+    root_file = ROOT.TFile.Open(path)
+    directory = root_file.Get(cut_flow_name)
+    if not directory:
+        raise SystemExit(f"{cut_flow_name} missing from {path}")
+    cut_flow = {key.GetName(): key.ReadObj().GetBinContent(1) for key in directory.GetListOfKeys()}
+    root_file.Close()
+    return cut_flow
+
+
+for cut_flow_name in ("CutFlow", "RawEventsCutFlow"):
+    input_cut_flow = read_cut_flow(sys.argv[1], cut_flow_name)
+    one_thread = read_cut_flow(sys.argv[2], cut_flow_name)
+    two_threads = read_cut_flow(sys.argv[3], cut_flow_name)
+
+    if one_thread.keys() != two_threads.keys():
+        raise SystemExit(f"{cut_flow_name} cuts differ between one ({one_thread.keys()}) and two threads ({two_threads.keys()})")
+    for cut_name, value in one_thread.items():
+        if abs(two_threads[cut_name] - value) > max(1e-3, abs(value) * 1e-5):
+            raise SystemExit(f"{cut_flow_name}/{cut_name} on two threads ({two_threads[cut_name]}) != one thread ({value})")
+    for cut_name, value in input_cut_flow.items():
+        if abs(two_threads[cut_name] - value) > max(1e-3, abs(value) * 1e-5):
+            raise SystemExit(f"{cut_flow_name}/{cut_name} from the input ({value}) changed to {two_threads[cut_name]}")
+PY
+
+# With a single cut recorded in cut masks, its N-1 count has to include all events reaching the event cuts, also those
+# failing it
+cat > "${output_dir}/skimmer_cut_masks_config.py" <<PY
+exec(open("${source_dir}/configs/examples/skimmer_config.py").read())
+eventCuts = {"MET_pt": (30, 9999999)}
+recordCutMasks = True
+PY
+
+"${bin_dir}/skimmer" \
+  --config "${output_dir}/skimmer_cut_masks_config.py" \
+  --input_path "${source_dir}/samples/background_dy.root" \
+  --output_trees_path "${output_dir}/skim_cut_masks.root"
+
+python3 - "${output_dir}/skim_cut_masks.root" <<'PY'
+import sys
+import ROOT
+
+root_file = ROOT.TFile.Open(sys.argv[1])
+reached = root_file.Get("RawEventsCutFlow/1_trigger").GetBinContent(1)
+passed = root_file.Get("RawEventsCutFlow/2_MET_pt").GetBinContent(1)
+
+n_minus_one = root_file.Get("CutMasks/nMinusOne").GetBinContent(1)
+if abs(n_minus_one - reached) > 1e-3:
+    raise SystemExit(f"N-1 count with a single cut ({n_minus_one}) != events reaching the event cuts ({reached})")
+
+masks_events = sum(entry.rawEvents for entry in root_file.Get("CutMasks/masks"))
+if abs(masks_events - reached) > 1e-3:
+    raise SystemExit(f"Events in cut masks ({masks_events}) != events reaching the event cuts ({reached})")
+if passed > reached:
+    raise SystemExit(f"More events passing MET_pt ({passed}) than reaching it ({reached})")
+root_file.Close()
+PY
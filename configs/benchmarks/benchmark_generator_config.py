@@ -0,0 +1,26 @@
+# Config for nanoGenerator, which writes a NanoAOD-like file with random values for benchmarks.
+# The same config always gives the same file, so throughput measured on it can be compared between commits.
+
+nEvents = 200000
+seed = 42
+
+treeOutputFilePath = "nano_benchmark.root"
+
+# Compression of the output file. Algorithm can be ZLIB, LZMA, LZ4 or ZSTD (NanoAOD uses LZMA level 9 for
+# data and ZSTD for newer productions):
+compressionAlgorithm = "ZSTD"
+compressionLevel = 5
+
+# Event-level branches: run, luminosityBlock, event, genWeight, MET_pt and MET_phi are always added,
+# plus nEventBranches float branches (Event_var0, ...) and nTriggerBranches bool branches (HLT_Trigger0, ...)
+nEventBranches = 50
+nTriggerBranches = 200
+
+# Collections to generate, as (mean multiplicity, max multiplicity, number of branches).
+# Each collection has the pt, eta, phi, mass and charge branches, and the rest are float branches var0, var1, ...
+collections = {
+  "Muon": (3, 20, 40),
+  "Electron": (2, 20, 40),
+  "Jet": (8, 50, 30),
+  "GenPart": (40, 200, 10),
+}
@@ -0,0 +1,45 @@
+# histogrammer config used by run_benchmarks.py, on files generated with benchmark_generator_config.py
+
+nEvents = -1
+
+inputFilePath = "nano_benchmark.root"
+histogramsOutputFilePath = "histograms_benchmark.root"
+
+weightsBranchName = "genWeight"
+
+extraEventCollections = {
+  "GoodMuons": {
+    "inputCollections": ("Muon",),
+    "pt": (20., 9999999.),
+    "eta": (-2.4, 2.4),
+  },
+  "GoodLeptons": {
+    "inputCollections": ("GoodMuons", "Electron"),
+    "pt": (30., 9999999.),
+  },
+  "GoodJets": {
+    "inputCollections": ("Jet",),
+    "pt": (30., 9999999.),
+    "eta": (-2.4, 2.4),
+  },
+}
+
+defaultHistParams = (
+  #  collection      variable          bins    xmin     xmax     dir
+  ("Event", "nMuon", 50, 0, 50, ""),
+  ("Event", "MET_pt", 200, 0, 500, ""),
+  ("Muon", "pt", 400, 0, 200, ""),
+  ("Muon", "eta", 100, -2.5, 2.5, ""),
+  ("Electron", "pt", 400, 0, 200, ""),
+  ("Jet", "pt", 400, 0, 500, ""),
+  ("Jet", "eta", 100, -2.5, 2.5, ""),
+  ("Event", "nGoodLeptons", 50, 0, 50, ""),
+  ("GoodLeptons", "pt", 400, 0, 200, ""),
+  ("Event", "nGoodJets", 50, 0, 50, ""),
+  ("GoodJets", "pt", 400, 0, 500, ""),
+)
+
+# The benchmark driver runs the app with different values of these to compare them:
+# nThreads = 1
+# lazyBranchLoading = False
+# treeCacheSize = 50
@@ -0,0 +1,31 @@
+# skimmer config used by run_benchmarks.py, on files generated with benchmark_generator_config.py
+
+nEvents = -1
+
+inputFilePath = "nano_benchmark.root"
+treeOutputFilePath = "skim_benchmark.root"
+
+triggerSelection = (
+  "HLT_Trigger0",
+  "HLT_Trigger1",
+)
+
+extraEventCollections = {
+  "GoodLeptons": {
+    "inputCollections": ("Muon", "Electron"),
+    "pt": (30., 9999999.),
+    "eta": (-2.4, 2.4),
+  },
+}
+
+eventCuts = {
+  "MET_pt": (20, 9999999),
+  "nGoodLeptons": (1, 9999999),
+}
+
+branchesToAdd = (
+  ("Event", "dimuonMass", "Float_t", "-1.0"),
+  ("Muon", "ptSquared", "Float_t", "Muon_pt**2"),
+  ("Muon", "ptIfGood", "Float_t", ""),
+  ("Event", "muonPt", "vector<Float_t>", ""),
+)
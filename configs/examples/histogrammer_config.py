@@ -20,10 +20,17 @@
 # year = "2018"
 # # options for year: 2016preVFP, 2016postVFP, 2017, 2018, 2022preEE, 2022postEE, 2023preBPix, 2023postBPix
 # scaleFactors = get_scale_factors(year)
+#
+# Corrections parsed from the JSON files can be cached in a directory (keyed by the hash of each file),
+# so that following jobs start without parsing the large JSON files again:
+# scaleFactorsCacheDir = "../tea/jsonPOG/cache"
 
 nEvents = -1
 
 inputFilePath = "../tea/samples/background_dy.root"
+# You can also give a glob pattern or a list of files, which will be read as one stream of events
+# (cut flows stored in the input files are summed):
+# inputFilePath = ["../tea/samples/background_dy.root", "../tea/samples/skims/*.root"]
 histogramsOutputFilePath = "../samples/histograms/background_dy.root"
 
 extraEventCollections = {
@@ -64,3 +71,17 @@ specialBranchSizes = {
 
 # Uncomment if you want to specify event weights (e.g. from MC generator):
 # weightsBranchName = "genWeight"
+
+# Uncomment to only read branches the app actually uses in a given event (instead of all branches of all trees).
+# Collection sizes, the weights branch and inputs of branchesToAdd are always read, you can add more branches here:
+# lazyBranchLoading = True
+# alwaysLoadBranches = ["run", "luminosityBlock"]
+
+# Number of threads for the event loop (0 to use all cores). Each thread processes a separate range of entries:
+# nThreads = 8
+
+# Uncomment to read the input through a TTreeCache of the given size (in MB), e.g. for remote files.
+# Branches used in the first treeCacheLearnEntries events are cached, and the next cluster is prefetched asynchronously:
+# treeCacheSize = 50
+# treeCacheLearnEntries = 100
+# asyncPrefetching = True
@@ -1,6 +1,9 @@
 nEvents = -1
 
 inputFilePath = "../tea/samples/background_dy.root"
+# You can also give a glob pattern or a list of files, which will be read as one stream of events
+# (cut flows stored in the input files are summed):
+# inputFilePath = ["../tea/samples/background_dy.root", "../tea/samples/skims/*.root"]
 treeOutputFilePath = "../samples/skimmed/background_dy.root"
 
 triggerSelection = (
@@ -21,6 +24,11 @@ eventCuts = {
     "nGoodLeptons": (1, 9999999),
 }
 
+# Uncomment to evaluate all eventCuts for every event, even after one of them failed, and save N-1 tables, cut
+# correlations and masks of passed cuts (from which cut flows in any order can be computed). This is slower, as
+# variables of all cuts (e.g. extra collections) have to be computed for every event.
+# recordCutMasks = True
+
 
 # First, branches to keep will be marked to be kept (empty tuple would result in no branches being kept)
 # branchesToKeep = (
@@ -48,3 +56,15 @@ branchesToAdd = (
 # weightsBranchName = "genWeight"
 
 # redirector = "xrootd-cms.infn.it"
+
+# Number of threads for the event loop (0 to use all cores). Each thread writes its own part of the output,
+# and parts are merged into treeOutputFilePath at the end:
+# nThreads = 8
+
+# Uncomment to read the input through a TTreeCache of the given size (in MB), which is useful for remote (xrootd) files.
+# The cache learns which branches are used during the first treeCacheLearnEntries events (works best with
+# lazyBranchLoading), and with asyncPrefetching the next cluster is fetched while the current one is processed.
+# The cache hit rate and the number of read calls are printed at the end of the job.
+# treeCacheSize = 50
+# treeCacheLearnEntries = 100
+# asyncPrefetching = True
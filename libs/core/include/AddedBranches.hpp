@@ -6,6 +6,7 @@
 #include "Event.hpp"
 #include "Helpers.hpp"
 
+class TChain;
 class TTreeFormula;
 
 class AddedBranches {
@@ -13,13 +14,19 @@ class AddedBranches {
   AddedBranches();
   ~AddedBranches();
 
-  void Setup(const std::vector<std::string> &eventsTreeNames, const std::map<std::string, TTree *> &inputTrees);
+  void Setup(const std::vector<std::string> &eventsTreeNames, const std::map<std::string, TChain *> &inputTrees);
 
-  // Must run after the event's collections have their visible size set (ChangeVisibleSize) and
-  // after AddExtraCollections, so per-object varexps see the same objects the app will.
+  // Has to be called whenever the input chain moves to the next file
+  void UpdateFormulaLeaves();
+
+  // Must run after the event's collections have their visible size set (ChangeVisibleSize), so per-object
+  // varexps see the same objects the app will. Extra collections are built here if a formula needs them.
   void Evaluate(const std::shared_ptr<Event> &event);
 
   const std::vector<AddedBranchParams> &GetSpecs() const { return specs; }
+
+  // Formulas are evaluated with quick load, so in lazy loading mode their inputs have to be read for every event
+  std::vector<std::string> GetInputBranchNames() const;
   bool Empty() const { return specs.empty(); }
 
  private:
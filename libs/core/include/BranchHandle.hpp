@@ -0,0 +1,67 @@
+//  BranchHandle.hpp
+
+#ifndef BranchHandle_hpp
+#define BranchHandle_hpp
+
+#include "BranchLoader.hpp"
+#include "ColumnarCollection.hpp"
+#include "Helpers.hpp"
+
+/// Typed accessor to an event-level branch. The branch name is resolved and its type is checked only once,
+/// when the handle is created with Event::Handle<T>(). After that, reading the value is a single dereference
+/// of a pointer into the event's storage, which stays valid for the whole lifetime of the EventReader.
+///
+///   auto metPt = event->Handle<Float_t>("MET_pt");   // before the event loop
+///   float pt = metPt.Get();                            // in the event loop
+template <typename T>
+class BranchHandle {
+ public:
+  BranchHandle() = default;
+  BranchHandle(const T *value_, std::string branchName_, BranchLoader *loader_ = nullptr)
+      : value(value_), branchName(branchName_), loader(loader_) {}
+
+  inline T Get() const {
+    if (loader) loader->Load();
+    return *value;
+  }
+  inline T operator*() const { return Get(); }
+
+  inline bool IsValid() const { return value != nullptr; }
+  inline const std::string &GetBranchName() const { return branchName; }
+
+ private:
+  const T *value = nullptr;
+  std::string branchName;
+  BranchLoader *loader = nullptr;  // only set in lazy loading mode
+};
+
+/// Typed accessor to a per-object variable of an input collection (e.g. Muon_pt), created with
+/// Event::ObjectHandle<T>("Muon", "pt") and read with PhysicsObject::Get(handle). It points to the column holding
+/// values of this variable for all objects in the collection, so reading it doesn't involve any string lookups.
+template <typename T>
+class ObjectBranchHandle {
+ public:
+  ObjectBranchHandle() = default;
+  ObjectBranchHandle(const ColumnarCollection *columns_, const Column *column_, std::string collectionName_,
+                     std::string variableName_)
+      : columns(columns_), column(column_), collectionName(collectionName_), variableName(variableName_) {}
+
+  inline T Get(int row) const { return Data()[row]; }
+  inline T operator[](int row) const { return Data()[row]; }
+
+  /// Values for all objects in the current event (valid until the next event is read)
+  inline const T *Data() const { return static_cast<const T *>(column->Data()); }
+
+  inline bool IsValid() const { return column != nullptr; }
+  inline const ColumnarCollection *GetColumns() const { return columns; }
+  inline const std::string &GetCollectionName() const { return collectionName; }
+  inline const std::string &GetVariableName() const { return variableName; }
+
+ private:
+  const ColumnarCollection *columns = nullptr;
+  const Column *column = nullptr;
+  std::string collectionName;
+  std::string variableName;
+};
+
+#endif /* BranchHandle_hpp */
@@ -0,0 +1,39 @@
+//  BranchLoader.hpp
+
+#ifndef BranchLoader_hpp
+#define BranchLoader_hpp
+
+#include "Helpers.hpp"
+
+/// Entry of an input tree that is currently being processed. The serial number changes with every event read, so that
+/// loaders can tell whether they are up to date without comparing entry numbers (which repeat between input files).
+struct LoadedEntry {
+  Long64_t entry = -1;
+  Long64_t serial = 0;
+};
+
+/// Used when lazy branch loading is enabled: reads the current entry of a single branch the first time the value is
+/// accessed in a given event, so that baskets of branches the app never touches are not read or decompressed.
+class BranchLoader {
+ public:
+  BranchLoader(TBranch *branch_, const LoadedEntry *currentEntry_) : branch(branch_), currentEntry(currentEntry_) {}
+
+  inline void Load() {
+    if (loadedSerial == currentEntry->serial) return;
+    branch->GetEntry(currentEntry->entry);
+    loadedSerial = currentEntry->serial;
+  }
+
+  inline TBranch *GetBranch() const { return branch; }
+  inline void SetBranch(TBranch *branch_) {
+    branch = branch_;
+    loadedSerial = -1;
+  }
+
+ private:
+  TBranch *branch;
+  const LoadedEntry *currentEntry;
+  Long64_t loadedSerial = -1;
+};
+
+#endif /* BranchLoader_hpp */
@@ -25,6 +25,7 @@ class Collection : public std::vector<T> {
   }
 
   size_t size() const { return stopIndex; }
+  size_t GetAllocatedSize() const { return std::vector<T>::size(); }
 
   class Iterator {
    public:
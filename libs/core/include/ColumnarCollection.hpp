@@ -0,0 +1,73 @@
+//  ColumnarCollection.hpp
+
+#ifndef ColumnarCollection_hpp
+#define ColumnarCollection_hpp
+
+#include "BranchLoader.hpp"
+#include "Helpers.hpp"
+
+/// Values of one variable for all objects of a collection, stored contiguously in the buffer the branch is read into.
+struct Column {
+  BranchType type = BranchType::kUnknown;  // type of the elements (vector<bool> branches are stored as UInt_t)
+  std::string branchName;  // full name of the input branch, e.g. Muon_pt
+  void *data = nullptr;    // first element of the buffer
+  BranchLoader *loader = nullptr;  // only set in lazy loading mode
+
+  // ROOT may reallocate std::vectors when reading them, so for such branches the data pointer is taken on every access
+  void *stdVector = nullptr;
+  void *(*getStdVectorData)(void *) = nullptr;
+
+  /// Returns the first element of the current event's values (reading the branch first in lazy loading mode)
+  inline const void *Data() const {
+    if (loader) loader->Load();
+    return stdVector ? getStdVectorData(stdVector) : data;
+  }
+};
+
+/// Structure-of-arrays storage of an input collection: one typed column per branch, plus the number of objects in the
+/// current event. Physics objects of the collection are lightweight views pointing to a row of these columns, so there
+/// are no per-object copies of branch names, types or pointers.
+class ColumnarCollection {
+ public:
+  ColumnarCollection(std::string name_) : name(name_) {}
+
+  inline const std::string &GetName() const { return name; }
+
+  inline size_t GetSize() const { return size; }
+  inline void SetSize(size_t size_) { size = size_; }
+
+  void AddColumn(const std::string &variableName, const std::string &branchName, BranchType type, void *data) {
+    Column &column = columns[variableName];
+    column.type = type;
+    column.branchName = branchName;
+    column.data = data;
+  }
+
+  template <typename T>
+  void AddStdVectorColumn(const std::string &variableName, const std::string &branchName, std::vector<T> *values) {
+    AddColumn(variableName, branchName, RootTypeTag<T>(), values->data());
+    Column &column = columns[variableName];
+    column.stdVector = values;
+    column.getStdVectorData = [](void *vector) -> void * { return static_cast<std::vector<T> *>(vector)->data(); };
+  }
+
+  void SetLoader(const std::string &variableName, BranchLoader *loader) {
+    auto it = columns.find(variableName);
+    if (it != columns.end()) it->second.loader = loader;
+  }
+
+  /// Returns nullptr if there's no such variable in the collection
+  inline const Column *GetColumn(const std::string &variableName) const {
+    auto it = columns.find(variableName);
+    return it == columns.end() ? nullptr : &it->second;
+  }
+
+  const std::unordered_map<std::string, Column> &GetColumns() const { return columns; }
+
+ private:
+  std::string name;
+  size_t size = 0;
+  std::unordered_map<std::string, Column> columns;  // nodes never move, so pointers to columns stay valid
+};
+
+#endif /* ColumnarCollection_hpp */
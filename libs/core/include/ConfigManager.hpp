@@ -5,11 +5,10 @@
 #ifndef ConfigManager_hpp
 #define ConfigManager_hpp
 
-#include <Python.h>
-
 #include "Helpers.hpp"
 
 #include "ArgsManager.hpp"
+#include "ConfigValue.hpp"
 
 class ConfigManager {
  public:
@@ -54,6 +53,7 @@ class ConfigManager {
   void GetHistogramsParams(std::map<std::string, HistogramParams2D>& histogramsParams, std::string collectionName);
   void GetHistogramsParams(std::map<std::string, IrregularHistogramParams>& histogramsParams, std::string collectionName);
   void GetHistogramsParams(std::map<std::string, IrregularHistogramParams2D>& histogramsParams, std::string collectionName);
+  void GetHistogramsParams(std::map<std::string, SparseHistogramParams>& histogramsParams, std::string collectionName);
 
   void GetScaleFactors(std::string name, std::map<std::string, ScaleFactorsMap>& scaleFactors);
   void GetScaleFactors(std::string name, std::map<std::string, ScaleFactorsTuple>& scaleFactors);
@@ -76,16 +76,23 @@ class ConfigManager {
 
   void PrintBanner();
 
-  FILE* pythonFile;
-  PyObject* pythonModule;
-  PyObject* config;
+  std::map<std::string, ConfigValue> values;   // all variables of the config, evaluated once
+  std::vector<std::string> importedFiles;      // files imported by the config, checked before using a snapshot
+
+  /// Runs the config in the python interpreter and converts its variables to values. Returns false if it raised.
+  bool RunPythonConfig();
+
+  std::string GetSnapshotPath(const std::string& snapshotDir);
+  /// Returns false if there's no snapshot, or if the config or any file it imports changed since it was saved
+  bool ReadSnapshot(const std::string& snapshotPath);
+  void WriteSnapshot(const std::string& snapshotPath);
 
-  PyObject* GetPythonValue(std::string name);
-  PyObject* GetPythonList(std::string name);
-  PyObject* GetPythonDict(std::string name);
+  const ConfigValue* GetConfigValue(std::string name);
+  const ConfigValue* GetConfigList(std::string name);
+  const ConfigValue* GetConfigDict(std::string name);
 
-  int GetCollectionSize(PyObject* collection);
-  PyObject* GetItem(PyObject* collection, int index);
+  int GetCollectionSize(const ConfigValue* collection);
+  const ConfigValue* GetItem(const ConfigValue* collection, int index);
 
   std::string inputPath = "";
   std::string treesOutputPath = "";
@@ -0,0 +1,46 @@
+//  ConfigValue.hpp
+
+#ifndef ConfigValue_hpp
+#define ConfigValue_hpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Value of a python config variable (None, bool, int, float, str, list, tuple or dict, nested in any way). Values
+/// are converted from python once, so that reading them doesn't go through the interpreter, and they can be saved
+/// in a config snapshot. The checks and conversions behave like the CPython ones used before (e.g. bools are ints).
+struct ConfigValue {
+  enum class Type : uint8_t { kNone, kBool, kInt, kFloat, kString, kList, kTuple, kDict };
+
+  Type type = Type::kNone;
+  long long intValue = 0;  // also for bools
+  double floatValue = 0;
+  std::string stringValue;
+  std::vector<ConfigValue> items;  // elements of lists and tuples, values of dicts
+  std::vector<ConfigValue> keys;   // keys of dicts, in the insertion order (like items)
+
+  inline bool IsBool() const { return type == Type::kBool; }
+  inline bool IsInt() const { return type == Type::kInt || type == Type::kBool; }
+  inline bool IsFloat() const { return type == Type::kFloat; }
+  inline bool IsString() const { return type == Type::kString; }
+  inline bool IsList() const { return type == Type::kList; }
+  inline bool IsTuple() const { return type == Type::kTuple; }
+  inline bool IsDict() const { return type == Type::kDict; }
+
+  /// -1 for values which are neither numbers nor strings, like PyLong_AsLong and PyFloat_AsDouble
+  inline long AsLong() const { return IsInt() ? intValue : IsFloat() ? (long)floatValue : -1; }
+  inline double AsDouble() const { return IsFloat() ? floatValue : IsInt() ? (double)intValue : -1; }
+  inline const std::string &AsString() const { return stringValue; }
+
+  /// Number of elements of a list or tuple, -1 for other values
+  inline int Size() const { return IsList() || IsTuple() ? (int)items.size() : -1; }
+  /// Element of a list or tuple (a None value if there's no such element)
+  const ConfigValue *Item(int index) const;
+
+  void Write(std::ostream &out) const;
+  /// Reads a value saved with Write(), returns false if the stream ended or failed
+  bool Read(std::istream &in);
+};
+
+#endif /* ConfigValue_hpp */
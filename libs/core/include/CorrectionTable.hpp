@@ -0,0 +1,94 @@
+//  CorrectionTable.hpp
+
+#ifndef CorrectionTable_hpp
+#define CorrectionTable_hpp
+
+#include <nlohmann/json.hpp>
+
+#include "Helpers.hpp"
+
+#ifdef USE_CORRECTIONLIB
+#include "correction.h"
+using CorrectionRef = correction::Correction::Ref;
+using CompoundCorrectionRef = correction::CompoundCorrection::Ref;
+using CorrectionArgType = correction::Variable::Type;
+#else
+struct DummyCorrectionRef {};
+using CorrectionRef = DummyCorrectionRef;
+using CompoundCorrectionRef = DummyCorrectionRef;
+using CorrectionArgType = std::variant<long, double, std::string>;
+#endif
+
+/// A correctionlib correction compiled into flat arrays of nodes, bin edges and category keys, evaluated without
+/// going through correctionlib. Binning, multibinning and category nodes are supported. Other nodes (formulas,
+/// transforms, ...) are kept as placeholders, and evaluations reaching them have to be done by correctionlib.
+class CorrectionTable {
+ public:
+  CorrectionTable() = default;
+  /// Compiles an element of the "corrections" list of a correctionlib JSON file
+  CorrectionTable(const nlohmann::json& correction);
+
+  void Write(std::ostream& out) const;
+  /// Reads a table saved with Write(), returns false if the stream ended or failed
+  bool Read(std::istream& in);
+
+  /// Returns false if the result couldn't be found in the table (unsupported node, unknown category or NaN input)
+  bool Evaluate(const std::vector<CorrectionArgType>& args, double& result) const;
+
+  /// True if the correction only consists of supported nodes
+  inline bool IsComplete() const { return complete; }
+
+ private:
+  enum class NodeType { kValue, kBinning, kCategory, kUnsupported };
+  enum class Flow { kClamp, kError, kNode };
+
+  struct Node {
+    NodeType type = NodeType::kUnsupported;
+    double value = 0;        // for value nodes
+    int firstAxis = 0;       // binnings: axes in [firstAxis, firstAxis + nAxes), more than one for multibinning
+    int nAxes = 0;
+    int firstChild = 0;      // children (bins in row-major order, or categories) in [firstChild, firstChild + nChildren)
+    int nChildren = 0;
+    Flow flow = Flow::kError;
+    int flowNode = -1;       // binnings: node used for out-of-range values if flow is kNode
+    int input = 0;           // categories: index of the argument compared with the keys
+    int defaultNode = -1;    // categories: node used if none of the keys matched
+  };
+
+  struct Axis {
+    int input = 0;
+    int nBins = 0;
+    bool uniform = false;
+    double low = 0, high = 0;  // only for uniform binnings
+    int firstEdge = 0;         // only for variable binnings, nBins + 1 edges
+  };
+
+  std::vector<Node> nodes;
+  std::vector<Axis> axes;
+  std::vector<double> edges;
+  std::vector<int> children;
+  // category keys, parallel to children - each entry is either a string or an int key, depending on isStringKey
+  std::vector<long> intKeys;
+  std::vector<std::string> stringKeys;
+  std::vector<uint8_t> isStringKey;
+
+  std::map<std::string, int> inputIndices;
+  int root = -1;
+  bool complete = true;
+
+  int Compile(const nlohmann::json& node);
+  void AddAxis(const std::string& input, const nlohmann::json& axisEdges);
+
+  /// Bin of the value, -1 for underflow and nBins for overflow
+  inline int FindBin(const Axis& axis, double value) const {
+    if (axis.uniform) {
+      if (value < axis.low) return -1;
+      if (value >= axis.high) return axis.nBins;
+      return std::min(int((value - axis.low) / (axis.high - axis.low) * axis.nBins), axis.nBins - 1);
+    }
+    const double* first = edges.data() + axis.firstEdge;
+    return int(std::upper_bound(first, first + axis.nBins + 1, value) - first) - 1;
+  }
+};
+
+#endif /* CorrectionTable_hpp */
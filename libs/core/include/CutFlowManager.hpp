@@ -16,23 +16,128 @@ class CutFlowManager {
 
   void RegisterCollection(std::string collectionName);
 
-  void RegisterCut(std::string cutName, std::string collectionName = "");
-  void UpdateCutFlow(std::string cutName, std::string collectionName = "");
+  /// Registers a cut and returns its ID, which can be passed to UpdateCutFlow() instead of the name to avoid any string
+  /// lookups in the event loop. Returns -1 for the initial cut if the input already contains it (updating it is a no-op).
+  /// Event-level cuts with inMasks are also recorded in event masks for N-1 tables, cut correlations and cut flows in
+  /// other orders. This is only correct for cuts evaluated for every event that reaches them, even if an earlier one
+  /// of them failed (like eventCuts in EventProcessor::PassesEventCuts()), and not for cuts applied by the app.
+  int RegisterCut(std::string cutName, std::string collectionName = "", bool inMasks = false);
+
+  /// Counts the current event (or object, for collection cuts) in the cut flow as passing the cut. If weight variations
+  /// were set with SetWeightVariations(), variationWeights has one weight per variation, in the same order. Without
+  /// them, the event is counted with the nominal weight in all variations (e.g. for cuts applied before SFs are known).
+  inline void UpdateCutFlow(int cutId, const std::vector<float> &variationWeights = {}) {
+    if (cutId < 0) return;
+    const CutInfo &cut = cuts[cutId];
+    float weight = GetCurrentEventWeight();
+    *cut.weights += weight;
+    *cut.rawEvents += 1;
+    if (cut.maskBit >= 0) SetMaskBit(cut.maskBit, weight);
+
+    if (variationNames.empty() && variationWeights.empty()) return;
+    if (!variationWeights.empty() && variationWeights.size() != variationNames.size()) {
+      ThrowWrongNumberOfVariations(variationWeights.size());
+    }
+    float *cutVariationWeights = &variationWeightsAfterCuts[cutId * variationNames.size()];
+    for (size_t iVariation = 0; iVariation < variationNames.size(); iVariation++) {
+      cutVariationWeights[iVariation] += variationWeights.empty() ? weight : variationWeights[iVariation];
+    }
+  }
+  void UpdateCutFlow(std::string cutName, std::string collectionName = "",
+                     const std::vector<float> &variationWeights = {});
+
+  /// Names of weight variations (e.g. SF up/down) for which cut flows are accumulated next to the nominal one. They're
+  /// saved as CutFlow_<variation> directories.
+  void SetWeightVariations(const std::vector<std::string> &names);
+  /// Variations set in this job and those with cut flows in the input
+  std::set<std::string> GetWeightVariations() const;
+  /// Cut flow of a weight variation. Cuts without weights of this variation (e.g. counted in the input before it was
+  /// added) are included with their nominal weights.
+  std::map<std::string, float> GetVariationCutFlow(const std::string &variationName);
+
+  /// Returns -1 if there's no such cut
+  int GetCutId(std::string cutName, std::string collectionName = "") const;
+
+  /// Records that the current event passed an event-level cut without counting it in the sequential cut flow, e.g. if
+  /// it was evaluated after another cut failed. Such cuts are only included in N-1 tables and cut correlations.
+  inline void MarkCutPassed(int cutId) {
+    if (cutId >= 0 && cuts[cutId].maskBit >= 0) SetMaskBit(cuts[cutId].maskBit, GetCurrentEventWeight());
+  }
+
+  /// Records that the current event reached the cuts registered with inMasks, so that it's included in N-1 tables even
+  /// if it fails all of them. Has to be called before any of these cuts is evaluated.
+  void BeginEventMask();
+
+  /// Sequential cut flow for any order of cuts registered with inMasks, computed from the cuts each event passed. For every cut, returns the sum of weights and the number of events passing it and all cuts before it.
+  std::vector<std::tuple<std::string, float, float>> GetCutFlow(const std::vector<std::string> &cutsOrder);
+
+  /// For each cut registered with inMasks: sum of weights and number of events passing all other such cuts
+  std::vector<std::tuple<std::string, float, float>> GetNminusOneCutFlow();
+
+  /// Sum of weights of events passing both cuts, for each pair of cuts registered with inMasks
+  std::vector<std::vector<float>> GetCutCorrelations();
+
   bool HasCut(std::string cutName, std::string collectionName = "");
   std::map<std::string, float> GetCutFlow(std::string collectionName = "");
   std::map<std::string, float> GetRawEventsCutFlow(std::string collectionName = "");
   void Print(std::string collectionName = "");
+  void PrintNminusOne();
 
   bool isEmpty(std::string collectionName = "");
   bool isRawEventsEmpty(std::string collectionName = "");
 
   void SaveCutFlow();
 
+  /// Adds events counted by another manager reading the same input (e.g. in another thread of the event loop).
+  /// Cuts have to be registered in the same order in both managers. Counts read from the input file are only included
+  /// once, but events counted by the other manager in cuts from the input are added.
+  void Merge(const CutFlowManager &other);
+
   // event weights (standard and up/down variations) mapped to strings naming type the of event weigth
   void SetEventWeight(float weight) { eventWeight = weight; };
 
  private:
+  struct CutInfo {
+    std::string name, collectionName;
+    float *weights, *rawEvents;  // entries of the cut flow maps below (std::map nodes never move)
+    int maskBit;                 // bit in the event mask for cuts registered with inMasks, -1 otherwise
+    bool fromInput;              // cut flow read from the input file rather than registered in this job
+  };
+  static constexpr int maxMaskBits = 64;
+
+  std::vector<CutInfo> cuts;
+  std::map<std::pair<std::string, std::string>, int> cutIds;  // (cut name, collection name) -> ID of the latest one
+  std::vector<std::string> maskCutNames;                      // full names of cuts for each bit of event masks
+
+  std::vector<std::string> variationNames;
+  std::vector<float> variationWeightsAfterCuts;  // [cutId * number of variations + variation index]
+  std::map<std::string, std::map<std::string, float>> inputVariationWeightsAfterCuts;  // variation -> cut flow
+  // cut flows read from the input, which are included in the ones below (e.g. weightsAfterCuts)
+  std::map<std::string, float> inputWeightsAfterCuts, inputRawEventsAfterCuts;
+  std::map<std::string, std::map<std::string, float>> inputWeightsAfterCollectionCuts;
+  std::map<std::string, std::map<std::string, float>> inputRawEventsAfterCollectionCuts;
+
+  // Cuts passed by each event are collected in a bit mask, and masks are aggregated only once the event is done
+  // (eventMaskEntry is -1 if the current event didn't reach these cuts)
+  uint64_t eventMask = 0;
+  float eventMaskWeight = 0;
+  long long eventMaskEntry = -1;
+  std::unordered_map<uint64_t, std::pair<double, double>> maskCounts;  // mask -> (sum of weights, number of events)
+
+  inline void SetMaskBit(int maskBit, float weight) {
+    if (eventReader->currentEntry != eventMaskEntry) {
+      FlushEventMask();
+      eventMaskEntry = eventReader->currentEntry;
+    }
+    eventMask |= uint64_t(1) << maskBit;
+    eventMaskWeight = weight;
+  }
+  void FlushEventMask();
+  [[noreturn]] void ThrowWrongNumberOfVariations(size_t nWeights) const;
+  int AddCut(std::string fullCutName, std::string cutName, std::string collectionName, bool fromInput, bool inMasks);
+
   std::string weightsBranchName;
+  BranchHandle<Float_t> weightsHandle;
 
   std::shared_ptr<EventReader> eventReader;
   std::shared_ptr<EventWriter> eventWriter;
@@ -53,10 +158,12 @@ class CutFlowManager {
   bool weightsBranchWarningPrinted = false;
 
   float GetCurrentEventWeight();
-  std::string GetFullCutName(std::string cutName, std::string collectionName = "");
   void RegisterPreExistingCutFlows();
+  void RegisterPreExistingCutIds();
+  void RegisterPreExistingCutFlows(TFile *inputFile);
   void SaveSingleCutFlow(std::string collectionName = "");
   void WriteCutFlow(std::map<std::string, float> weights, std::string cutFlowName);
+  void WriteCutMasks();
 
 };
 
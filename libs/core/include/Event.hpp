@@ -5,11 +5,13 @@
 #ifndef Event_hpp
 #define Event_hpp
 
+#include "BranchHandle.hpp"
 #include "ConfigManager.hpp"
 #include "Helpers.hpp"
 #include "Logger.hpp"
 #include "Multitype.hpp"
 #include "PhysicsObject.hpp"
+#include "SelectionPlan.hpp"
 
 class Event {
 public:
@@ -21,128 +23,109 @@ public:
   inline auto Get(std::string branchName, const char *file = __builtin_FILE(),
                   const char *function = __builtin_FUNCTION(),
                   int line = __builtin_LINE()) {
-    if (valuesTypes.count(branchName) == 0 &&
-        customValuesTypes.count(branchName) == 0) {
-      std::string message =
-          "\nTrying to access incorrect event-level branch: " + branchName;
-      if (branchName.find("Weight") != std::string::npos ||
-          branchName.find("Wgt") != std::string::npos ||
-          branchName.find("weight") != std::string::npos ||
-          branchName.find("wgt") != std::string::npos) {
-        message +=
-            ", it's probably fine for data if this is a gen weight branch.";
-        warn() << message << std::endl;
-      } else
-        fatal(file, function, line) << message << std::endl;
+    if (lazyLoading) LoadBranch(branchName);
+    if (FindBranchType(branchName) == BranchType::kUnknown) ThrowMissingBranch(branchName, file, function, line);
+    return Multitype(this, branchName);
+  }
+
+  /// Returns a handle to an input event-level branch, to read it in the event loop without string lookups.
+  /// Throws Exception if the branch doesn't exist and BadTypeException if T doesn't match the branch type.
+  template <typename T> BranchHandle<T> Handle(const std::string &branchName) {
+    auto typeIt = valuesTypes.find(branchName);
+    if (typeIt == valuesTypes.end()) {
+      std::string message = "Trying to create a handle for incorrect event-level branch: " + branchName;
       throw Exception(message.c_str());
     }
-
-    return Multitype(this, branchName);
+    if (typeIt->second != RootTypeTag<T>()) {
+      std::string message = "Creating a " + std::string(RootTypeName<T>()) + " handle for event-level branch " +
+                            branchName + " (" + RootTypeName(typeIt->second) + ")\n";
+      throw BadTypeException(message.c_str());
+    }
+    return BranchHandle<T>(&GetScalarValues<T>().at(branchName), branchName, FindLoader(branchName));
   }
 
-  template <typename T> T GetAs(std::string branchName) {
-    if (defaultCollectionsTypes.count(branchName)) {
-      std::string branchType = defaultCollectionsTypes[branchName];
-      if (branchType == "Int_t") {
-        Int_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Bool_t") {
-        Bool_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Float_t") {
-        Float_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Double_t") {
-        Double_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UChar_t") {
-        UChar_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UShort_t") {
-        UShort_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Short_t") {
-        Short_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UInt_t") {
-        UInt_t value = Get(branchName);
-        return value;
-      }
+  /// Returns a handle to a variable of an input collection (e.g. ObjectHandle<Float_t>("Muon", "pt")), to be read
+  /// with PhysicsObject::Get(handle). Works for objects of extra collections built from this collection, too.
+  /// Throws Exception if the collection or variable don't exist and BadTypeException if T doesn't match the type.
+  template <typename T>
+  ObjectBranchHandle<T> ObjectHandle(const std::string &collectionName, const std::string &variableName) {
+    auto columnsIt = columnarCollections.find(collectionName);
+    if (columnsIt == columnarCollections.end()) {
+      std::string message = "Trying to create a handle for a collection that doesn't exist: " + collectionName;
+      throw Exception(message.c_str());
+    }
+    const Column *column = columnsIt->second->GetColumn(variableName);
+    if (!column) {
+      std::string message = "Trying to create a handle for incorrect physics object-level branch: " + variableName +
+                            " from " + collectionName + " collection";
+      throw Exception(message.c_str());
+    }
+    if (column->type != RootTypeTag<T>()) {
+      std::string message = "Creating a " + std::string(RootTypeName<T>()) + " handle for physics object-level branch " +
+                            variableName + " (" + RootTypeName(column->type) + ") from " + collectionName +
+                            " collection\n";
+      throw BadTypeException(message.c_str());
     }
+    return ObjectBranchHandle<T>(columnsIt->second.get(), column, collectionName, variableName);
+  }
+
+  /// In lazy loading mode, reads the current entry of an input branch if it wasn't read yet (no-op otherwise)
+  inline void LoadBranch(const std::string &branchName) {
+    BranchLoader *loader = FindLoader(branchName);
+    if (loader) loader->Load();
+  }
+
+  /// Returns nullptr if there's no input collection with this name
+  inline const ColumnarCollection *GetColumnarCollection(const std::string &name) const {
+    auto columnsIt = columnarCollections.find(name);
+    return columnsIt == columnarCollections.end() ? nullptr : columnsIt->second.get();
+  }
+
+  /// Returns the type of an input or custom event-level branch (kUnknown if there's no such branch)
+  inline BranchType FindBranchType(const std::string &branchName) const {
+    auto typeIt = valuesTypes.find(branchName);
+    if (typeIt != valuesTypes.end()) return typeIt->second;
+    typeIt = customValuesTypes.find(branchName);
+    return typeIt == customValuesTypes.end() ? BranchType::kUnknown : typeIt->second;
+  }
 
-    try {
-      Float_t value = Get(branchName);
-      defaultCollectionsTypes[branchName] = "Float_t";
-      return value;
-    } catch (BadTypeException &e) {
-      try {
-        Double_t value = Get(branchName);
-        defaultCollectionsTypes[branchName] = "Double_t";
-        return value;
-      } catch (BadTypeException &e) {
-        try {
-          Int_t value = Get(branchName);
-          defaultCollectionsTypes[branchName] = "Int_t";
-          return value;
-        } catch (BadTypeException &e) {
-          try {
-            UChar_t value = Get(branchName);
-            defaultCollectionsTypes[branchName] = "UChar_t";
-            return value;
-          } catch (BadTypeException &e) {
-            try {
-              UShort_t value = Get(branchName);
-              defaultCollectionsTypes[branchName] = "UShort_t";
-              return value;
-            } catch (BadTypeException &e) {
-              try {
-                Short_t value = Get(branchName);
-                defaultCollectionsTypes[branchName] = "Short_t";
-                return value;
-              } catch (BadTypeException &e) {
-                try {
-                  UInt_t value = Get(branchName);
-                  defaultCollectionsTypes[branchName] = "UInt_t";
-                  return value;
-                } catch (BadTypeException &e) {
-                  try {
-                    Bool_t value = Get(branchName);
-                    defaultCollectionsTypes[branchName] = "Bool_t";
-                    return value;
-                  } catch (BadTypeException &e) {
-                    error() << "Couldn't get value for branch " << branchName
-                            << std::endl;
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
+  /// Returns value of a branch of any numerical type converted to T
+  template <typename T>
+  T GetAs(const std::string &branchName, const char *file = __builtin_FILE(),
+          const char *function = __builtin_FUNCTION(), int line = __builtin_LINE()) {
+    if (lazyLoading) LoadBranch(branchName);
+    switch (FindBranchType(branchName)) {
+      case BranchType::kFloat: return static_cast<T>(GetFloat(branchName));
+      case BranchType::kDouble: return static_cast<T>(GetDouble(branchName));
+      case BranchType::kInt: return static_cast<T>(GetInt(branchName));
+      case BranchType::kUInt: return static_cast<T>(GetUint(branchName));
+      case BranchType::kBool: return static_cast<T>(GetBool(branchName));
+      case BranchType::kUChar: return static_cast<T>(GetUChar(branchName));
+      case BranchType::kUShort: return static_cast<T>(GetUShort(branchName));
+      case BranchType::kShort: return static_cast<T>(GetShort(branchName));
+      case BranchType::kULong64: return static_cast<T>(GetULong(branchName));
+      case BranchType::kUnknown: ThrowMissingBranch(branchName, file, function, line);
+      default: break;
     }
+    error() << "Couldn't get value for branch " << branchName << std::endl;
     return 0;
   }
 
-  inline std::shared_ptr<PhysicsObjects> GetCollection(std::string name) const {
-    if (collections.count(name))
-      return collections.at(name);
-    if (extraCollections.count(name))
-      return extraCollections.at(name);
-    std::string message =
-        "Tried to get a collection that doesn't exist: " + name;
-    throw Exception(message.c_str());
+  /// Extra collections defined in the config are built on the first call in each event and kept until Reset()
+  inline std::shared_ptr<PhysicsObjects> GetCollection(std::string name) {
+    auto collectionIt = collections.find(name);
+    if (collectionIt != collections.end()) return collectionIt->second;
+    auto extraCollectionIt = extraCollections.find(name);
+    if (extraCollectionIt != extraCollections.end()) return extraCollectionIt->second;
+    return BuildExtraCollection(name);
   }
 
+  /// Builds all extra collections defined in the config which weren't built in this event yet
   void AddExtraCollections();
   void AddCollection(std::string name,
                      std::shared_ptr<PhysicsObjects> collection) {
+    // a collection from the config with the same name takes precedence, as if it was built before
+    if (FindSelectionPlan(name)) GetCollection(name);
     extraCollections.insert({name, collection});
   }
   void ReplaceCollection(std::string name,
@@ -214,7 +197,7 @@ public:
     else
       static_assert(!sizeof(T), "Event::Set<T>: unsupported type");
 
-    customValuesTypes[branchName] = RootTypeName<T>();
+    customValuesTypes[branchName] = RootTypeTag<T>();
   }
 
   template <typename T> void SetVector(const std::string &branchName, std::vector<T> value) {
@@ -229,16 +212,15 @@ public:
     else
       static_assert(!sizeof(T), "Event::SetVector<T>: unsupported type (Float_t, Double_t, Int_t, UInt_t only)");
 
-    customValuesTypes[branchName] = "vector<" + std::string(RootTypeName<T>()) + ">";
+    customValuesTypes[branchName] = RootVectorTypeTag<T>();
   }
 
   template <typename T> const std::vector<T> &GetVector(const std::string &branchName) const {
-    std::string expectedType = "vector<" + std::string(RootTypeName<T>()) + ">";
     auto typeIt = customValuesTypes.find(branchName);
-    if (typeIt == customValuesTypes.end() || typeIt->second != expectedType) {
+    if (typeIt == customValuesTypes.end() || typeIt->second != RootVectorTypeTag<T>()) {
       std::string message = "Casting a custom vector branch " + branchName + " (" +
-          (typeIt == customValuesTypes.end() ? std::string("not set") : typeIt->second) +
-          ") to " + expectedType + "\n";
+          (typeIt == customValuesTypes.end() ? std::string("not set") : RootTypeName(typeIt->second)) +
+          ") to " + RootTypeName(RootVectorTypeTag<T>()) + "\n";
       throw BadTypeException(message.c_str());
     }
     if constexpr (std::is_same_v<T, Float_t>)
@@ -260,58 +242,83 @@ public:
 private:
   ConfigManager& config = ConfigManager::GetInstance();
   
-  inline UInt_t GetUint(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesUint[branchName];
-    return customValuesUint[branchName];
-  }
-  inline Int_t GetInt(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesInt[branchName];
-    return customValuesInt[branchName];
-  }
-  inline Bool_t GetBool(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesBool[branchName];
-    return customValuesBool[branchName];
-  }
-  inline Float_t GetFloat(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesFloat[branchName];
-    return customValuesFloat[branchName];
-  }
-  inline Double_t GetDouble(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesDouble[branchName];
-    return customValuesDouble[branchName];
-  }
-  inline ULong64_t GetULong(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesUlong[branchName];
-    return customValuesUlong[branchName];
-  }
-  inline UChar_t GetUChar(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesUchar[branchName];
-    return customValuesUchar[branchName];
-  }
-  inline Char_t GetChar(std::string branchName) {
-    return valuesChar[branchName];
-  }
-  inline UShort_t GetUShort(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesUshort[branchName];
-    return customValuesUshort[branchName];
-  }
-  inline Short_t GetShort(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return valuesShort[branchName];
-    return customValuesShort[branchName];
-  }
-
-  std::map<std::string, std::string>
+  [[noreturn]] void ThrowMissingBranch(const std::string &branchName, const char *file, const char *function,
+                                       int line) const {
+    std::string message =
+        "\nTrying to access incorrect event-level branch: " + branchName;
+    if (branchName.find("Weight") != std::string::npos ||
+        branchName.find("Wgt") != std::string::npos ||
+        branchName.find("weight") != std::string::npos ||
+        branchName.find("wgt") != std::string::npos) {
+      message +=
+          ", it's probably fine for data if this is a gen weight branch.";
+      warn() << message << std::endl;
+    } else
+      fatal(file, function, line) << message << std::endl;
+    throw Exception(message.c_str());
+  }
+
+  // input values take precedence over custom values with the same name
+  template <typename Values, typename CustomValues>
+  inline auto GetValue(const std::string &branchName, Values &values, CustomValues &customValues) {
+    auto valueIt = values.find(branchName);
+    if (valueIt != values.end()) return valueIt->second;
+    return customValues[branchName];
+  }
+
+  inline UInt_t GetUint(const std::string &branchName) { return GetValue(branchName, valuesUint, customValuesUint); }
+  inline Int_t GetInt(const std::string &branchName) { return GetValue(branchName, valuesInt, customValuesInt); }
+  inline Bool_t GetBool(const std::string &branchName) { return GetValue(branchName, valuesBool, customValuesBool); }
+  inline Float_t GetFloat(const std::string &branchName) { return GetValue(branchName, valuesFloat, customValuesFloat); }
+  inline Double_t GetDouble(const std::string &branchName) {
+    return GetValue(branchName, valuesDouble, customValuesDouble);
+  }
+  inline ULong64_t GetULong(const std::string &branchName) {
+    return GetValue(branchName, valuesUlong, customValuesUlong);
+  }
+  inline UChar_t GetUChar(const std::string &branchName) {
+    return GetValue(branchName, valuesUchar, customValuesUchar);
+  }
+  inline Char_t GetChar(const std::string &branchName) { return valuesChar[branchName]; }
+  inline UShort_t GetUShort(const std::string &branchName) {
+    return GetValue(branchName, valuesUshort, customValuesUshort);
+  }
+  inline Short_t GetShort(const std::string &branchName) {
+    return GetValue(branchName, valuesShort, customValuesShort);
+  }
+
+  inline BranchLoader *FindLoader(const std::string &branchName) {
+    if (!lazyLoading) return nullptr;
+    auto loaderIt = branchLoaders.find(branchName);
+    return loaderIt == branchLoaders.end() ? nullptr : &loaderIt->second;
+  }
+
+  template <typename T> std::map<std::string, T> &GetScalarValues() {
+    if constexpr (std::is_same_v<T, UInt_t>)
+      return valuesUint;
+    else if constexpr (std::is_same_v<T, Int_t>)
+      return valuesInt;
+    else if constexpr (std::is_same_v<T, Bool_t>)
+      return valuesBool;
+    else if constexpr (std::is_same_v<T, Float_t>)
+      return valuesFloat;
+    else if constexpr (std::is_same_v<T, Double_t>)
+      return valuesDouble;
+    else if constexpr (std::is_same_v<T, ULong64_t>)
+      return valuesUlong;
+    else if constexpr (std::is_same_v<T, UChar_t>)
+      return valuesUchar;
+    else if constexpr (std::is_same_v<T, UShort_t>)
+      return valuesUshort;
+    else if constexpr (std::is_same_v<T, Short_t>)
+      return valuesShort;
+    else
+      static_assert(!sizeof(T), "Event::GetScalarValues<T>: unsupported type");
+  }
+
+  std::map<std::string, BranchType>
       valuesTypes; /// contains all branch names and corresponding types
-  std::map<std::string, std::string> customValuesTypes;
+  std::map<std::string, BranchType> customValuesTypes;
 
   std::map<std::string, UInt_t> valuesUint;
   std::map<std::string, Int_t> valuesInt;
@@ -353,12 +360,18 @@ private:
   std::map<std::string, std::vector<unsigned int> *> valuesStdUintVector;
 
   std::map<std::string, std::shared_ptr<PhysicsObjects>> collections;
+  std::map<std::string, std::shared_ptr<ColumnarCollection>> columnarCollections;  // storage behind collections
+
+  bool lazyLoading = false;
+  std::unordered_map<std::string, BranchLoader> branchLoaders;  // by branch name, only filled in lazy loading mode
   std::map<std::string, std::shared_ptr<PhysicsObjects>> extraCollections;
 
   bool hasExtraCollections = true;
   insertion_ordered_map<std::string, ExtraCollection>
       extraCollectionsDescriptions;
-  std::map<std::string, std::string> defaultCollectionsTypes;
+  std::vector<SelectionPlan> selectionPlans;  // compiled from the descriptions on first use
+  std::unordered_map<std::string, size_t> selectionPlanIndices;
+  std::vector<bool> selectionPlansInProgress;  // to catch extra collections depending on themselves
   std::map<std::string, std::pair<unsigned, unsigned>> runRangesPerEra;
 
   std::string metBranchName;
@@ -367,12 +380,8 @@ private:
   friend class EventReader;
   template <typename T> friend class Multitype;
 
-  template <typename First, typename... Rest>
-  bool tryGet(std::shared_ptr<PhysicsObject> physicsObject,
-              std::string branchName, std::pair<float, float> cuts);
-
-  bool checkCuts(std::shared_ptr<PhysicsObject> physicsObject,
-                 std::string branchName, std::pair<float, float> cuts);
+  SelectionPlan *FindSelectionPlan(const std::string &name);
+  std::shared_ptr<PhysicsObjects> BuildExtraCollection(const std::string &name);
 };
 
 #endif /* Event_hpp */
@@ -0,0 +1,100 @@
+//  EventLoop.hpp
+
+#ifndef EventLoop_hpp
+#define EventLoop_hpp
+
+#include <atomic>
+#include <thread>
+
+#include "EventReader.hpp"
+#include "Helpers.hpp"
+
+/// Runs the event loop on several threads (set with nThreads in the config, 1 by default, 0 to use all cores).
+///
+/// The entries are split into contiguous ranges made of whole clusters, and each range is processed by a separate
+/// worker. A worker is defined by the app: it has to contain an EventReader called eventReader, everything that is
+/// filled in the loop (histograms, cut flows, output trees...) and a `void Merge(Worker &other)` method adding outputs
+/// of another worker to its own. Workers are created one by one on the main thread, before the loop starts. The config
+/// is converted from python when it's loaded, so it can be read from any thread, but reading parameters once in the
+/// worker's constructor avoids looking them up for every event.
+///
+/// Once all threads are done, workers are merged into the first one in the order of their entry ranges, so the output
+/// doesn't depend on how threads were scheduled. The merged worker is returned.
+///
+///   EventLoop eventLoop;
+///   auto worker = eventLoop.Run<Worker>([](int iWorker) { return make_shared<Worker>(); },
+///                                       [](Worker &worker, const shared_ptr<Event> &event) { ... });
+class EventLoop {
+ public:
+  EventLoop();
+
+  inline int GetNthreads() const { return nThreads; }
+
+  template <typename Worker>
+  std::shared_ptr<Worker> Run(std::function<std::shared_ptr<Worker>(int)> createWorker,
+                              std::function<void(Worker &, const std::shared_ptr<Event> &)> processEvent);
+
+ private:
+  int nThreads = 1;
+
+  std::atomic<long long> nProcessedEvents = 0;
+  std::atomic<int> lastPrintedPercentage = -1;
+
+  void Setup();
+  void UpdateProgress(long long nEvents);
+  /// I/O statistics and scale factors that were loaded but not used
+  void PrintSummary(const std::vector<EventReader *> &eventReaders);
+};
+
+template <typename Worker>
+std::shared_ptr<Worker> EventLoop::Run(std::function<std::shared_ptr<Worker>(int)> createWorker,
+                                       std::function<void(Worker &, const std::shared_ptr<Event> &)> processEvent) {
+  Setup();
+
+  std::vector<std::shared_ptr<Worker>> workers = {createWorker(0)};
+  auto entryRanges = workers[0]->eventReader->GetEntryRanges(nThreads);
+  long long nEvents = workers[0]->eventReader->GetNevents();
+
+  // With a single worker, the loop runs on the main thread just like a plain for loop would
+  if (entryRanges.size() == 1) {
+    for (long long iEvent = 0; iEvent < nEvents; iEvent++) processEvent(*workers[0], workers[0]->eventReader->GetEvent(iEvent));
+    PrintSummary({workers[0]->eventReader.get()});
+    return workers[0];
+  }
+
+  for (int iWorker = 1; iWorker < (int)entryRanges.size(); iWorker++) workers.push_back(createWorker(iWorker));
+  if ((int)entryRanges.size() < nThreads) {
+    info() << "Input has too few clusters for " << nThreads << " threads, will use " << entryRanges.size() << std::endl;
+  }
+
+  std::vector<std::exception_ptr> exceptions(workers.size());
+  std::vector<std::thread> threads;
+  for (int iWorker = 0; iWorker < (int)workers.size(); iWorker++) {
+    threads.emplace_back([&, iWorker]() {
+      auto &worker = *workers[iWorker];
+      worker.eventReader->SetShowProgress(false);
+      try {
+        for (long long iEvent = entryRanges[iWorker].first; iEvent < entryRanges[iWorker].second; iEvent++) {
+          processEvent(worker, worker.eventReader->GetEvent(iEvent));
+          UpdateProgress(nEvents);
+        }
+      } catch (...) {
+        exceptions[iWorker] = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+
+  for (auto &exception : exceptions) {
+    if (exception) std::rethrow_exception(exception);
+  }
+
+  std::vector<EventReader *> eventReaders;
+  for (auto &worker : workers) eventReaders.push_back(worker->eventReader.get());
+  PrintSummary(eventReaders);
+
+  for (int iWorker = 1; iWorker < (int)workers.size(); iWorker++) workers[0]->Merge(*workers[iWorker]);
+  return workers[0];
+}
+
+#endif /* EventLoop_hpp */
@@ -31,14 +31,32 @@ class EventProcessor {
   bool PassesTriggerCuts(const std::shared_ptr<Event> event);
   bool PassesMetFilters(const std::shared_ptr<Event> event);
 
-  bool PassesEventCuts(const std::shared_ptr<Event> event, std::shared_ptr<CutFlowManager> cutFlowManager=nullptr);
+  /// Weights of the event for each variation set in the cut flow manager (see CutFlowManager::UpdateCutFlow())
+  bool PassesEventCuts(const std::shared_ptr<Event> event, std::shared_ptr<CutFlowManager> cutFlowManager=nullptr,
+                       const std::vector<float> &variationWeights = {});
 
  private:
   std::vector<std::string> triggerNames;
   std::vector<std::pair<std::string, std::pair<float, float>>> eventCuts;
+  std::vector<int> eventCutIds;  // IDs in the cut flow manager given to RegisterCuts()
+  bool recordCutMasks = false;    // evaluate all event cuts for N-1 tables and cut correlations
   std::vector<std::string> requiredFlags;
 
-  std::map<int, std::vector<std::vector<int>>> goldenJson;
+  // Golden JSON as lumi ranges sorted by run and first lumi section, merged where they overlap. Ranges of
+  // goldenJsonRuns[i] are [goldenJsonRunStarts[i], goldenJsonRunStarts[i + 1]).
+  std::vector<UInt_t> goldenJsonRuns;
+  std::vector<size_t> goldenJsonRunStarts;
+  std::vector<std::pair<UInt_t, UInt_t>> goldenJsonLumiRanges;
+
+  // consecutive events mostly come from the same lumi section, so the last result is kept
+  UInt_t lastRun = std::numeric_limits<UInt_t>::max(), lastLumi = 0;
+  bool lastPassesGoldenJson = false;
+
+  const Event *goldenJsonHandlesEvent = nullptr;
+  BranchHandle<UInt_t> runHandle, lumiHandle;
+
+  void ReadGoldenJson();
+  bool IsInGoldenJson(UInt_t run, UInt_t lumi) const;
 
   std::vector<std::string> triggerWarningsPrinted;
 };
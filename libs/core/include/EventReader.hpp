@@ -10,6 +10,8 @@
 #include "Event.hpp"
 #include "Helpers.hpp"
 
+class TChain;
+
 class EventReader {
  public:
   EventReader();
@@ -18,8 +20,23 @@ class EventReader {
   long long GetNevents() const;
   std::shared_ptr<Event> GetEvent(int iEvent);
 
+  /// Splits entries to process into up to nRanges contiguous [first, last) ranges of similar size, starting at cluster
+  /// boundaries of the events tree. There can be fewer ranges than requested if the tree has only a few clusters.
+  std::vector<std::pair<long long, long long>> GetEntryRanges(int nRanges);
+
+  /// The progress bar is drawn by GetEvent() unless disabled (e.g. when several readers run in parallel)
+  void SetShowProgress(bool showProgress_) { showProgress = showProgress_; }
+  static void PrintProgress(long long iEvent, long long nEvents);
+
+  /// Prints the TTreeCache hit rate and the number of read calls (if treeCacheSize is set in the config).
+  /// Called from the destructor, unless it was already printed for a set of readers running in parallel.
+  static void PrintIOStatistics(const std::vector<EventReader *> &eventReaders);
+
   bool IsVectorBranch(TBranch *branch);
 
+  /// In the lazy loading mode, reads all branches of the given tree for the current event (e.g. before writing it out)
+  void LoadCurrentEntry(std::string treeName);
+
   std::vector<std::string> GetHLTbranchNames();
   std::vector<std::string> GetL1branchNames();
 
@@ -28,20 +45,33 @@ class EventReader {
 
   std::unordered_map<std::string, std::vector<std::string>> branchesPerCollection;
   std::unordered_map<std::string, std::function<int(const std::shared_ptr<Event>&)>> collectionSizeGetters;
-  std::unordered_map<std::string, std::string> defaultBranchSizeTypes;
+  std::unordered_map<std::string, std::string> sizeBranchNames;
 
-  TFile *inputFile;
-  std::map<std::string, TTree *> inputTrees;
+  std::vector<std::string> inputFilePaths;
+  TFile *inputFile;  // the first input file
+  std::map<std::string, TChain *> inputTrees;  // each tree is read from all input files
+  std::map<std::string, int> currentTreeNumbers;  // index of the file the chain is currently reading
+  std::map<std::string, std::set<std::string>> branchNamesPerTree;
   std::shared_ptr<Event> currentEvent;
 
   std::tuple<std::string, std::string> GetCollectionAndVariableNames(std::string branchName);
 
+  std::vector<std::string> ExpandInputFilePattern(const std::string &pattern);
+  void OpenFirstInputFile();
+
+  TChain *CreateChain(std::string treeName);
   void SetupTrees();
   void SetupBranches();
 
+  void CheckTreeNumbers();
+  void UpdateTreeBranches(std::string treeName);
+
   void SetupScalarBranch(std::string branchName, std::string branchType, std::string eventsTreeName);
   void SetupVectorBranch(std::string branchName, std::string branchType, std::string eventsTreeName);
-  void InitializeCollection(std::string collectionName);
+  void SetupAlwaysLoadedBranches();
+  std::shared_ptr<ColumnarCollection> InitializeCollection(std::string collectionName);
+  void ResizeCollection(std::shared_ptr<PhysicsObjects> collection, std::shared_ptr<ColumnarCollection> columns,
+                        size_t size);
 
   std::vector<std::string> sizeWarningsPrinted;
 
@@ -54,10 +84,23 @@ class EventReader {
 
   std::unique_ptr<AddedBranches> addedBranches;
 
+  int treeCacheSize = 0;  // in MB
+  int treeCacheLearnEntries = 100;
+  bool asyncPrefetching = true;
+  bool ioStatisticsPrinted = false;
+  void SetupTreeCache();
+
+  bool showProgress = true;
+  int lastPrintedPercentage = -1;
+
+  bool lazyBranchLoading = false;
+  long long currentEntry = -1;
+  std::map<std::string, LoadedEntry> loadedEntries;  // per events tree, shared by loaders of its branches
+  std::vector<BranchLoader *> alwaysLoadedBranches;
+
   TLeaf *GetLeaf(TBranch *branch);
 
-  template <typename First, typename... Rest>
-  int tryGet(std::shared_ptr<Event> event, std::string branchName);
+  const std::string &GetSizeBranchName(const std::string &collectionName);
 
   friend class EventWriter;
   friend class CutFlowManager;
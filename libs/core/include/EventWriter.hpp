@@ -12,7 +12,9 @@
 
 class EventWriter {
 public:
-  EventWriter(const std::shared_ptr<EventReader> &eventReader_);
+  /// If part is given, events are written to a separate part file (e.g. output_part3.root). Parts are merged into the
+  /// output file from the config when Save() is called on the writer into which the others were merged.
+  EventWriter(const std::shared_ptr<EventReader> &eventReader_, int part = -1);
   ~EventWriter();
 
   void AddCurrentEvent(std::string treeName);
@@ -22,6 +24,9 @@ public:
 
   void Save();
 
+  /// Writes out and closes the other writer's part file, which will be merged into the output in Save()
+  void Merge(EventWriter &other);
+
 private:
   struct AddedBranch {
     std::string type;
@@ -34,6 +39,8 @@ private:
 
   TFile *outFile;
   std::string outputFilePath;
+  std::string finalOutputFilePath;
+  std::vector<std::string> partFilePaths;
   std::map<std::string, TTree *> outputTrees;
 
   std::shared_ptr<EventReader> eventReader;
@@ -79,6 +86,8 @@ private:
   std::map<std::string, std::vector<UInt_t>> addedStdVectorUInt;
 
   void SetupOutputTree();
+  void WriteOutputTrees();
+  void MergePartFiles();
   void SetupBoolVectorBranches(std::string treeName);
   void RepackBoolVectorBranches(std::string treeName);
 
@@ -111,6 +111,67 @@ inline bool FileExists(const std::string& name) {
   return f.good();
 }
 
+/// Reads the whole file into content, returns false if it couldn't be opened
+inline bool readFile(const std::string& path, std::string& content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+/// FNV-1a hash, e.g. to check if a file changed since a cache was made from it
+inline uint64_t hashBytes(const std::string& bytes) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char byte : bytes) {
+    hash ^= byte;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/// Binary (de)serialization of trivially copyable values, strings and vectors of them, used for caches saved on disk
+template <typename T>
+inline void WriteBinary(std::ostream& out, const T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+inline void WriteBinary(std::ostream& out, const std::string& value) {
+  WriteBinary(out, (uint64_t)value.size());
+  out.write(value.data(), value.size());
+}
+template <typename T>
+inline void WriteBinary(std::ostream& out, const std::vector<T>& values) {
+  WriteBinary(out, (uint64_t)values.size());
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+  } else {
+    for (const auto& value : values) WriteBinary(out, value);
+  }
+}
+
+template <typename T>
+inline bool ReadBinary(std::istream& in, T& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  return bool(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+inline bool ReadBinary(std::istream& in, std::string& value) {
+  uint64_t size;
+  if (!ReadBinary(in, size)) return false;
+  value.resize(size);
+  return bool(in.read(value.data(), size));
+}
+template <typename T>
+inline bool ReadBinary(std::istream& in, std::vector<T>& values) {
+  uint64_t size;
+  if (!ReadBinary(in, size)) return false;
+  values.resize(size);
+  if constexpr (std::is_trivially_copyable_v<T>) return bool(in.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+  for (auto& value : values) {
+    if (!ReadBinary(in, value)) return false;
+  }
+  return true;
+}
+
 struct ExtraCollection {
   std::vector<std::string> inputCollections;
   std::map<std::string, std::pair<float, float>> allCuts;
@@ -166,6 +227,14 @@ struct IrregularHistogramParams2D {
   std::vector<float> binEdgesY;
 };
 
+struct SparseHistogramParams {
+  std::string name, directory;
+  std::vector<std::string> variables;  // one per axis
+  std::vector<int> nBins;
+  std::vector<float> min, max;
+  bool projectTo2D = false;  // save as TH2D instead of THnSparseD (only for 2 axes)
+};
+
 inline const std::string kEventLevelBranchCollection = "Event";
 
 struct AddedBranchParams {
@@ -224,6 +293,114 @@ inline const char *RootTypeName<UShort_t>() {
   return "UShort_t";
 }
 
+/// Type of an input or custom branch, so that values can be converted with a switch instead of comparing type names
+enum class BranchType : unsigned char {
+  kUnknown,
+  kUInt,
+  kInt,
+  kBool,
+  kFloat,
+  kDouble,
+  kULong64,
+  kUChar,
+  kChar,
+  kUShort,
+  kShort,
+  kVectorFloat,
+  kVectorDouble,
+  kVectorInt,
+  kVectorUInt,
+};
+
+template <typename T>
+constexpr BranchType RootTypeTag() {
+  if constexpr (std::is_same_v<T, UInt_t>)
+    return BranchType::kUInt;
+  else if constexpr (std::is_same_v<T, Int_t>)
+    return BranchType::kInt;
+  else if constexpr (std::is_same_v<T, Bool_t>)
+    return BranchType::kBool;
+  else if constexpr (std::is_same_v<T, Float_t>)
+    return BranchType::kFloat;
+  else if constexpr (std::is_same_v<T, Double_t>)
+    return BranchType::kDouble;
+  else if constexpr (std::is_same_v<T, ULong64_t>)
+    return BranchType::kULong64;
+  else if constexpr (std::is_same_v<T, UChar_t>)
+    return BranchType::kUChar;
+  else if constexpr (std::is_same_v<T, Char_t>)
+    return BranchType::kChar;
+  else if constexpr (std::is_same_v<T, UShort_t>)
+    return BranchType::kUShort;
+  else if constexpr (std::is_same_v<T, Short_t>)
+    return BranchType::kShort;
+  else
+    static_assert(!sizeof(T), "RootTypeTag<T>: unsupported type");
+}
+
+template <typename T>
+constexpr BranchType RootVectorTypeTag() {
+  if constexpr (std::is_same_v<T, Float_t>)
+    return BranchType::kVectorFloat;
+  else if constexpr (std::is_same_v<T, Double_t>)
+    return BranchType::kVectorDouble;
+  else if constexpr (std::is_same_v<T, Int_t>)
+    return BranchType::kVectorInt;
+  else if constexpr (std::is_same_v<T, UInt_t>)
+    return BranchType::kVectorUInt;
+  else
+    static_assert(!sizeof(T), "RootVectorTypeTag<T>: unsupported type (Float_t, Double_t, Int_t, UInt_t only)");
+}
+
+inline BranchType RootTypeTag(const std::string &typeName) {
+  static const std::unordered_map<std::string, BranchType> tags = {
+      {"UInt_t", BranchType::kUInt},       {"Int_t", BranchType::kInt},        {"Bool_t", BranchType::kBool},
+      {"Float_t", BranchType::kFloat},     {"Double_t", BranchType::kDouble},  {"ULong64_t", BranchType::kULong64},
+      {"UChar_t", BranchType::kUChar},     {"Char_t", BranchType::kChar},      {"UShort_t", BranchType::kUShort},
+      {"Short_t", BranchType::kShort},
+  };
+  auto tagIt = tags.find(typeName);
+  return tagIt == tags.end() ? BranchType::kUnknown : tagIt->second;
+}
+
+inline const char *RootTypeName(BranchType type) {
+  switch (type) {
+    case BranchType::kUInt: return "UInt_t";
+    case BranchType::kInt: return "Int_t";
+    case BranchType::kBool: return "Bool_t";
+    case BranchType::kFloat: return "Float_t";
+    case BranchType::kDouble: return "Double_t";
+    case BranchType::kULong64: return "ULong64_t";
+    case BranchType::kUChar: return "UChar_t";
+    case BranchType::kChar: return "Char_t";
+    case BranchType::kUShort: return "UShort_t";
+    case BranchType::kShort: return "Short_t";
+    case BranchType::kVectorFloat: return "vector<Float_t>";
+    case BranchType::kVectorDouble: return "vector<Double_t>";
+    case BranchType::kVectorInt: return "vector<Int_t>";
+    case BranchType::kVectorUInt: return "vector<UInt_t>";
+    default: return "unknown";
+  }
+}
+
+/// Reads element `index` of an array of values of the given type, converted to T (0 for non-scalar types)
+template <typename T>
+inline T ReadValueAs(BranchType type, const void *values, size_t index = 0) {
+  switch (type) {
+    case BranchType::kFloat: return static_cast<T>(static_cast<const Float_t *>(values)[index]);
+    case BranchType::kDouble: return static_cast<T>(static_cast<const Double_t *>(values)[index]);
+    case BranchType::kInt: return static_cast<T>(static_cast<const Int_t *>(values)[index]);
+    case BranchType::kUInt: return static_cast<T>(static_cast<const UInt_t *>(values)[index]);
+    case BranchType::kBool: return static_cast<T>(static_cast<const Bool_t *>(values)[index]);
+    case BranchType::kUChar: return static_cast<T>(static_cast<const UChar_t *>(values)[index]);
+    case BranchType::kChar: return static_cast<T>(static_cast<const Char_t *>(values)[index]);
+    case BranchType::kUShort: return static_cast<T>(static_cast<const UShort_t *>(values)[index]);
+    case BranchType::kShort: return static_cast<T>(static_cast<const Short_t *>(values)[index]);
+    case BranchType::kULong64: return static_cast<T>(static_cast<const ULong64_t *>(values)[index]);
+    default: return T(0);
+  }
+}
+
 template <class T>
 double duration(T t0, T t1) {
   auto elapsed_secs = t1 - t0;
@@ -7,21 +7,26 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 #include "Helpers.hpp"
 
 // The progress bar is drawn on the terminal's current line.  Messages must
 // temporarily remove that line, otherwise their output is written over it.
+// With several event loop threads, the mutex keeps messages and the progress line from interleaving.
 namespace Terminal {
 inline std::string progressLine;
+inline std::recursive_mutex mutex;
 
 inline void SetProgress(const std::string& line) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   progressLine = line;
   std::cerr << "\r\033[2K" << progressLine << std::flush;
 }
 
 inline void PrintMessage(const std::string& message) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (progressLine.empty()) {
     std::cout << message << std::flush;
     return;
@@ -31,6 +36,7 @@ inline void PrintMessage(const std::string& message) {
 }
 
 inline void FinishProgress() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (progressLine.empty()) return;
   std::cerr << "\r\033[2K\n" << std::flush;
   progressLine.clear();
@@ -45,6 +51,7 @@ class Logger {
   }
 
   bool addWarning() {
+    std::lock_guard<std::mutex> lock(mutex);
     std::string warning = currentWarningStream.str();
     if (warnings.find(warning) == warnings.end()) {
       warnings[warning] = 1;
@@ -57,6 +64,7 @@ class Logger {
   }
 
   bool addError() {
+    std::lock_guard<std::mutex> lock(mutex);
     std::string error = currentErrorStream.str();
     if (errors.find(error) == errors.end()) {
       errors[error] = 1;
@@ -69,6 +77,7 @@ class Logger {
   }
 
   bool addFatal() {
+    std::lock_guard<std::mutex> lock(mutex);
     std::string fatal = currentFatalStream.str();
     if (fatals.find(fatal) == fatals.end()) {
       fatals[fatal] = 1;
@@ -81,6 +90,7 @@ class Logger {
   }
 
   void Print() {
+    std::lock_guard<std::mutex> lock(mutex);
     Terminal::FinishProgress();
     if (warnings.empty() && errors.empty() && fatals.empty()) return;
 
@@ -100,7 +110,8 @@ class Logger {
     }
   }
 
-  std::ostringstream currentWarningStream, currentErrorStream, currentFatalStream;
+  // Each thread composes its own messages, only the summary maps are shared
+  static inline thread_local std::ostringstream currentWarningStream, currentErrorStream, currentFatalStream;
 
   Logger(Logger const &) = delete;
   Logger &operator=(Logger const &) = delete;
@@ -108,6 +119,7 @@ class Logger {
  private:
   Logger(){};
   std::map<std::string, int> warnings, errors, fatals;
+  std::mutex mutex;
 };
 
 struct info {
@@ -24,39 +24,39 @@ class Multitype {
   Multitype(T *object_, std::string branchName_) : object(object_), branchName(branchName_) {}
 
   operator UInt_t() {
-    checkType("UInt_t");
+    checkType(BranchType::kUInt);
     return object->GetUint(branchName);
   }
   operator Int_t() {
-    checkType("Int_t");
+    checkType(BranchType::kInt);
     return object->GetInt(branchName);
   }
   operator Bool_t() {
-    checkType("Bool_t");
+    checkType(BranchType::kBool);
     return object->GetBool(branchName);
   }
   operator Float_t() {
-    checkType("Float_t");
+    checkType(BranchType::kFloat);
     return object->GetFloat(branchName);
   }
   operator Double_t() {
-    checkType("Double_t");
+    checkType(BranchType::kDouble);
     return object->GetDouble(branchName);
   }
   operator ULong64_t() {
-    checkType("ULong64_t");
+    checkType(BranchType::kULong64);
     return object->GetULong(branchName);
   }
   operator UChar_t() {
-    checkType("UChar_t");
+    checkType(BranchType::kUChar);
     return object->GetUChar(branchName);
   }
   operator UShort_t() {
-    checkType("UShort_t");
+    checkType(BranchType::kUShort);
     return object->GetUShort(branchName);
   }
   operator Short_t() {
-    checkType("Short_t");
+    checkType(BranchType::kShort);
     return object->GetShort(branchName);
   }
 
@@ -64,18 +64,15 @@ class Multitype {
   T *object;
   std::string branchName;
 
-  void checkType(std::string typeName) {
-    std::string branchType;
-    if (object->valuesTypes.find(branchName) != object->valuesTypes.end())
-      branchType = object->valuesTypes.at(branchName);
-    else if (object->customValuesTypes.find(branchName) != object->customValuesTypes.end()) {
-      branchType = object->customValuesTypes.at(branchName);
-    } else {
+  void checkType(BranchType expectedType) {
+    BranchType branchType = object->FindBranchType(branchName);
+    if (branchType == BranchType::kUnknown) {
       std::string message = "Branch not found: " + branchName + "\n";
       throw BadTypeException(message.c_str());
     }
-    if (branchType != typeName) {
-      std::string message = "Casting a physics object-level branch " + branchName + " (" + branchType + ") to " + typeName + "\n";
+    if (branchType != expectedType) {
+      std::string message = "Casting a physics object-level branch " + branchName + " (" + RootTypeName(branchType) +
+                            ") to " + RootTypeName(expectedType) + "\n";
       throw BadTypeException(message.c_str());
     }
   }
@@ -5,7 +5,9 @@
 #ifndef PhysicsObject_hpp
 #define PhysicsObject_hpp
 
+#include "BranchHandle.hpp"
 #include "Collection.hpp"
+#include "ColumnarCollection.hpp"
 #include "Helpers.hpp"
 #include "Multitype.hpp"
 
@@ -15,6 +17,8 @@ typedef Collection<std::shared_ptr<PhysicsObject>> PhysicsObjects;
 class PhysicsObject {
  public:
   PhysicsObject(std::string originalCollection_, int index_ = -1);
+  /// View of the given row of an input collection's columns
+  PhysicsObject(const ColumnarCollection *columns_, int row_);
   PhysicsObject() = default;
   // virtual ~PhysicsObject() = default;
   virtual ~PhysicsObject() {
@@ -34,23 +38,42 @@ class PhysicsObject {
 
   inline std::string GetOriginalCollection() { return originalCollection; }
 
+  /// Columns and row the object's input branches are read from (nullptr and -1 for objects created by hand)
+  inline const ColumnarCollection *GetColumns() const { return columns; }
+  inline int GetRow() const { return row; }
+
   inline void SetIndex(int index_) { index = index_; }
   inline int GetIndex() { return index; }
 
   inline auto Get(std::string branchName, bool verbose = true, const char *file = __builtin_FILE(),
                   const char *function = __builtin_FUNCTION(), int line = __builtin_LINE()) {
-    if (valuesTypes.count(branchName) == 0 && customValuesTypes.count(branchName) == 0 ) {
-      std::string message = "Trying to access incorrect physics object-level branch: ";
-      message += branchName + " from " + originalCollection + " collection";
+    if (!HasBranch(branchName)) ThrowMissingBranch(branchName, verbose, file, function, line);
+    return Multitype(this, branchName);
+  }
 
-      if (verbose) fatal(file, function, line) << message << std::endl;
+  /// Reads a variable through a handle created with Event::ObjectHandle<T>(), without any string lookups
+  template <typename T>
+  inline T Get(const ObjectBranchHandle<T> &handle) const {
+    if (handle.GetColumns() != columns) {
+      std::string message = "Reading " + handle.GetCollectionName() + " handle " + handle.GetVariableName() +
+                            " from an object of " + originalCollection + " collection";
       throw Exception(message.c_str());
     }
-    return Multitype(this, branchName);
+    return handle.Get(row);
   }
 
-  inline bool HasBranch(std::string branchName) {
-    return valuesTypes.count(branchName) > 0 || customValuesTypes.count(branchName) > 0;
+  inline bool HasBranch(const std::string &branchName) const {
+    return FindBranchType(branchName) != BranchType::kUnknown;
+  }
+
+  /// Returns the type of an input or custom branch (kUnknown if the object doesn't have it)
+  inline BranchType FindBranchType(const std::string &branchName) const {
+    if (columns) {
+      const Column *column = columns->GetColumn(branchName);
+      if (column) return column->type;
+    }
+    auto typeIt = customValuesTypes.find(branchName);
+    return typeIt == customValuesTypes.end() ? BranchType::kUnknown : typeIt->second;
   }
 
   inline TLorentzVector GetFourVector() {
@@ -59,93 +82,31 @@ class PhysicsObject {
     return vec;
   }
 
+  /// Returns value of a branch of any numerical type converted to T
   template <typename T>
-  T GetAs(std::string branchName) {
-    if (defaultCollectionsTypes.count(branchName)) {
-      std::string branchType = defaultCollectionsTypes[branchName];
-      if (branchType == "Int_t") {
-        Int_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Bool_t") {
-        Bool_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Float_t") {
-        Float_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Double_t") {
-        Double_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UChar_t") {
-        UChar_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UShort_t") {
-        UShort_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "Short_t") {
-        Short_t value = Get(branchName);
-        return value;
-      }
-      if (branchType == "UInt_t") {
-        UInt_t value = Get(branchName);
-        return value;
-      }
+  T GetAs(const std::string &branchName, const char *file = __builtin_FILE(),
+          const char *function = __builtin_FUNCTION(), int line = __builtin_LINE()) {
+    if (columns) {
+      const Column *column = columns->GetColumn(branchName);
+      if (column) return ReadValueAs<T>(column->type, column->Data(), row);
     }
 
-    try {
-      Float_t value = Get(branchName);
-      defaultCollectionsTypes[branchName] = "Float_t";
-      return value;
-    } catch (BadTypeException &e) {
-      try {
-        Double_t value = Get(branchName);
-        defaultCollectionsTypes[branchName] = "Double_t";
-        return value;
-      } catch (BadTypeException &e) {
-        try {
-          Int_t value = Get(branchName);
-          defaultCollectionsTypes[branchName] = "Int_t";
-          return value;
-        } catch (BadTypeException &e) {
-          try {
-            UChar_t value = Get(branchName);
-            defaultCollectionsTypes[branchName] = "UChar_t";
-            return value;
-          } catch (BadTypeException &e) {
-            try {
-              UShort_t value = Get(branchName);
-              defaultCollectionsTypes[branchName] = "UShort_t";
-              return value;
-            } catch (BadTypeException &e) {
-              try {
-                Short_t value = Get(branchName);
-                defaultCollectionsTypes[branchName] = "Short_t";
-                return value;
-              } catch (BadTypeException &e) {
-                try {
-                  UInt_t value = Get(branchName);
-                  defaultCollectionsTypes[branchName] = "UInt_t";
-                  return value;
-                } catch (BadTypeException &e) {
-                  try {
-                    Bool_t value = Get(branchName);
-                    defaultCollectionsTypes[branchName] = "Bool_t";
-                    return value;
-                  } catch (BadTypeException &e) {
-                    error() << "Couldn't get value for branch " << branchName << std::endl;
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
+    auto typeIt = customValuesTypes.find(branchName);
+    if (typeIt == customValuesTypes.end()) ThrowMissingBranch(branchName, true, file, function, line);
+
+    switch (typeIt->second) {
+      case BranchType::kFloat: return static_cast<T>(*customValuesFloat[branchName]);
+      case BranchType::kDouble: return static_cast<T>(*customValuesDouble[branchName]);
+      case BranchType::kInt: return static_cast<T>(*customValuesInt[branchName]);
+      case BranchType::kUInt: return static_cast<T>(*customValuesUint[branchName]);
+      case BranchType::kBool: return static_cast<T>(*customValuesBool[branchName]);
+      case BranchType::kUChar: return static_cast<T>(*customValuesUchar[branchName]);
+      case BranchType::kUShort: return static_cast<T>(*customValuesUshort[branchName]);
+      case BranchType::kShort: return static_cast<T>(*customValuesShort[branchName]);
+      case BranchType::kULong64: return static_cast<T>(*customValuesUlong[branchName]);
+      default: break;
     }
+    error() << "Couldn't get value for branch " << branchName << std::endl;
     return 0;
   }
 
@@ -190,7 +151,7 @@ class PhysicsObject {
       static_assert(!sizeof(T), "PhysicsObject::Set<T>: unsupported type");
     }
 
-    customValuesTypes[branchName] = RootTypeName<T>();
+    customValuesTypes[branchName] = RootTypeTag<T>();
     RememberCustomValues();
   }
 
@@ -201,7 +162,7 @@ class PhysicsObject {
   void SetFloat(std::string branchName, float value) {
     if (!HasCustomValue(branchName)) {
       customValuesFloat[branchName] = new float(value);
-      customValuesTypes[branchName] = "Float_t";
+      customValuesTypes[branchName] = BranchType::kFloat;
     } else {
       *customValuesFloat[branchName] = value;
     }
@@ -220,59 +181,40 @@ class PhysicsObject {
 
   bool hasCustomValues = false;
 
-  inline UInt_t GetUint(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesUint[branchName];
-    return *customValuesUint[branchName];
-  }
-  inline Int_t GetInt(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesInt[branchName];
-    return *customValuesInt[branchName];
-  }
-  inline Bool_t GetBool(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesBool[branchName];
-    return *customValuesBool[branchName];
-  }
-  inline Float_t GetFloat(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end())
-      return *valuesFloat[branchName];
-    return *customValuesFloat[branchName];
-  }
-  inline Double_t GetDouble(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesDouble[branchName];
-    return *customValuesDouble[branchName];
-  }
-  inline ULong64_t GetULong(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesUlong[branchName];
-    return *customValuesUlong[branchName];
-  }
-  inline UChar_t GetUChar(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesUchar[branchName];
-    return *customValuesUchar[branchName];
+  [[noreturn]] void ThrowMissingBranch(const std::string &branchName, bool verbose, const char *file,
+                                       const char *function, int line) const {
+    std::string message = "Trying to access incorrect physics object-level branch: ";
+    message += branchName + " from " + originalCollection + " collection";
+
+    if (verbose) fatal(file, function, line) << message << std::endl;
+    throw Exception(message.c_str());
   }
-  inline UChar_t GetChar(std::string branchName) { return *valuesChar[branchName]; }
-  inline UShort_t GetUShort(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesUshort[branchName];
-    return *customValuesUshort[branchName];
+
+  // input values take precedence over custom values with the same name
+  template <typename T, typename CustomValues>
+  inline T GetValue(const std::string &branchName, CustomValues &customValues) {
+    if (columns) {
+      const Column *column = columns->GetColumn(branchName);
+      if (column) return static_cast<const T *>(column->Data())[row];
+    }
+    return *customValues[branchName];
   }
-  inline Short_t GetShort(std::string branchName) {
-    if (valuesTypes.find(branchName) != valuesTypes.end()) return *valuesShort[branchName];
-    return *customValuesShort[branchName];
+
+  inline UInt_t GetUint(const std::string &branchName) { return GetValue<UInt_t>(branchName, customValuesUint); }
+  inline Int_t GetInt(const std::string &branchName) { return GetValue<Int_t>(branchName, customValuesInt); }
+  inline Bool_t GetBool(const std::string &branchName) { return GetValue<Bool_t>(branchName, customValuesBool); }
+  inline Float_t GetFloat(const std::string &branchName) { return GetValue<Float_t>(branchName, customValuesFloat); }
+  inline Double_t GetDouble(const std::string &branchName) { return GetValue<Double_t>(branchName, customValuesDouble); }
+  inline ULong64_t GetULong(const std::string &branchName) { return GetValue<ULong64_t>(branchName, customValuesUlong); }
+  inline UChar_t GetUChar(const std::string &branchName) { return GetValue<UChar_t>(branchName, customValuesUchar); }
+  inline UChar_t GetChar(const std::string &branchName) {
+    const Column *column = columns ? columns->GetColumn(branchName) : nullptr;
+    return column ? static_cast<const Char_t *>(column->Data())[row] : 0;
   }
+  inline UShort_t GetUShort(const std::string &branchName) { return GetValue<UShort_t>(branchName, customValuesUshort); }
+  inline Short_t GetShort(const std::string &branchName) { return GetValue<Short_t>(branchName, customValuesShort); }
 
-  // contains all branch names and corresponding types
-  std::map<std::string, std::string> valuesTypes;
-  std::map<std::string, std::string> customValuesTypes;
-
-  std::map<std::string, UInt_t *> valuesUint;
-  std::map<std::string, Int_t *> valuesInt;
-  std::map<std::string, Bool_t *> valuesBool;
-  std::map<std::string, Float_t *> valuesFloat;
-  std::map<std::string, Double_t *> valuesDouble;
-  std::map<std::string, ULong64_t *> valuesUlong;
-  std::map<std::string, UChar_t *> valuesUchar;
-  std::map<std::string, Char_t *> valuesChar;
-  std::map<std::string, UShort_t *> valuesUshort;
-  std::map<std::string, Short_t *> valuesShort;
+  std::map<std::string, BranchType> customValuesTypes;
 
   std::map<std::string, Float_t*> customValuesFloat;
   std::map<std::string, Double_t*> customValuesDouble;
@@ -286,7 +228,11 @@ class PhysicsObject {
 
   std::string originalCollection;
   int index;
-  std::map<std::string, std::string> defaultCollectionsTypes;
+
+  // input branches are read from a row of the collection's columns (not set for objects created by hand)
+  const ColumnarCollection *columns = nullptr;
+  int row = -1;
+
 
   friend class EventReader;
   template <typename T>
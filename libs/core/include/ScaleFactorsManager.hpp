@@ -5,25 +5,28 @@
 #ifndef ScaleFactorsManager_hpp
 #define ScaleFactorsManager_hpp
 
+#include <atomic>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <shared_mutex>
 
+#include "CorrectionTable.hpp"
 #include "Helpers.hpp"
 
-#ifdef USE_CORRECTIONLIB
-#include "correction.h"
-using CorrectionRef = correction::Correction::Ref;
-using CompoundCorrectionRef = correction::CompoundCorrection::Ref;
-using CorrectionArgType = correction::Variable::Type;
-#else
-struct DummyCorrectionRef {};
-using CorrectionRef = DummyCorrectionRef;
-using CompoundCorrectionRef = DummyCorrectionRef;
-using CorrectionArgType = std::variant<long, double, std::string>;
-#endif
-
 struct MuonID;
 struct MuonIso;
 
+/// Scale factors of all objects of a collection, for the systematic and all its variations
+struct ScaleFactorsBatch {
+  std::vector<std::string> names;  // "systematic" first, then the variations
+  size_t nObjects = 0;
+  std::vector<float> values;       // [name * nObjects + object]
+  std::vector<float> products;     // product over all objects, for each name
+
+  inline float Get(size_t iName, size_t iObject) const { return values[iName * nObjects + iObject]; }
+  std::map<std::string, float> GetProducts() const;
+};
+
 class ScaleFactorsManager {
  public:
   static ScaleFactorsManager& GetInstance() {
@@ -39,6 +42,12 @@ class ScaleFactorsManager {
   std::map<std::string, float> GetDSAMuonScaleFactors(std::string name, const std::vector<CorrectionArgType>& args);
   std::map<std::string, float> GetMuonTriggerScaleFactors(std::string name, float eta, float pt);
   std::map<std::string, float> GetBTagScaleFactors(std::string name, float eta, float pt);
+
+  /// Scale factors for n objects at once, given their eta and pt columns. The batch is owned by the caller (e.g. one per
+  /// worker of the event loop), so that its buffers can be reused in each event. Use one batch per correction.
+  void GetPUJetIDScaleFactors(std::string name, const float* eta, const float* pt, size_t nObjects, ScaleFactorsBatch& batch);
+  void GetMuonScaleFactors(std::string name, const float* eta, const float* pt, size_t nObjects, ScaleFactorsBatch& batch);
+  void GetBTagScaleFactors(std::string name, const float* eta, const float* pt, size_t nObjects, ScaleFactorsBatch& batch);
   float GetJetTagEfficiency(std::string name, std::string datasetName, float pt);
 
   std::map<std::string, float> GetPileupScaleFactor(std::string name, float nVertices);
@@ -53,6 +62,10 @@ class ScaleFactorsManager {
   bool IsJetVetoMapDefined(std::string name);
   bool IsJetInBadRegion(std::string name, float eta, float phi);
 
+  /// Loads the given corrections right away, reading all their files in parallel (otherwise each file is read when one
+  /// of its corrections is first used, e.g. in the event loop). Corrections loaded this way are not marked as used.
+  void LoadCorrections(const std::vector<std::string>& names);
+  /// Loads all jet energy corrections right away, with LoadCorrections()
   void ReadJetEnergyCorrections();
   bool ShouldApplyJetEnergyCorrections() { return ShouldApplyScaleFactor("jec") || ShouldApplyVariation("jec"); }
   std::map<std::string, float> GetJetEnergyCorrectionUncertainties(std::map<std::string, float> inputArguments);
@@ -63,6 +76,9 @@ class ScaleFactorsManager {
   bool ShouldApplyScaleFactor(const std::string& name);
   bool ShouldApplyVariation(const std::string& name);
 
+  /// Lists corrections which were loaded, but never used by the app (does nothing if the manager was never created)
+  static void PrintUnusedCorrections();
+
  private:
   ScaleFactorsManager();
   ~ScaleFactorsManager() {}
@@ -73,21 +89,110 @@ class ScaleFactorsManager {
   }
   std::map<std::string, std::vector<bool>> applyScaleFactors;
   bool scaleFactorsRead = false;
+  static inline bool created = false;
+
+  // Corrections are loaded when first used, since most apps only need a few of the configured ones. Workers of the
+  // event loop share the manager: the maps below are only modified under both loadingMutex and an exclusive lock of
+  // correctionsMutex, and read under a shared lock of correctionsMutex (or under loadingMutex).
+  std::map<std::string, std::map<std::string, std::string>> scaleFactorsConfig;
+  std::set<std::string> loadedEntries;    // config entries already loaded (or found to be disabled)
+  std::set<std::string> usedCorrections;  // corrections requested by the app
+  std::mutex loadingMutex;
+  std::shared_mutex correctionsMutex;
 
   std::map<std::string, CorrectionRef> corrections;
   std::map<std::string, CompoundCorrectionRef> compoundCorrections;
   std::map<std::string, std::map<std::string, std::string>> correctionsExtraArgs;
+  std::map<std::string, CorrectionTable> correctionTables;  // binned corrections, evaluated without correctionlib
 
   std::map<std::string, std::map<std::string, std::pair<double, double>>> boundsPerInput;
 
-  void ExtractBounds(const nlohmann::json& node, std::map<std::string, std::pair<double, double>>& bounds);
+  /// Results of a correction for all requested variations, stored per bin of the per-object inputs. Only used for
+  /// corrections made of binnings and categories, for which the result can't change within a bin. Everything but the
+  /// values is set up once, under loadingMutex, and only read after initialized is set.
+  struct CorrectionCache {
+    std::atomic<bool> initialized = false;
+    bool binned = false;
+    std::vector<std::vector<double>> edges;  // union of bin edges of each input (empty if the input is not binned)
+
+    std::vector<std::string> variations;     // as listed in the config
+    std::string statistical;                 // statistical uncertainty, if requested and defined in the config
+    std::vector<std::string> variationArgs;  // values of the variation argument, evaluated together in each call
+
+    std::unordered_map<uint64_t, std::vector<float>> values;
+    std::shared_mutex valuesMutex;  // bins are mostly looked up, and only filled the first time they're seen
+  };
+  std::map<std::string, CorrectionCache> correctionCaches;  // entries never move, so references can be kept
+
+  void ExtractBounds(const nlohmann::json& node, std::map<std::string, std::pair<double, double>>& bounds) const;
+  void ExtractBinEdges(const nlohmann::json& node, std::map<std::string, std::vector<double>>& edges, bool& piecewiseConstant) const;
+
+  CorrectionCache& GetCorrectionCache(const std::string& name, bool applyDefault, bool applyVariations, bool withStatistical = false);
+  bool GetCacheKey(const CorrectionCache& cache, const std::vector<CorrectionArgType>& args, size_t firstObjectArg,
+                   size_t nObjectArgs, uint64_t& key);
+
+  /// Evaluates the correction for each of cache.variationArgs, put in args[variationArg], and stores the results in
+  /// values. Arguments in [firstObjectArg, firstObjectArg + nObjectArgs) are the ones changing between objects, all the
+  /// others must be constant for a given correction (e.g. working points from the config).
+  void EvaluateVariations(const std::string& name, CorrectionCache& cache, std::vector<CorrectionArgType>& args,
+                          size_t variationArg, size_t firstObjectArg, size_t nObjectArgs, std::vector<float>& values);
+
+  /// Fills the batch with the correction, with eta of each object put in args[etaArg] and pt in args[etaArg + 1]
+  void EvaluateBatch(const std::string& name, std::vector<CorrectionArgType>& args, size_t variationArg, size_t etaArg,
+                     bool absEta, const float* eta, const float* pt, size_t nObjects, bool applyDefault,
+                     bool applyVariations, ScaleFactorsBatch& batch, bool withStatistical = false);
+  void FillNeutralBatch(size_t nObjects, ScaleFactorsBatch& batch);
+
+  /// Everything ScaleFactorsManager extracts from a correction in a JSON file, which can be cached on disk
+  struct CompiledCorrection {
+    std::map<std::string, std::pair<double, double>> bounds;
+    std::vector<std::vector<double>> edges;  // union of bin edges of each input
+    bool binned = false;
+    CorrectionTable table;
+
+    void Write(std::ostream& out) const;
+    bool Read(std::istream& in);
+  };
+
+  /// Corrections needed from one JSON file
+  struct CorrectionFile {
+    std::map<std::string, CompiledCorrection> corrections;
+    std::vector<std::string> availableCorrections;  // only filled if the JSON was parsed
+#ifdef USE_CORRECTIONLIB
+    std::shared_ptr<correction::CorrectionSet> correctionSet;
+#endif
+  };
+  std::string scaleFactorsCacheDir;
 
   void ReadScaleFactorFlags();
   void ReadScaleFactors();
 
+  /// Loads the correction if it wasn't loaded yet, and marks it as used
+  void LoadCorrection(const std::string& name);
+  /// Loads all the scale factors from the files that were not loaded yet, reading multiple files in parallel
+  void LoadScaleFactors(const std::set<std::string>& paths);
+  void LoadJetEnergyCorrections(const std::set<std::string>& names);
+
+  /// Reads and parses the file once for all requested corrections
+  CorrectionFile LoadCorrectionFile(const std::string& path, const std::set<std::string>& types) const;
+  CompiledCorrection CompileCorrection(const nlohmann::json& correction) const;
+
+  /// Loads the correction if needed, returns false if it's not in the config
+  bool IsCorrectionDefined(const std::string& name);
+
+  /// Entry of one of the maps of corrections, or nullptr if there's none. Entries never move or change once added.
+  template <typename T>
+  const T* Find(const std::map<std::string, T>& items, const std::string& name) {
+    std::shared_lock<std::shared_mutex> lock(correctionsMutex);
+    auto item = items.find(name);
+    return item == items.end() ? nullptr : &item->second;
+  }
+  std::map<std::string, std::string> GetExtraArgs(const std::string& name);
+
   float TryToEvaluate(const std::string& name, const std::vector<CorrectionArgType>& args);
 
   #ifdef USE_CORRECTIONLIB
+    const CorrectionRef& GetCorrection(const std::string& name);
     float EvaluateCorrectionArgs(const std::string& name, const std::vector<correction::Variable::Type>& args);
   #endif
 
@@ -0,0 +1,53 @@
+//  SelectionPlan.hpp
+
+#ifndef SelectionPlan_hpp
+#define SelectionPlan_hpp
+
+#include "ColumnarCollection.hpp"
+#include "Helpers.hpp"
+#include "PhysicsObject.hpp"
+
+/// A cut of an extra collection, resolved against the columns of a specific input collection
+struct SelectionCut {
+  std::string branchName;
+  const Column *column = nullptr;  // nullptr if the variable is not an input branch (it's then read with GetAs)
+  double min, max;
+};
+
+/// Selection of an extra collection (extraEventCollections in the config), compiled once instead of looking up
+/// branches by name for every object and cut. For input collections read from the tree, cuts are applied column by
+/// column in branch-free loops over all objects, and only objects passing all of them are added to the output.
+class SelectionPlan {
+ public:
+  SelectionPlan(std::string name_, const ExtraCollection &description);
+
+  inline const std::string &GetName() const { return name; }
+  inline const std::vector<std::string> &GetInputCollections() const { return inputCollections; }
+
+  /// Returns an empty output collection. Memory of the previous event's collection is reused, unless
+  /// someone still holds it.
+  std::shared_ptr<PhysicsObjects> NewOutputCollection();
+
+  /// Adds objects of the input collection that pass all cuts to the output. Input columns should be given if the
+  /// input is a collection read from the tree (objects are then rows of these columns in order).
+  void Select(const std::shared_ptr<PhysicsObjects> &input, const ColumnarCollection *inputColumns,
+              PhysicsObjects &output);
+
+ private:
+  std::string name;
+  std::vector<std::string> inputCollections;
+  std::vector<std::pair<std::string, std::pair<double, double>>> cuts;  // flags first, then other cuts
+
+  // cuts resolved for each set of columns objects came from so far
+  std::vector<std::pair<const ColumnarCollection *, std::vector<SelectionCut>>> resolvedCuts;
+  std::vector<unsigned char> passes;
+  std::shared_ptr<PhysicsObjects> outputCollection;
+
+  const std::vector<SelectionCut> &GetResolvedCuts(const ColumnarCollection *columns);
+
+  void SelectRows(const std::shared_ptr<PhysicsObjects> &input, const ColumnarCollection *inputColumns,
+                  PhysicsObjects &output);
+  void SelectObjects(const std::shared_ptr<PhysicsObjects> &input, PhysicsObjects &output);
+};
+
+#endif /* SelectionPlan_hpp */
@@ -6,6 +6,7 @@
 #include <limits>
 
 #include "ConfigManager.hpp"
+#include "TChain.h"
 #include "TTreeFormula.h"
 
 using namespace std;
@@ -79,7 +80,7 @@ AddedBranches::~AddedBranches() {
   for (auto &[name, formula] : formulas) delete formula;
 }
 
-void AddedBranches::Setup(const vector<string> &eventsTreeNames, const map<string, TTree *> &inputTrees) {
+void AddedBranches::Setup(const vector<string> &eventsTreeNames, const map<string, TChain *> &inputTrees) {
   static int formulaCounter = 0;
 
   for (auto &spec : specs) {
@@ -137,6 +138,21 @@ void AddedBranches::Setup(const vector<string> &eventsTreeNames, const map<strin
   }
 }
 
+vector<string> AddedBranches::GetInputBranchNames() const {
+  vector<string> branchNames;
+  for (auto &[name, formula] : formulas) {
+    for (int i = 0; i < formula->GetNcodes(); i++) {
+      TLeaf *leaf = formula->GetLeaf(i);
+      if (leaf && leaf->GetBranch()) branchNames.push_back(leaf->GetBranch()->GetName());
+    }
+  }
+  return branchNames;
+}
+
+void AddedBranches::UpdateFormulaLeaves() {
+  for (auto &[name, formula] : formulas) formula->UpdateFormulaLeaves();
+}
+
 void AddedBranches::Evaluate(const shared_ptr<Event> &event) {
   for (auto &spec : specs) {
     if (spec.varexp.empty()) continue;
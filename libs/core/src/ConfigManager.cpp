@@ -4,6 +4,8 @@
 
 #include "ConfigManager.hpp"
 
+#include <Python.h>
+
 #include <type_traits>
 
 #include "Logger.hpp"
@@ -49,9 +51,118 @@ ConfigManager::ConfigManager(std::string* const _configPath) {
   }
 
   configPath = std::move(*_configPath);
+
+  // Evaluated configs can be saved in a directory given by TEA_CONFIG_SNAPSHOT_DIR. Jobs with a config (and imported
+  // files) that didn't change since then read the values from the snapshot, without starting python.
+  const char* snapshotDir = getenv("TEA_CONFIG_SNAPSHOT_DIR");
+  string snapshotPath = snapshotDir && *snapshotDir ? GetSnapshotPath(snapshotDir) : "";
+
+  if (!snapshotPath.empty() && ReadSnapshot(snapshotPath)) {
+    info() << "Config read from snapshot: " << snapshotPath << endl;
+    return;
+  }
+  bool succeeded = RunPythonConfig();
+  if (!snapshotPath.empty() && succeeded) WriteSnapshot(snapshotPath);
+}
+
+ConfigManager::~ConfigManager() {
+  if (Py_IsInitialized()) Py_Finalize();
+}
+
+namespace {
+/// Returns false if the value (or any value nested in it) can't be converted, with the reason in error
+bool ConvertPythonValue(PyObject* object, ConfigValue& value, string& error) {
+  using Type = ConfigValue::Type;
+
+  if (object == Py_None) {
+    value.type = Type::kNone;
+  } else if (PyBool_Check(object)) {
+    value.type = Type::kBool;
+    value.intValue = object == Py_True;
+  } else if (PyLong_Check(object)) {
+    value.type = Type::kInt;
+    value.intValue = PyLong_AsLongLong(object);
+  } else if (PyFloat_Check(object)) {
+    value.type = Type::kFloat;
+    value.floatValue = PyFloat_AsDouble(object);
+  } else if (PyUnicode_Check(object)) {
+    value.type = Type::kString;
+    const char* string = PyUnicode_AsUTF8(object);
+    if (string) value.stringValue = string;
+  } else if (PyList_Check(object) || PyTuple_Check(object)) {
+    bool isList = PyList_Check(object);
+    value.type = isList ? Type::kList : Type::kTuple;
+    Py_ssize_t size = isList ? PyList_Size(object) : PyTuple_Size(object);
+    value.items.resize(size);
+    for (Py_ssize_t i = 0; i < size; i++) {
+      PyObject* item = isList ? PyList_GetItem(object, i) : PyTuple_GetItem(object, i);
+      if (!ConvertPythonValue(item, value.items[i], error)) return false;
+    }
+  } else if (PyDict_Check(object)) {
+    value.type = Type::kDict;
+    PyObject *key, *item;
+    Py_ssize_t pos = 0;
+    while (PyDict_Next(object, &pos, &key, &item)) {
+      value.keys.emplace_back();
+      value.items.emplace_back();
+      if (!ConvertPythonValue(key, value.keys.back(), error) || !ConvertPythonValue(item, value.items.back(), error)) return false;
+    }
+  } else {
+    // modules, functions, classes...
+    error = string("it contains a value of type ") + Py_TYPE(object)->tp_name;
+    return false;
+  }
+
+  // e.g. ints which don't fit in 64 bits
+  if (PyErr_Occurred()) {
+    PyErr_Clear();
+    error = "it contains a number out of range";
+    return false;
+  }
+  return true;
+}
+
+/// Whether the object holds data, which should be readable from the config (unlike e.g. imported modules)
+bool IsPythonData(PyObject* object) {
+  return object == Py_None || PyLong_Check(object) || PyFloat_Check(object) || PyUnicode_Check(object) ||
+         PyList_Check(object) || PyTuple_Check(object) || PyDict_Check(object);
+}
+
+/// Files of the modules imported by the config, apart from python's own and installed packages
+vector<string> GetImportedFiles() {
+  vector<string> prefixes;
+  for (const char* name : {"prefix", "base_prefix", "exec_prefix", "base_exec_prefix"}) {
+    PyObject* prefix = PySys_GetObject(name);
+    if (prefix && PyUnicode_Check(prefix)) prefixes.push_back(PyUnicode_AsUTF8(prefix));
+  }
+
+  vector<string> files;
+  PyObject* modules = PyDict_Values(PyImport_GetModuleDict());
+  for (Py_ssize_t i = 0; i < PyList_Size(modules); i++) {
+    PyObject* file = PyObject_GetAttrString(PyList_GetItem(modules, i), "__file__");
+    if (!file) {
+      PyErr_Clear();
+      continue;
+    }
+    if (PyUnicode_Check(file)) {
+      string path = PyUnicode_AsUTF8(file);
+      bool isExternal = false;
+      for (auto& prefix : prefixes) isExternal |= !prefix.empty() && path.rfind(prefix, 0) == 0;
+      if (!isExternal && filesystem::is_regular_file(path)) files.push_back(filesystem::absolute(path).string());
+    }
+    Py_DECREF(file);
+  }
+  Py_DECREF(modules);
+  return files;
+}
+
+const uint32_t configSnapshotVersion = 1;
+}  // namespace
+
+bool ConfigManager::RunPythonConfig() {
   Py_Initialize();
 
-  pythonFile = fopen(configPath.c_str(), "r");
+  FILE* pythonFile = fopen(configPath.c_str(), "r");
 
   if (!pythonFile) {
     fatal() << "Could not parse python config: " << configPath << endl;
@@ -59,65 +170,161 @@ ConfigManager::ConfigManager(std::string* const _configPath) {
     exit(1);
   }
 
-  PyRun_SimpleFile(pythonFile, configPath.c_str());
+  bool succeeded = PyRun_SimpleFile(pythonFile, configPath.c_str()) == 0;
   fclose(pythonFile);
 
-  pythonModule = PyImport_ImportModule("__main__");
+  PyObject* pythonModule = PyImport_ImportModule("__main__");
   if (!pythonModule) {
     fatal() << "Couldn't import __main__ from the python module" << endl;
     Py_Finalize();
     exit(1);
   }
 
-  config = PyModule_GetDict(pythonModule);
+  // All values are converted right away, so that reading them later doesn't involve the interpreter (which also
+  // makes it safe from any thread). Variables of other types (modules, functions...) are skipped, while data which
+  // can't be converted is reported, as reading it later would only tell that the variable is missing.
+  PyObject* globals = PyModule_GetDict(pythonModule);
+  PyObject *name, *object;
+  Py_ssize_t pos = 0;
+  while (PyDict_Next(globals, &pos, &name, &object)) {
+    if (!PyUnicode_Check(name)) continue;
+    string nameString = PyUnicode_AsUTF8(name);
+    if (nameString.rfind("__", 0) == 0) continue;
+
+    ConfigValue value;
+    string conversionError;
+    if (ConvertPythonValue(object, value, conversionError)) {
+      values[nameString] = std::move(value);
+    } else if (IsPythonData(object)) {
+      warn() << "Config variable " << nameString << " will be ignored, since " << conversionError << endl;
+    }
+  }
+  importedFiles = GetImportedFiles();
+  Py_DECREF(pythonModule);
+
+  // The interpreter is not finalized here, since modules imported by the config (e.g. ROOT) may still be in use
+  return succeeded;
 }
 
-ConfigManager::~ConfigManager() { Py_Finalize(); }
+string ConfigManager::GetSnapshotPath(const string& snapshotDir) {
+  string content;
+  if (!readFile(configPath, content)) return "";
 
-int ConfigManager::GetCollectionSize(PyObject* collection) {
-  int size = -1;
-  if (PyList_Check(collection))
-    size = PyList_Size(collection);
-  else if (PyTuple_Check(collection))
-    size = PyTuple_Size(collection);
-  return size;
+  stringstream path;
+  path << snapshotDir << "/" << hex << hashBytes(content) << ".bin";
+  return path.str();
 }
 
-PyObject* ConfigManager::GetItem(PyObject* collection, int index) {
-  PyObject* item;
+bool ConfigManager::ReadSnapshot(const string& snapshotPath) {
+  ifstream snapshot(snapshotPath, ios::binary);
+  if (!snapshot) return false;
 
-  if (PyList_Check(collection))
-    item = PyList_GetItem(collection, index);
-  else if (PyTuple_Check(collection))
-    item = PyTuple_GetItem(collection, index);
+  uint32_t version;
+  vector<string> files;
+  vector<uint64_t> hashes;
+  if (!ReadBinary(snapshot, version) || version != configSnapshotVersion) return false;
+  if (!ReadBinary(snapshot, files) || !ReadBinary(snapshot, hashes) || files.size() != hashes.size()) return false;
 
-  return item;
+  // files imported from the config's directory are stored relative to it, so that a snapshot made for a copy of the
+  // config (e.g. on a grid node) checks the files next to this one
+  auto configDir = filesystem::absolute(configPath).parent_path();
+  for (size_t i = 0; i < files.size(); i++) {
+    filesystem::path file = files[i];
+    if (file.is_relative()) file = configDir / file;
+
+    string content;
+    if (!readFile(file.string(), content) || hashBytes(content) != hashes[i]) {
+      info() << "Config snapshot is outdated (" << file.string() << " changed), it will be updated" << endl;
+      return false;
+    }
+  }
+
+  vector<string> names;
+  if (!ReadBinary(snapshot, names)) return false;
+  for (auto& name : names) {
+    if (!values[name].Read(snapshot)) {
+      values.clear();
+      return false;
+    }
+  }
+  return true;
 }
 
+void ConfigManager::WriteSnapshot(const string& snapshotPath) {
+  auto configDir = filesystem::absolute(configPath).parent_path();
+
+  vector<string> files;
+  vector<uint64_t> hashes;
+  for (auto& file : importedFiles) {
+    string content;
+    if (!readFile(file, content)) continue;
+
+    auto relativePath = filesystem::path(file).lexically_relative(configDir);
+    bool inConfigDir = !relativePath.empty() && *relativePath.begin() != "..";
+    files.push_back(inConfigDir ? relativePath.string() : file);
+    hashes.push_back(hashBytes(content));
+  }
+
+  vector<string> names;
+  for (auto& [name, value] : values) names.push_back(name);
+
+  error_code errorCode;
+  filesystem::create_directories(filesystem::path(snapshotPath).parent_path(), errorCode);
+
+  // written to a temporary file first, so that jobs starting at the same time never read a partially written one
+  string temporaryPath = snapshotPath + ".tmp" + to_string(randInt(0, 1000000000));
+  {
+    ofstream snapshot(temporaryPath, ios::binary);
+    WriteBinary(snapshot, configSnapshotVersion);
+    WriteBinary(snapshot, files);
+    WriteBinary(snapshot, hashes);
+    WriteBinary(snapshot, names);
+    for (auto& [name, value] : values) value.Write(snapshot);
+    if (!snapshot) {
+      warn() << "Couldn't write config snapshot: " << snapshotPath << endl;
+      filesystem::remove(temporaryPath, errorCode);
+      return;
+    }
+  }
+  filesystem::rename(temporaryPath, snapshotPath, errorCode);
+  if (errorCode) {
+    filesystem::remove(temporaryPath, errorCode);
+    return;
+  }
+  info() << "Config snapshot saved: " << snapshotPath << endl;
+}
+
+int ConfigManager::GetCollectionSize(const ConfigValue* collection) { return collection->Size(); }
+
+const ConfigValue* ConfigManager::GetItem(const ConfigValue* collection, int index) { return collection->Item(index); }
+
 //-------------------------------------------------------------------------------------------------
 // Methods to retrieve a value/list/dict from the python file
 //-------------------------------------------------------------------------------------------------
 
-PyObject* ConfigManager::GetPythonValue(string name) {
-  PyObject* pythonValue = PyDict_GetItemString(config, name.c_str());
+const ConfigValue* ConfigManager::GetConfigValue(string name) {
+  auto value = values.find(name);
+  const ConfigValue* pythonValue = value == values.end() ? nullptr : &value->second;
   if (!pythonValue) {
     throw Exception(("Could not find a value in python config file: " + name).c_str());
   }
   return pythonValue;
 }
 
-PyObject* ConfigManager::GetPythonList(string name) {
-  PyObject* pythonList = PyDict_GetItemString(config, name.c_str());
+const ConfigValue* ConfigManager::GetConfigList(string name) {
+  auto value = values.find(name);
+  const ConfigValue* pythonList = value == values.end() ? nullptr : &value->second;
 
-  if (!pythonList || (!PyList_Check(pythonList) && !PyTuple_Check(pythonList))) {
+  if (!pythonList || (!pythonList->IsList() && !pythonList->IsTuple())) {
     throw Exception(("Could not find a list/tuple in python config file: " + name).c_str());
   }
   return pythonList;
 }
 
-PyObject* ConfigManager::GetPythonDict(string name) {
-  PyObject* pythonDict = PyDict_GetItemString(config, name.c_str());
-  if (!pythonDict || !PyDict_Check(pythonDict)) {
+const ConfigValue* ConfigManager::GetConfigDict(string name) {
+  auto value = values.find(name);
+  const ConfigValue* pythonDict = value == values.end() ? nullptr : &value->second;
+  if (!pythonDict || !pythonDict->IsDict()) {
     throw Exception(("Could not find a dict in python config file: " + name).c_str());
   }
   return pythonDict;
@@ -142,42 +349,42 @@ void ConfigManager::GetValue<string>(std::string name, string& outputValue) {
     return;
   }
 
-  PyObject* pythonValue = GetPythonValue(name);
-  if (!pythonValue || !PyUnicode_Check(pythonValue)) {
+  const ConfigValue* pythonValue = GetConfigValue(name);
+  if (!pythonValue || !pythonValue->IsString()) {
     error() << "Failed retrieving python value (string)" << endl;
     return;
   }
-  outputValue = PyUnicode_AsUTF8(pythonValue);
+  outputValue = pythonValue->AsString();
 }
 
 template <>
 void ConfigManager::GetValue<int>(std::string name, int& outputValue) {
-  PyObject* pythonValue = GetPythonValue(name);
-  if (!pythonValue || (!PyUnicode_Check(pythonValue) && !PyLong_Check(pythonValue))) {
+  const ConfigValue* pythonValue = GetConfigValue(name);
+  if (!pythonValue || (!pythonValue->IsString() && !pythonValue->IsInt())) {
     error() << "Failed retrieving python value (int)" << endl;
     return;
   }
-  outputValue = PyLong_AsLong(pythonValue);
+  outputValue = pythonValue->AsLong();
 }
 
 template <>
 void ConfigManager::GetValue<bool>(std::string name, bool& outputValue) {
-  PyObject* pythonValue = GetPythonValue(name);
-  if (!pythonValue || (!PyUnicode_Check(pythonValue) && !PyBool_Check(pythonValue))) {
+  const ConfigValue* pythonValue = GetConfigValue(name);
+  if (!pythonValue || (!pythonValue->IsString() && !pythonValue->IsBool())) {
     error() << "Failed retrieving python value (int)" << endl;
     return;
   }
-  outputValue = PyLong_AsLong(pythonValue);
+  outputValue = pythonValue->AsLong();
 }
 
 template <>
 void ConfigManager::GetValue<float>(std::string name, float& outputValue) {
-  PyObject* pythonValue = GetPythonValue(name);
-  if (!pythonValue || !PyFloat_Check(pythonValue)) {
+  const ConfigValue* pythonValue = GetConfigValue(name);
+  if (!pythonValue || !pythonValue->IsFloat()) {
     error() << "Failed retrieving python value (float)" << endl;
     return;
   }
-  outputValue = PyFloat_AsDouble(pythonValue);
+  outputValue = pythonValue->AsDouble();
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -186,32 +393,32 @@ void ConfigManager::GetValue<float>(std::string name, float& outputValue) {
 
 template <>
 void ConfigManager::GetVector<std::string>(std::string name, std::vector<std::string>& outputVector) {
-  PyObject* pythonList = GetPythonList(name);
+  const ConfigValue* pythonList = GetConfigList(name);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* item = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* item = GetItem(pythonList, i);
 
-    if (!item || !PyUnicode_Check(item)) {
+    if (!item || !item->IsString()) {
       error() << "Failed retrieving python vector<string>" << endl;
       continue;
     }
-    std::string value = PyUnicode_AsUTF8(item);
+    std::string value = item->AsString();
     outputVector.push_back(value);
   }
 }
 
 template <>
 void ConfigManager::GetVector<int>(std::string name, std::vector<int>& outputVector) {
-  PyObject* pythonList = GetPythonList(name);
+  const ConfigValue* pythonList = GetConfigList(name);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* item = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* item = GetItem(pythonList, i);
 
-    if (!item || !PyLong_Check(item)) {
+    if (!item || !item->IsInt()) {
       error() << "Failed retrieving python vector<int>" << endl;
       continue;
     }
-    int value = PyLong_AsLong(item);
+    int value = item->AsLong();
     outputVector.push_back(value);
   }
 }
@@ -222,205 +429,183 @@ void ConfigManager::GetVector<int>(std::string name, std::vector<int>& outputVec
 
 template <>
 void ConfigManager::GetMap<std::string, std::string>(std::string name, std::map<std::string, std::string>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || !PyUnicode_Check(pValue)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || !pValue->IsString()) {
       error() << "Failed retrieving python key-value pair (string-string)" << endl;
       continue;
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = PyUnicode_AsUTF8(pValue);
+    outputMap[pKey->AsString()] = pValue->AsString();
   }
 }
 
 template <>
 void ConfigManager::GetMap<std::string, int>(std::string name, std::map<std::string, int>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || !PyLong_Check(pValue)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || !pValue->IsInt()) {
       error() << "Failed retrieving python key-value pair (string-int)" << endl;
       continue;
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = PyLong_AsLong(pValue);
+    outputMap[pKey->AsString()] = pValue->AsLong();
   }
 }
 
 template <>
 void ConfigManager::GetMap<std::string, float>(std::string name, std::map<std::string, float>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
-
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || (!PyFloat_Check(pValue) && !PyLong_Check(pValue))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pValue->IsFloat() && !pValue->IsInt())) {
       error() << "Failed retrieving python key-value pair (string-float)" << endl;
       continue;
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = PyFloat_AsDouble(pValue);
+    outputMap[pKey->AsString()] = pValue->AsDouble();
   }
 }
 
 template <>
 void ConfigManager::GetMap<std::string, bool>(std::string name, std::map<std::string, bool>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || !PyLong_Check(pValue)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || !pValue->IsInt()) {
       error() << "Failed retrieving python key-value pair (string-bool)" << endl;
       continue;
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = PyLong_AsLong(pValue);
+    outputMap[pKey->AsString()] = pValue->AsLong();
   }
 }
 
 template <>
 void ConfigManager::GetMap<string, vector<string>>(string name, map<string, vector<string>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
-
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || (!PyList_Check(pValue) && !PyTuple_Check(pValue))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pValue->IsList() && !pValue->IsTuple())) {
       error() << "Failed retrieving python key-value pair (string-vector<string>)" << endl;
       continue;
     }
     vector<string> outputVector;
-    for (Py_ssize_t i = 0; i < GetCollectionSize(pValue); ++i) {
-      PyObject* item = GetItem(pValue, i);
-      outputVector.push_back(PyUnicode_AsUTF8(item));
+    for (int i = 0; i < GetCollectionSize(pValue); ++i) {
+      const ConfigValue* item = GetItem(pValue, i);
+      outputVector.push_back(item->AsString());
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = outputVector;
+    outputMap[pKey->AsString()] = outputVector;
   }
 }
 
 template <>
 void ConfigManager::GetMap<string, vector<int>>(string name, map<string, vector<int>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || (!PyList_Check(pValue) && !PyTuple_Check(pValue))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pValue->IsList() && !pValue->IsTuple())) {
       error() << "Failed retrieving python key-value pair (string-vector<string>)" << endl;
       continue;
     }
     vector<int> outputVector;
-    for (Py_ssize_t i = 0; i < GetCollectionSize(pValue); ++i) {
-      PyObject* item = GetItem(pValue, i);
-      outputVector.push_back(PyLong_AsLong(item));
+    for (int i = 0; i < GetCollectionSize(pValue); ++i) {
+      const ConfigValue* item = GetItem(pValue, i);
+      outputVector.push_back(item->AsLong());
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = outputVector;
+    outputMap[pKey->AsString()] = outputVector;
   }
 }
 
 template <>
 void ConfigManager::GetMap<string, vector<float>>(string name, map<string, vector<float>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
-
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || (!PyList_Check(pValue) && !PyTuple_Check(pValue))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pValue->IsList() && !pValue->IsTuple())) {
       error() << "Failed retrieving python key-value pair (string-vector<float>)" << endl;
       continue;
     }
     vector<float> outputVector;
-    for (Py_ssize_t i = 0; i < GetCollectionSize(pValue); ++i) {
-      PyObject* item = GetItem(pValue, i);
-      outputVector.push_back(PyFloat_AsDouble(item));
+    for (int i = 0; i < GetCollectionSize(pValue); ++i) {
+      const ConfigValue* item = GetItem(pValue, i);
+      outputVector.push_back(item->AsDouble());
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = outputVector;
+    outputMap[pKey->AsString()] = outputVector;
   }
 }
 
 template <>
 void ConfigManager::GetMap<string, vector<bool>>(string name, map<string, vector<bool>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
-
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || (!PyList_Check(pValue) && !PyTuple_Check(pValue))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pValue->IsList() && !pValue->IsTuple())) {
       error() << "Failed retrieving python key-value pair (string-vector<bool>)" << endl;
       continue;
     }
     vector<bool> outputVector;
-    for (Py_ssize_t i = 0; i < GetCollectionSize(pValue); ++i) {
-      PyObject* item = GetItem(pValue, i);
-      outputVector.push_back(PyLong_AsLong(item));
+    for (int i = 0; i < GetCollectionSize(pValue); ++i) {
+      const ConfigValue* item = GetItem(pValue, i);
+      outputVector.push_back(item->AsLong());
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = outputVector;
+    outputMap[pKey->AsString()] = outputVector;
   }
 }
 
 template <>
 void ConfigManager::GetMap<string, map<string, string>>(string name, map<string, map<string, string>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pValue;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pValue)) {
-    if (!PyUnicode_Check(pKey) || !PyDict_Check(pValue)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pValue = &pythonDict->items[pos];
+    if (!pKey->IsString() || !pValue->IsDict()) {
       error() << "Failed retrieving python key-value pair (string-map<string, string>)" << endl;
       continue;
     }
     map<string, string> tmpMap;
-    PyObject *pKeyInner, *pValueInner;
-    Py_ssize_t posInner = 0;
-
-    while (PyDict_Next(pValue, &posInner, &pKeyInner, &pValueInner)) {
-      if (PyUnicode_Check(pValueInner)) {
-        tmpMap[PyUnicode_AsUTF8(pKeyInner)] = PyUnicode_AsUTF8(pValueInner);
+    for (size_t posInner = 0; posInner < pValue->keys.size(); posInner++) {
+      const ConfigValue *pKeyInner = &pValue->keys[posInner], *pValueInner = &pValue->items[posInner];
+      if (pValueInner->IsString()) {
+        tmpMap[pKeyInner->AsString()] = pValueInner->AsString();
       }
     }
-    outputMap[PyUnicode_AsUTF8(pKey)] = tmpMap;
+    outputMap[pKey->AsString()] = tmpMap;
   }
 }
 
 template <>
 void ConfigManager::GetMap<int, vector<vector<int>>>(string name, map<int, vector<vector<int>>>& outputMap) {
-  PyObject* pythonDict = GetPythonDict(name);
+  const ConfigValue* pythonDict = GetConfigDict(name);
 
-  PyObject *pKey, *pOuterList;
-  Py_ssize_t pos = 0;
-
-  while (PyDict_Next(pythonDict, &pos, &pKey, &pOuterList)) {
-    if (!PyUnicode_Check(pKey) || (!PyList_Check(pOuterList) && !PyTuple_Check(pOuterList))) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *pKey = &pythonDict->keys[pos], *pOuterList = &pythonDict->items[pos];
+    if (!pKey->IsString() || (!pOuterList->IsList() && !pOuterList->IsTuple())) {
       error() << "Failed retrieving python key-value pair (int-vector<vector<int>>)" << endl;
       continue;
     }
 
     vector<vector<int>> outerVector;
 
-    for (Py_ssize_t i = 0; i < GetCollectionSize(pOuterList); ++i) {
-      PyObject* pInnerList = GetItem(pOuterList, i);
+    for (int i = 0; i < GetCollectionSize(pOuterList); ++i) {
+      const ConfigValue* pInnerList = GetItem(pOuterList, i);
 
       vector<int> innerVector;
 
-      for (Py_ssize_t j = 0; j < GetCollectionSize(pInnerList); ++j) {
-        PyObject* pValue = GetItem(pInnerList, j);
-        innerVector.push_back(PyLong_AsLong(pValue));
+      for (int j = 0; j < GetCollectionSize(pInnerList); ++j) {
+        const ConfigValue* pValue = GetItem(pInnerList, j);
+        innerVector.push_back(pValue->AsLong());
       }
 
       outerVector.push_back(innerVector);
     }
-    outputMap[stoi(PyUnicode_AsUTF8(pKey))] = outerVector;
+    outputMap[stoi(pKey->AsString())] = outerVector;
   }
 }
 
@@ -430,21 +615,21 @@ void ConfigManager::GetMap<int, vector<vector<int>>>(string name, map<int, vecto
 
 template <>
 void ConfigManager::GetPair<string, vector<string>>(string name, pair<string, vector<string>>& outputPair) {
-  PyObject* pythonTuple = GetPythonList(name);
+  const ConfigValue* pythonTuple = GetConfigList(name);
 
-  PyObject* first = GetItem(pythonTuple, 0);
-  PyObject* second = GetItem(pythonTuple, 1);
-  if (!first || !PyUnicode_Check(first) || !second || !PyList_Check(second)) {
+  const ConfigValue* first = GetItem(pythonTuple, 0);
+  const ConfigValue* second = GetItem(pythonTuple, 1);
+  if (!first || !first->IsString() || !second || !second->IsList()) {
     error() << "Failed retrieving python pair (string, vector<string>)" << endl;
     return;
   }
-  std::string value_first = PyUnicode_AsUTF8(first);
+  std::string value_first = first->AsString();
   vector<string> outputVector;
-  for (Py_ssize_t i = 0; i < GetCollectionSize(second); ++i) {
-    PyObject* item = GetItem(second, i);
-    outputVector.push_back(PyUnicode_AsUTF8(item));
+  for (int i = 0; i < GetCollectionSize(second); ++i) {
+    const ConfigValue* item = GetItem(second, i);
+    outputVector.push_back(item->AsString());
   }
-  outputPair = {PyUnicode_AsUTF8(first), outputVector};
+  outputPair = {first->AsString(), outputVector};
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -452,78 +637,65 @@ void ConfigManager::GetPair<string, vector<string>>(string name, pair<string, ve
 //-------------------------------------------------------------------------------------------------
 
 void ConfigManager::GetExtraEventCollections(insertion_ordered_map<string, ExtraCollection> &extraEventCollections, string extraEventCollectionsName) {
-  PyObject *pythonDict = GetPythonDict(extraEventCollectionsName);
-
-  PyObject *collectionName, *collectionSettings;
-  Py_ssize_t pos = 0;
+  const ConfigValue *pythonDict = GetConfigDict(extraEventCollectionsName);
 
-  while (PyDict_Next(pythonDict, &pos, &collectionName, &collectionSettings)) {
-    if (!PyUnicode_Check(collectionName)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *collectionName = &pythonDict->keys[pos], *collectionSettings = &pythonDict->items[pos];
+    if (!collectionName->IsString()) {
       error() << "Failed retrieving python collection name (string)" << endl;
       continue;
     }
-    PyObject* pyKey = nullptr;
-    PyObject* pyValue = nullptr;
-    Py_ssize_t pos2 = 0;
     ExtraCollection extraCollection;
 
-    while (PyDict_Next(collectionSettings, &pos2, &pyKey, &pyValue)) {
-      string keyStr = PyUnicode_AsUTF8(pyKey);
+    for (size_t pos2 = 0; pos2 < collectionSettings->keys.size(); pos2++) {
+      const ConfigValue *pyKey = &collectionSettings->keys[pos2], *pyValue = &collectionSettings->items[pos2];
+      string keyStr = pyKey->AsString();
       if (keyStr == "inputCollections") {
-        for (Py_ssize_t i = 0; i < GetCollectionSize(pyValue); ++i) {
-          PyObject* item = GetItem(pyValue, i);
-          extraCollection.inputCollections.push_back(PyUnicode_AsUTF8(item));
+        for (int i = 0; i < GetCollectionSize(pyValue); ++i) {
+          const ConfigValue* item = GetItem(pyValue, i);
+          extraCollection.inputCollections.push_back(item->AsString());
         }
-      } else if (PyTuple_Check(pyValue)) {
-        PyObject* min = GetItem(pyValue, 0);
-        PyObject* max = GetItem(pyValue, 1);
-        extraCollection.allCuts[keyStr] = {PyFloat_AsDouble(min), PyFloat_AsDouble(max)};
+      } else if (pyValue->IsTuple()) {
+        const ConfigValue* min = GetItem(pyValue, 0);
+        const ConfigValue* max = GetItem(pyValue, 1);
+        extraCollection.allCuts[keyStr] = {min->AsDouble(), max->AsDouble()};
       } else {
-        extraCollection.flags[keyStr] = PyLong_AsLong(pyValue);
+        extraCollection.flags[keyStr] = pyValue->AsLong();
       }
     }
 
-    extraEventCollections[PyUnicode_AsUTF8(collectionName)] = extraCollection;
+    extraEventCollections[collectionName->AsString()] = extraCollection;
   }
 }
 
 void ConfigManager::GetScaleFactors(string name, map<string, ScaleFactorsMap>& scaleFactors) {
-  PyObject* pythonDict = GetPythonDict(name.c_str());
-
-  PyObject *SFname, *SFvalues;
-  Py_ssize_t pos0 = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name.c_str());
 
-  while (PyDict_Next(pythonDict, &pos0, &SFname, &SFvalues)) {
-    if (!PyUnicode_Check(SFname)) {
+  for (size_t pos0 = 0; pos0 < pythonDict->keys.size(); pos0++) {
+    const ConfigValue *SFname = &pythonDict->keys[pos0], *SFvalues = &pythonDict->items[pos0];
+    if (!SFname->IsString()) {
       error() << "Failed retrieving python scale factor name (string)" << endl;
       continue;
     }
-    string SFnameStr = PyUnicode_AsUTF8(SFname);
+    string SFnameStr = SFname->AsString();
     scaleFactors[SFnameStr] = ScaleFactorsMap();
 
-    PyObject *etaBin, *valuesForEta;
-    Py_ssize_t pos = 0;
-
-    while (PyDict_Next(SFvalues, &pos, &etaBin, &valuesForEta)) {
-      if (!PyTuple_Check(etaBin)) {
+    for (size_t pos = 0; pos < SFvalues->keys.size(); pos++) {
+      const ConfigValue *etaBin = &SFvalues->keys[pos], *valuesForEta = &SFvalues->items[pos];
+      if (!etaBin->IsTuple()) {
         error() << "Failed retrieving python eta bin" << endl;
         continue;
       }
-      PyObject* ptBin = nullptr;
-      PyObject* values = nullptr;
-      Py_ssize_t pos2 = 0;
-
-      tuple<float, float> etaBinValues = {PyFloat_AsDouble(GetItem(etaBin, 0)), PyFloat_AsDouble(GetItem(etaBin, 1))};
 
-      while (PyDict_Next(valuesForEta, &pos2, &ptBin, &values)) {
-        tuple<float, float> ptBinValues = {PyFloat_AsDouble(GetItem(ptBin, 0)), PyFloat_AsDouble(GetItem(ptBin, 1))};
+      tuple<float, float> etaBinValues = {(GetItem(etaBin, 0))->AsDouble(), (GetItem(etaBin, 1))->AsDouble()};
 
-        PyObject* fieldName = nullptr;
-        PyObject* fieldValue = nullptr;
-        Py_ssize_t pos3 = 0;
+      for (size_t pos2 = 0; pos2 < valuesForEta->keys.size(); pos2++) {
+        const ConfigValue *ptBin = &valuesForEta->keys[pos2], *values = &valuesForEta->items[pos2];
+        tuple<float, float> ptBinValues = {(GetItem(ptBin, 0))->AsDouble(), (GetItem(ptBin, 1))->AsDouble()};
 
-        while (PyDict_Next(values, &pos3, &fieldName, &fieldValue)) {
-          scaleFactors[SFnameStr][etaBinValues][ptBinValues][PyUnicode_AsUTF8(fieldName)] = PyFloat_AsDouble(fieldValue);
+        for (size_t pos3 = 0; pos3 < values->keys.size(); pos3++) {
+          const ConfigValue *fieldName = &values->keys[pos3], *fieldValue = &values->items[pos3];
+          scaleFactors[SFnameStr][etaBinValues][ptBinValues][fieldName->AsString()] = fieldValue->AsDouble();
         }
       }
     }
@@ -531,38 +703,36 @@ void ConfigManager::GetScaleFactors(string name, map<string, ScaleFactorsMap>& s
 }
 
 void ConfigManager::GetScaleFactors(string name, map<string, ScaleFactorsTuple>& scaleFactors) {
-  PyObject* pythonDict = GetPythonDict(name.c_str());
-
-  PyObject *SFname, *SFvalues;
-  Py_ssize_t pos0 = 0;
+  const ConfigValue* pythonDict = GetConfigDict(name.c_str());
 
-  while (PyDict_Next(pythonDict, &pos0, &SFname, &SFvalues)) {
-    if (!PyUnicode_Check(SFname)) {
+  for (size_t pos0 = 0; pos0 < pythonDict->keys.size(); pos0++) {
+    const ConfigValue *SFname = &pythonDict->keys[pos0], *SFvalues = &pythonDict->items[pos0];
+    if (!SFname->IsString()) {
       error() << "Failed retrieving python scale factor name (string)" << endl;
       continue;
     }
-    string SFnameStr = PyUnicode_AsUTF8(SFname);
+    string SFnameStr = SFname->AsString();
     scaleFactors[SFnameStr] = ScaleFactorsTuple();
 
-    PyObject* tupleFormula = GetItem(SFvalues, 0);
-    string formulaString = PyUnicode_AsUTF8(tupleFormula);
+    const ConfigValue* tupleFormula = GetItem(SFvalues, 0);
+    string formulaString = tupleFormula->AsString();
 
-    PyObject* tupleParams = GetItem(SFvalues, 1);
+    const ConfigValue* tupleParams = GetItem(SFvalues, 1);
 
     vector<float> params;
-    for (Py_ssize_t i = 0; i < GetCollectionSize(tupleParams); ++i) {
-      PyObject* item = GetItem(tupleParams, i);
-      params.push_back(PyFloat_AsDouble(item));
+    for (int i = 0; i < GetCollectionSize(tupleParams); ++i) {
+      const ConfigValue* item = GetItem(tupleParams, i);
+      params.push_back(item->AsDouble());
     }
     scaleFactors[SFnameStr] = {formulaString, params};
   }
 }
 
 void ConfigManager::GetAddedBranchesParams(vector<AddedBranchParams>& addedBranchesParams) {
-  PyObject* pythonList = GetPythonList("branchesToAdd");
+  const ConfigValue* pythonList = GetConfigList("branchesToAdd");
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* entry = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* entry = GetItem(pythonList, i);
     auto nParams = GetCollectionSize(entry);
 
     // Skipping a malformed entry would silently drop the branch from the output tree, so rather stop here
@@ -571,27 +741,27 @@ void ConfigManager::GetAddedBranchesParams(vector<AddedBranchParams>& addedBranc
               << " - expected (collection, name, type, varexp)" << endl;
       exit(1);
     }
-    if (!PyUnicode_Check(GetItem(entry, 0)) || !PyUnicode_Check(GetItem(entry, 1)) || !PyUnicode_Check(GetItem(entry, 2)) ||
-        !PyUnicode_Check(GetItem(entry, 3))) {
+    if (!(GetItem(entry, 0))->IsString() || !(GetItem(entry, 1))->IsString() || !(GetItem(entry, 2))->IsString() ||
+        !(GetItem(entry, 3))->IsString()) {
       fatal() << "Invalid types in branchesToAdd definition at index " << i
               << " (expected four strings: collection, name, type, varexp)" << endl;
       exit(1);
     }
 
     AddedBranchParams addedBranch;
-    addedBranch.collection = PyUnicode_AsUTF8(GetItem(entry, 0));
-    addedBranch.name = PyUnicode_AsUTF8(GetItem(entry, 1));
-    addedBranch.type = PyUnicode_AsUTF8(GetItem(entry, 2));
-    addedBranch.varexp = PyUnicode_AsUTF8(GetItem(entry, 3));
+    addedBranch.collection = (GetItem(entry, 0))->AsString();
+    addedBranch.name = (GetItem(entry, 1))->AsString();
+    addedBranch.type = (GetItem(entry, 2))->AsString();
+    addedBranch.varexp = (GetItem(entry, 3))->AsString();
     addedBranchesParams.push_back(addedBranch);
   }
 }
 
 void ConfigManager::GetHistogramsParams(map<string, HistogramParams>& histogramsParams, string collectionName) {
-  PyObject* pythonList = GetPythonList(collectionName);
+  const ConfigValue* pythonList = GetConfigList(collectionName);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* params = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* params = GetItem(pythonList, i);
 
     HistogramParams histParams;
     string title;
@@ -606,25 +776,25 @@ void ConfigManager::GetHistogramsParams(map<string, HistogramParams>& histograms
     // functions below.  In particular, an older one-name definition has the
     // same number of arguments as a valid definition, but its second item is
     // the number of bins rather than a variable name.
-    if (!PyUnicode_Check(GetItem(params, 0)) || !PyUnicode_Check(GetItem(params, 1)) || !PyLong_Check(GetItem(params, 2)) ||
-        !(PyFloat_Check(GetItem(params, 3)) || PyLong_Check(GetItem(params, 3))) ||
-        !(PyFloat_Check(GetItem(params, 4)) || PyLong_Check(GetItem(params, 4))) ||
-        (nParams == 6 && !PyUnicode_Check(GetItem(params, 5)))) {
+    if (!(GetItem(params, 0))->IsString() || !(GetItem(params, 1))->IsString() || !(GetItem(params, 2))->IsInt() ||
+        !((GetItem(params, 3))->IsFloat() || (GetItem(params, 3))->IsInt()) ||
+        !((GetItem(params, 4))->IsFloat() || (GetItem(params, 4))->IsInt()) ||
+        (nParams == 6 && !(GetItem(params, 5))->IsString())) {
       error() << "Invalid types in 1D histogram definition at index " << i << " in '" << collectionName
               << "' (expected collection, variable, integer bins, numeric min/max"
               << " and optional string directory)" << endl;
       continue;
     }
 
-    histParams.collection = PyUnicode_AsUTF8(GetItem(params, 0));
-    histParams.variable = PyUnicode_AsUTF8(GetItem(params, 1));
-    histParams.nBins = PyLong_AsLong(GetItem(params, 2));
-    histParams.min = PyFloat_AsDouble(GetItem(params, 3));
-    histParams.max = PyFloat_AsDouble(GetItem(params, 4));
+    histParams.collection = (GetItem(params, 0))->AsString();
+    histParams.variable = (GetItem(params, 1))->AsString();
+    histParams.nBins = (GetItem(params, 2))->AsLong();
+    histParams.min = (GetItem(params, 3))->AsDouble();
+    histParams.max = (GetItem(params, 4))->AsDouble();
     histParams.directory = "";
     // we treat the directory as optional.
     if (nParams == 6) {
-      histParams.directory = PyUnicode_AsUTF8(GetItem(params, 5));
+      histParams.directory = (GetItem(params, 5))->AsString();
     }
     title = histParams.collection + "_" + histParams.variable;
     histogramsParams[title] = histParams;
@@ -632,10 +802,10 @@ void ConfigManager::GetHistogramsParams(map<string, HistogramParams>& histograms
 }
 
 void ConfigManager::GetHistogramsParams(map<string, IrregularHistogramParams>& histogramsParams, string collectionName) {
-  PyObject* pythonList = GetPythonList(collectionName);
+  const ConfigValue* pythonList = GetConfigList(collectionName);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* params = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* params = GetItem(pythonList, i);
     auto nParams = GetCollectionSize(params);
 
     IrregularHistogramParams histParams;
@@ -644,23 +814,23 @@ void ConfigManager::GetHistogramsParams(map<string, IrregularHistogramParams>& h
       error() << "Invalid number of arguments in 1D variable bin histogram definition - expect either 3 or 4 " << std::endl;
       continue;
     }
-    if (!PyUnicode_Check(GetItem(params, 0)) || !PyUnicode_Check(GetItem(params, 1)) ||
-        (!PyList_Check(GetItem(params, 2)) && !PyTuple_Check(GetItem(params, 2))) ||
-        (nParams == 4 && !PyUnicode_Check(GetItem(params, 3)))) {
+    if (!(GetItem(params, 0))->IsString() || !(GetItem(params, 1))->IsString() ||
+        (!(GetItem(params, 2))->IsList() && !(GetItem(params, 2))->IsTuple()) ||
+        (nParams == 4 && !(GetItem(params, 3))->IsString())) {
       error() << "Invalid types in 1D variable bin histogram definition at index " << i << " in '" << collectionName << "'" << endl;
       continue;
     }
-    histParams.collection = PyUnicode_AsUTF8(GetItem(params, 0));
-    histParams.variable = PyUnicode_AsUTF8(GetItem(params, 1));
+    histParams.collection = (GetItem(params, 0))->AsString();
+    histParams.variable = (GetItem(params, 1))->AsString();
 
-    PyObject* binEdges = GetItem(params, 2);
-    for (Py_ssize_t i = 0; i < GetCollectionSize(binEdges); ++i) {
-      PyObject* item = GetItem(binEdges, i);
-      histParams.binEdges.push_back(PyFloat_AsDouble(item));
+    const ConfigValue* binEdges = GetItem(params, 2);
+    for (int i = 0; i < GetCollectionSize(binEdges); ++i) {
+      const ConfigValue* item = GetItem(binEdges, i);
+      histParams.binEdges.push_back(item->AsDouble());
     }
     histParams.directory = "";
     if (nParams > 3) {
-      histParams.directory = PyUnicode_AsUTF8(GetItem(params, 3));
+      histParams.directory = (GetItem(params, 3))->AsString();
     }
     title = histParams.collection + "_" + histParams.variable;
 
@@ -669,10 +839,10 @@ void ConfigManager::GetHistogramsParams(map<string, IrregularHistogramParams>& h
 }
 
 void ConfigManager::GetHistogramsParams(map<string, HistogramParams2D>& histogramsParams, string collectionName) {
-  PyObject* pythonList = GetPythonList(collectionName);
+  const ConfigValue* pythonList = GetConfigList(collectionName);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* params = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* params = GetItem(pythonList, i);
     auto nParams = GetCollectionSize(params);
     if (nParams < 7 || nParams > 8) {
       error() << "Invalid number of arguments in 2D histogram definition - expect either 7 or 8 " << std::endl;
@@ -681,16 +851,16 @@ void ConfigManager::GetHistogramsParams(map<string, HistogramParams2D>& histogra
 
     HistogramParams2D histParams;
 
-    histParams.variable = PyUnicode_AsUTF8(GetItem(params, 0));
-    histParams.nBinsX = PyLong_AsLong(GetItem(params, 1));
-    histParams.minX = PyFloat_AsDouble(GetItem(params, 2));
-    histParams.maxX = PyFloat_AsDouble(GetItem(params, 3));
-    histParams.nBinsY = PyLong_AsLong(GetItem(params, 4));
-    histParams.minY = PyFloat_AsDouble(GetItem(params, 5));
-    histParams.maxY = PyFloat_AsDouble(GetItem(params, 6));
+    histParams.variable = (GetItem(params, 0))->AsString();
+    histParams.nBinsX = (GetItem(params, 1))->AsLong();
+    histParams.minX = (GetItem(params, 2))->AsDouble();
+    histParams.maxX = (GetItem(params, 3))->AsDouble();
+    histParams.nBinsY = (GetItem(params, 4))->AsLong();
+    histParams.minY = (GetItem(params, 5))->AsDouble();
+    histParams.maxY = (GetItem(params, 6))->AsDouble();
     histParams.directory = "";
     if (nParams == 8) {
-      histParams.directory = PyUnicode_AsUTF8(GetItem(params, 7));
+      histParams.directory = (GetItem(params, 7))->AsString();
     }
 
     histogramsParams[histParams.variable] = histParams;
@@ -698,48 +868,107 @@ void ConfigManager::GetHistogramsParams(map<string, HistogramParams2D>& histogra
 }
 
 void ConfigManager::GetHistogramsParams(map<string, IrregularHistogramParams2D>& histogramsParams, string collectionName) {
-  PyObject* pythonList = GetPythonList(collectionName);
+  const ConfigValue* pythonList = GetConfigList(collectionName);
 
-  for (Py_ssize_t i = 0; i < GetCollectionSize(pythonList); ++i) {
-    PyObject* params = GetItem(pythonList, i);
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* params = GetItem(pythonList, i);
 
     IrregularHistogramParams2D histParams;
     string title;
 
-    histParams.variable = PyUnicode_AsUTF8(GetItem(params, 0));
+    histParams.variable = (GetItem(params, 0))->AsString();
 
-    PyObject* binEdgesX = GetItem(params, 1);
-    PyObject* binEdgesY = GetItem(params, 2);
+    const ConfigValue* binEdgesX = GetItem(params, 1);
+    const ConfigValue* binEdgesY = GetItem(params, 2);
 
-    for (Py_ssize_t i = 0; i < GetCollectionSize(binEdgesX); ++i) {
-      PyObject* item = GetItem(binEdgesX, i);
-      histParams.binEdgesX.push_back(PyFloat_AsDouble(item));
+    for (int i = 0; i < GetCollectionSize(binEdgesX); ++i) {
+      const ConfigValue* item = GetItem(binEdgesX, i);
+      histParams.binEdgesX.push_back(item->AsDouble());
     }
-    for (Py_ssize_t i = 0; i < GetCollectionSize(binEdgesY); ++i) {
-      PyObject* item = GetItem(binEdgesY, i);
-      histParams.binEdgesY.push_back(PyFloat_AsDouble(item));
+    for (int i = 0; i < GetCollectionSize(binEdgesY); ++i) {
+      const ConfigValue* item = GetItem(binEdgesY, i);
+      histParams.binEdgesY.push_back(item->AsDouble());
     }
 
-    histParams.directory = PyUnicode_AsUTF8(GetItem(params, 3));
+    histParams.directory = (GetItem(params, 3))->AsString();
 
     histogramsParams[histParams.variable] = histParams;
   }
 }
 
-void ConfigManager::GetCuts(vector<pair<string, pair<float, float>>>& cuts) {
-  PyObject* pythonDict = GetPythonDict("eventCuts");
+void ConfigManager::GetHistogramsParams(map<string, SparseHistogramParams>& histogramsParams, string collectionName) {
+  const ConfigValue* pythonList = GetConfigList(collectionName);
 
-  PyObject *cutName, *cutValues;
-  Py_ssize_t pos = 0;
+  for (int i = 0; i < GetCollectionSize(pythonList); ++i) {
+    const ConfigValue* params = GetItem(pythonList, i);
+    auto nParams = GetCollectionSize(params);
+    if (nParams < 3 || nParams > 4) {
+      error() << "Invalid number of arguments in sparse histogram definition - expect either 3 or 4 " << std::endl;
+      continue;
+    }
+    if (!(GetItem(params, 0))->IsString() || (!(GetItem(params, 1))->IsList() && !(GetItem(params, 1))->IsTuple()) ||
+        !(GetItem(params, 2))->IsString() || (nParams == 4 && !(GetItem(params, 3))->IsString())) {
+      error() << "Invalid types in sparse histogram definition at index " << i << " in '" << collectionName
+              << "' (expected name, list of axes, output type and optional string directory)" << endl;
+      continue;
+    }
+
+    SparseHistogramParams histParams;
+    histParams.name = (GetItem(params, 0))->AsString();
+
+    const ConfigValue* axes = GetItem(params, 1);
+    bool validAxes = GetCollectionSize(axes) > 0;
+    for (int iAxis = 0; iAxis < GetCollectionSize(axes); ++iAxis) {
+      const ConfigValue* axis = GetItem(axes, iAxis);
+      if ((!axis->IsList() && !axis->IsTuple()) || GetCollectionSize(axis) != 4 ||
+          !(GetItem(axis, 0))->IsString() || !(GetItem(axis, 1))->IsInt() ||
+          !((GetItem(axis, 2))->IsFloat() || (GetItem(axis, 2))->IsInt()) ||
+          !((GetItem(axis, 3))->IsFloat() || (GetItem(axis, 3))->IsInt())) {
+        validAxes = false;
+        break;
+      }
+      histParams.variables.push_back((GetItem(axis, 0))->AsString());
+      histParams.nBins.push_back((GetItem(axis, 1))->AsLong());
+      histParams.min.push_back((GetItem(axis, 2))->AsDouble());
+      histParams.max.push_back((GetItem(axis, 3))->AsDouble());
+    }
+    if (!validAxes) {
+      error() << "Invalid axes of sparse histogram " << histParams.name
+              << " (expected a list of (variable, integer bins, numeric min, numeric max))" << endl;
+      continue;
+    }
+
+    string output = (GetItem(params, 2))->AsString();
+    if (output != "THnSparse" && output != "TH2D") {
+      error() << "Invalid output type of sparse histogram " << histParams.name << ": " << output
+              << " (expected THnSparse or TH2D)" << endl;
+      continue;
+    }
+    if (output == "TH2D" && histParams.variables.size() != 2) {
+      error() << "Sparse histogram " << histParams.name << " can only be saved as TH2D if it has 2 axes" << endl;
+      continue;
+    }
+    histParams.projectTo2D = output == "TH2D";
+
+    histParams.directory = "";
+    if (nParams == 4) histParams.directory = (GetItem(params, 3))->AsString();
+
+    histogramsParams[histParams.name] = histParams;
+  }
+}
+
+void ConfigManager::GetCuts(vector<pair<string, pair<float, float>>>& cuts) {
+  const ConfigValue* pythonDict = GetConfigDict("eventCuts");
 
-  while (PyDict_Next(pythonDict, &pos, &cutName, &cutValues)) {
-    if (!PyUnicode_Check(cutName)) {
+  for (size_t pos = 0; pos < pythonDict->keys.size(); pos++) {
+    const ConfigValue *cutName = &pythonDict->keys[pos], *cutValues = &pythonDict->items[pos];
+    if (!cutName->IsString()) {
       error() << "Failed retrieving python cut name (string)" << endl;
       continue;
     }
-    PyObject* min = GetItem(cutValues, 0);
-    PyObject* max = GetItem(cutValues, 1);
-    cuts.push_back({PyUnicode_AsUTF8(cutName), {PyFloat_AsDouble(min), PyFloat_AsDouble(max)}});
+    const ConfigValue* min = GetItem(cutValues, 0);
+    const ConfigValue* max = GetItem(cutValues, 1);
+    cuts.push_back({cutName->AsString(), {min->AsDouble(), max->AsDouble()}});
   }
 }
 
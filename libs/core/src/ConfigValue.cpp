@@ -0,0 +1,49 @@
+//  ConfigValue.cpp
+
+#include "ConfigValue.hpp"
+
+#include "Helpers.hpp"
+
+using namespace std;
+
+const ConfigValue *ConfigValue::Item(int index) const {
+  static const ConfigValue none;
+  if (index < 0 || index >= Size()) return &none;
+  return &items[index];
+}
+
+void ConfigValue::Write(ostream &out) const {
+  WriteBinary(out, type);
+  if (IsInt()) WriteBinary(out, intValue);
+  if (IsFloat()) WriteBinary(out, floatValue);
+  if (IsString()) WriteBinary(out, stringValue);
+  if (!IsList() && !IsTuple() && !IsDict()) return;
+
+  WriteBinary(out, (uint64_t)items.size());
+  if (IsDict()) {
+    for (auto &key : keys) key.Write(out);
+  }
+  for (auto &item : items) item.Write(out);
+}
+
+bool ConfigValue::Read(istream &in) {
+  if (!ReadBinary(in, type) || type > Type::kDict) return false;
+  if (IsInt()) return ReadBinary(in, intValue);
+  if (IsFloat()) return ReadBinary(in, floatValue);
+  if (IsString()) return ReadBinary(in, stringValue);
+  if (!IsList() && !IsTuple() && !IsDict()) return true;
+
+  uint64_t size;
+  if (!ReadBinary(in, size)) return false;
+  if (IsDict()) {
+    keys.resize(size);
+    for (auto &key : keys) {
+      if (!key.Read(in)) return false;
+    }
+  }
+  items.resize(size);
+  for (auto &item : items) {
+    if (!item.Read(in)) return false;
+  }
+  return true;
+}
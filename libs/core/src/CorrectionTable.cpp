@@ -0,0 +1,207 @@
+//  CorrectionTable.cpp
+
+#include "CorrectionTable.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace {
+double ParseTableEdge(const json& edge) {
+  if (edge.is_number()) return edge.get<double>();
+  if (edge.is_string()) {
+    string s = edge.get<string>();
+    if (s == "Infinity" || s == "inf") return numeric_limits<double>::infinity();
+    if (s == "-Infinity" || s == "-inf") return -numeric_limits<double>::infinity();
+  }
+  throw std::runtime_error("Unsupported edge in correction JSON: " + edge.dump());
+}
+}  // namespace
+
+CorrectionTable::CorrectionTable(const json& correction) {
+  const auto& inputs = correction["inputs"];
+  for (size_t i = 0; i < inputs.size(); i++) inputIndices[inputs[i]["name"]] = i;
+  root = Compile(correction["data"]);
+}
+
+void CorrectionTable::AddAxis(const string& input, const json& axisEdges) {
+  Axis axis;
+  axis.input = inputIndices.at(input);
+
+  if (axisEdges.is_object()) {
+    axis.uniform = true;
+    axis.nBins = axisEdges["n"];
+    axis.low = ParseTableEdge(axisEdges["low"]);
+    axis.high = ParseTableEdge(axisEdges["high"]);
+  } else {
+    axis.nBins = axisEdges.size() - 1;
+    axis.firstEdge = edges.size();
+    for (const auto& edge : axisEdges) edges.push_back(ParseTableEdge(edge));
+  }
+  axes.push_back(axis);
+}
+
+void CorrectionTable::Write(ostream& out) const {
+  WriteBinary(out, nodes);
+  WriteBinary(out, axes);
+  WriteBinary(out, edges);
+  WriteBinary(out, children);
+  WriteBinary(out, intKeys);
+  WriteBinary(out, stringKeys);
+  WriteBinary(out, isStringKey);
+
+  vector<string> inputNames;
+  vector<int> indices;
+  for (auto& [name, index] : inputIndices) {
+    inputNames.push_back(name);
+    indices.push_back(index);
+  }
+  WriteBinary(out, inputNames);
+  WriteBinary(out, indices);
+  WriteBinary(out, root);
+  WriteBinary(out, complete);
+}
+
+bool CorrectionTable::Read(istream& in) {
+  vector<string> inputNames;
+  vector<int> indices;
+  bool success = ReadBinary(in, nodes) && ReadBinary(in, axes) && ReadBinary(in, edges) && ReadBinary(in, children) &&
+                 ReadBinary(in, intKeys) && ReadBinary(in, stringKeys) && ReadBinary(in, isStringKey) &&
+                 ReadBinary(in, inputNames) && ReadBinary(in, indices) && ReadBinary(in, root) &&
+                 ReadBinary(in, complete);
+  if (!success || inputNames.size() != indices.size() || isStringKey.size() != children.size()) return false;
+
+  inputIndices.clear();
+  for (size_t i = 0; i < inputNames.size(); i++) inputIndices[inputNames[i]] = indices[i];
+  return true;
+}
+
+int CorrectionTable::Compile(const json& jsonNode) {
+  int index = nodes.size();
+  nodes.emplace_back();
+
+  if (jsonNode.is_number()) {
+    nodes[index].type = NodeType::kValue;
+    nodes[index].value = jsonNode.get<double>();
+    return index;
+  }
+
+  string type = jsonNode.is_object() && jsonNode.contains("nodetype") ? jsonNode["nodetype"].get<string>() : "";
+  Node node;
+
+  if (type == "binning" || type == "multibinning") {
+    node.type = NodeType::kBinning;
+    node.firstAxis = axes.size();
+    if (type == "binning") {
+      AddAxis(jsonNode["input"], jsonNode["edges"]);
+    } else {
+      for (size_t i = 0; i < jsonNode["inputs"].size(); i++) AddAxis(jsonNode["inputs"][i], jsonNode["edges"][i]);
+    }
+    node.nAxes = axes.size() - node.firstAxis;
+
+    const auto& flow = jsonNode["flow"];
+    if (flow.is_string()) {
+      node.flow = flow == "clamp" ? Flow::kClamp : Flow::kError;
+    } else {
+      node.flow = Flow::kNode;
+      node.flowNode = Compile(flow);
+    }
+  } else if (type == "category") {
+    node.type = NodeType::kCategory;
+    node.input = inputIndices.at(jsonNode["input"]);
+    if (jsonNode.contains("default") && !jsonNode["default"].is_null()) node.defaultNode = Compile(jsonNode["default"]);
+  } else {
+    complete = false;
+    nodes[index] = node;
+    return index;
+  }
+
+  // children are compiled after reserving their slots, so that they stay contiguous
+  const auto& content = jsonNode["content"];
+  node.firstChild = children.size();
+  node.nChildren = content.size();
+  children.resize(children.size() + node.nChildren);
+  intKeys.resize(children.size());
+  stringKeys.resize(children.size());
+  isStringKey.resize(children.size());
+
+  for (int i = 0; i < node.nChildren; i++) {
+    int iChild = node.firstChild + i;
+    if (node.type == NodeType::kCategory) {
+      const auto& key = content[i]["key"];
+      isStringKey[iChild] = key.is_string();
+      if (key.is_string())
+        stringKeys[iChild] = key.get<string>();
+      else
+        intKeys[iChild] = key.get<long>();
+      children[iChild] = Compile(content[i]["value"]);
+    } else {
+      children[iChild] = Compile(content[i]);
+    }
+  }
+  nodes[index] = node;
+  return index;
+}
+
+bool CorrectionTable::Evaluate(const vector<CorrectionArgType>& args, double& result) const {
+  auto getNumber = [&](int input, double& value) {
+    bool isNumber = false;
+    std::visit(
+        [&](const auto& arg) {
+          if constexpr (std::is_arithmetic_v<std::decay_t<decltype(arg)>>) {
+            value = arg;
+            isNumber = true;
+          }
+        },
+        args[input]);
+    return isNumber && !std::isnan(value);
+  };
+
+  int iNode = root;
+  while (true) {
+    const Node& node = nodes[iNode];
+
+    if (node.type == NodeType::kValue) {
+      result = node.value;
+      return true;
+    }
+    if (node.type == NodeType::kUnsupported) return false;
+
+    if (node.type == NodeType::kCategory) {
+      const auto& arg = args[node.input];
+      const string* stringArg = std::get_if<string>(&arg);
+      double numberArg = 0;
+      if (!stringArg && !getNumber(node.input, numberArg)) return false;
+
+      // string arguments are only compared with string keys, and numbers with int keys
+      int next = node.defaultNode;
+      for (int i = node.firstChild; i < node.firstChild + node.nChildren; i++) {
+        if (bool(isStringKey[i]) != bool(stringArg)) continue;
+        if (stringArg ? stringKeys[i] == *stringArg : intKeys[i] == numberArg) {
+          next = children[i];
+          break;
+        }
+      }
+      if (next < 0) return false;
+      iNode = next;
+      continue;
+    }
+
+    // for binnings, row-major index of the bin across all axes
+    int bin = 0;
+    bool outOfRange = false;
+    for (int iAxis = node.firstAxis; iAxis < node.firstAxis + node.nAxes; iAxis++) {
+      const Axis& axis = axes[iAxis];
+      double value;
+      if (!getNumber(axis.input, value)) return false;
+
+      int axisBin = FindBin(axis, value);
+      if (axisBin < 0 || axisBin >= axis.nBins) {
+        outOfRange = true;
+        // values out of range are clamped to the edge bin, like ScaleFactorsManager does for correctionlib's errors
+        axisBin = axisBin < 0 ? 0 : axis.nBins - 1;
+      }
+      bin = bin * axis.nBins + axisBin;
+    }
+    iNode = outOfRange && node.flow == Flow::kNode ? node.flowNode : children[node.firstChild + bin];
+  }
+}
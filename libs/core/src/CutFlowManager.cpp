@@ -18,7 +18,16 @@ CutFlowManager::CutFlowManager(shared_ptr<EventReader> eventReader_, shared_ptr<
   } catch (const Exception &e) {
   }
 
+  // If the weights branch is missing or has a different type, GetCurrentEventWeight() falls back to Event::Get()
+  if (weightsBranchName != "") {
+    try {
+      weightsHandle = eventReader->currentEvent->Handle<Float_t>(weightsBranchName);
+    } catch (const exception &e) {
+    }
+  }
+
   RegisterPreExistingCutFlows();
+  RegisterPreExistingCutIds();
 
   if (!eventWriter_) warn() << "No eventWriter given for CutFlowManager" << endl;
 }
@@ -26,8 +35,26 @@ CutFlowManager::CutFlowManager(shared_ptr<EventReader> eventReader_, shared_ptr<
 CutFlowManager::~CutFlowManager() {}
 
 void CutFlowManager::RegisterPreExistingCutFlows() {
+  // Cut flows stored in all input files are summed, as all of them are read as one stream of events
+  for (size_t iFile = 0; iFile < eventReader->inputFilePaths.size(); iFile++) {
+    const string &inputFilePath = eventReader->inputFilePaths[iFile];
+    bool isFirstFile = iFile == 0;
+    TFile *inputFile = isFirstFile ? eventReader->inputFile : TFile::Open(inputFilePath.c_str());
+    if (!inputFile || inputFile->IsZombie()) {
+      error() << "Couldn't open input file " << inputFilePath << " to read its cut flows" << endl;
+      continue;
+    }
+    RegisterPreExistingCutFlows(inputFile);
+    if (!isFirstFile) {
+      inputFile->Close();
+      delete inputFile;
+    }
+  }
+}
+
+void CutFlowManager::RegisterPreExistingCutFlows(TFile *inputFile) {
   vector<string> existingCutFlows;
-  TList *keys = eventReader->inputFile->GetListOfKeys();
+  TList *keys = inputFile->GetListOfKeys();
   for (int i = 0; i < keys->GetSize(); i++) {
     TKey *key = (TKey *)keys->At(i);
     TString keyName = key->GetName();
@@ -35,7 +62,20 @@ void CutFlowManager::RegisterPreExistingCutFlows() {
   }
 
   for (auto cutFlowName : existingCutFlows) {
-    if (!eventReader->inputFile->Get(cutFlowName.c_str())) continue;
+    if (!inputFile->Get(cutFlowName.c_str())) continue;
+
+    // cut flows of weight variations are kept aside, only to be saved again
+    if (cutFlowName.find("CutFlow_") == 0) {
+      auto &variationCutFlow = inputVariationWeightsAfterCuts[cutFlowName.substr(8)];
+      TIter nextKey(((TDirectory *)inputFile->Get(cutFlowName.c_str()))->GetListOfKeys());
+      TKey *key;
+      while ((key = dynamic_cast<TKey *>(nextKey()))) {
+        TObject *obj = key->ReadObj();
+        variationCutFlow[key->GetName()] += ((TH1D *)obj)->GetBinContent(1);
+        delete obj;
+      }
+      continue;
+    }
 
     bool rawEvents = cutFlowName.find("RawEvents") != string::npos;
     string collectionName = "";
@@ -50,8 +90,10 @@ void CutFlowManager::RegisterPreExistingCutFlows() {
       collectionName = cutFlowName;
     }
 
-    if (!rawEvents && collectionName != "") RegisterCollection(collectionName);
-    auto sourceDir = (TDirectory *)eventReader->inputFile->Get(cutFlowName.c_str());
+    if (!rawEvents && collectionName != "" && !weightsAfterCollectionCuts.count(collectionName)) {
+      RegisterCollection(collectionName);
+    }
+    auto sourceDir = (TDirectory *)inputFile->Get(cutFlowName.c_str());
 
     TIter nextKey(sourceDir->GetListOfKeys());
     TKey *key;
@@ -65,20 +107,28 @@ void CutFlowManager::RegisterPreExistingCutFlows() {
       delete obj;
 
       if (rawEvents) {
-        if (collectionName == "")
-          rawEventsAfterCuts[cutName] = sumOfWeights;
-        else
-          rawEventsAfterCollectionCuts[collectionName][cutName] = sumOfWeights;
+        if (collectionName == "") {
+          rawEventsAfterCuts[cutName] += sumOfWeights;
+          inputRawEventsAfterCuts[cutName] += sumOfWeights;
+        } else {
+          rawEventsAfterCollectionCuts[collectionName][cutName] += sumOfWeights;
+          inputRawEventsAfterCollectionCuts[collectionName][cutName] += sumOfWeights;
+        }
       } else {
         if (collectionName == "") {
-          weightsAfterCuts[cutName] = sumOfWeights;
+          weightsAfterCuts[cutName] += sumOfWeights;
+          inputWeightsAfterCuts[cutName] += sumOfWeights;
           if (containsInitial) inputContainsInitial = true;
+          if (find(existingCuts.begin(), existingCuts.end(), cutName) != existingCuts.end()) continue;
           existingCuts.push_back(cutName);
           currentIndex++;
         } else {
-          weightsAfterCollectionCuts[collectionName][cutName] = sumOfWeights;
+          weightsAfterCollectionCuts[collectionName][cutName] += sumOfWeights;
+          inputWeightsAfterCollectionCuts[collectionName][cutName] += sumOfWeights;
           if (containsInitial) inputCollectionContainsInitial[collectionName] = true;
-          existingCollectionCuts[collectionName].push_back(cutName);
+          auto &collectionCuts = existingCollectionCuts[collectionName];
+          if (find(collectionCuts.begin(), collectionCuts.end(), cutName) != collectionCuts.end()) continue;
+          collectionCuts.push_back(cutName);
           currentCollectionIndex[collectionName]++;
         }
       }
@@ -86,7 +136,60 @@ void CutFlowManager::RegisterPreExistingCutFlows() {
   }
 }
 
+void CutFlowManager::RegisterPreExistingCutIds() {
+  // Cuts from the input can still be updated by name, unless a cut with the same name is registered later
+  auto registerCuts = [&](const vector<string> &fullCutNames, const string &collectionName) {
+    map<int, string> sortedCutNames;
+    for (auto &fullCutName : fullCutNames) {
+      size_t underscorePos = fullCutName.find("_");
+      if (underscorePos == string::npos) continue;
+      try {
+        sortedCutNames[stoi(fullCutName.substr(0, underscorePos))] = fullCutName;
+      } catch (const exception &e) {
+      }
+    }
+    for (auto &[index, fullCutName] : sortedCutNames) {
+      AddCut(fullCutName, fullCutName.substr(fullCutName.find("_") + 1), collectionName, true, false);
+    }
+  };
+  registerCuts(existingCuts, "");
+  for (auto &[collectionName, collectionCuts] : existingCollectionCuts) registerCuts(collectionCuts, collectionName);
+}
+
+int CutFlowManager::AddCut(string fullCutName, string cutName, string collectionName, bool fromInput, bool inMasks) {
+  CutInfo cut;
+  cut.name = fullCutName;
+  cut.collectionName = collectionName;
+  cut.fromInput = fromInput;
+  if (collectionName == "") {
+    cut.weights = &weightsAfterCuts[fullCutName];
+    cut.rawEvents = &rawEventsAfterCuts[fullCutName];
+  } else {
+    cut.weights = &weightsAfterCollectionCuts[collectionName][fullCutName];
+    cut.rawEvents = &rawEventsAfterCollectionCuts[collectionName][fullCutName];
+  }
+
+  cut.maskBit = -1;
+  if (inMasks && collectionName == "") {
+    if (maskCutNames.size() < maxMaskBits) {
+      cut.maskBit = maskCutNames.size();
+      maskCutNames.push_back(fullCutName);
+    } else {
+      warn() << "More than " << maxMaskBits << " cuts registered for event masks - cut " << fullCutName;
+      warn() << " won't be included in N-1 tables and cut correlations" << endl;
+    }
+  }
+
+  cuts.push_back(cut);
+  variationWeightsAfterCuts.resize(cuts.size() * variationNames.size(), 0);
+  int cutId = cuts.size() - 1;
+  cutIds[make_pair(cutName, collectionName)] = cutId;
+  return cutId;
+}
+
 void CutFlowManager::RegisterCollection(string collectionName) {
+  // cuts of the collection point to its cut flow maps, so they can't be reset
+  if (weightsAfterCollectionCuts.count(collectionName)) return;
   currentCollectionIndex[collectionName] = 0;
   weightsAfterCollectionCuts[collectionName] = {};
   rawEventsAfterCollectionCuts[collectionName] = {};
@@ -94,54 +197,26 @@ void CutFlowManager::RegisterCollection(string collectionName) {
   inputCollectionContainsInitial[collectionName] = false;
 }
 
-void CutFlowManager::RegisterCut(string cutName, string collectionName) {
-  if (cutName == "initial" && HasCut("initial", collectionName)) return;
+int CutFlowManager::RegisterCut(string cutName, string collectionName, bool inMasks) {
+  if (cutName == "initial" && HasCut("initial", collectionName)) {
+    auto cutIdIt = cutIds.find(make_pair(cutName, collectionName));
+    return cutIdIt == cutIds.end() ? -1 : cutIdIt->second;
+  }
   bool containsInitial = collectionName == "" ? inputContainsInitial : inputCollectionContainsInitial[collectionName];
-  if (cutName == "initial" && containsInitial) return;
+  if (cutName == "initial" && containsInitial) return -1;
+  if (collectionName != "") RegisterCollection(collectionName);
+
   int index = collectionName == "" ? currentIndex : currentCollectionIndex[collectionName];
   string fullCutName = (cutName == "initial") ? "0_initial" : (to_string(index) + "_" + cutName);
   if (collectionName == "") {
     currentIndex++;
-    weightsAfterCuts[fullCutName] = 0;
-    rawEventsAfterCuts[fullCutName] = 0;
   } else {
     currentCollectionIndex[collectionName]++;
-    weightsAfterCollectionCuts[collectionName][fullCutName] = 0;
-    rawEventsAfterCollectionCuts[collectionName][fullCutName] = 0;
-  }
-}
-
-string CutFlowManager::GetFullCutName(string cutName, string collectionName) {
-  // Find full names in the cut flow matching the given cut name
-  vector<string> matchingFullCutNames;
-  map<string, float> weights = collectionName == "" ? weightsAfterCuts : weightsAfterCollectionCuts[collectionName];
-  for (auto &[existingCutName, sumOfWeights] : weights) {
-    size_t underscorePos = existingCutName.find("_");
-    if (underscorePos != string::npos) {
-      string nameAfterUnderscore = existingCutName.substr(underscorePos + 1);
-      if (nameAfterUnderscore == cutName) {
-        matchingFullCutNames.push_back(existingCutName);
-      }
-    }
-  }
-
-  // Find the full name with the highest index
-  int maxIndex = -1;
-  string maxCutName = "";
-  for (auto fullCutName : matchingFullCutNames) {
-    string number = fullCutName.substr(0, fullCutName.find("_"));
-    int index = stoi(number);
-    if (index > maxIndex) {
-      maxIndex = index;
-      maxCutName = fullCutName;
-    }
   }
-  if (maxCutName != "") return maxCutName;
-
-  // If no matching full name was found, we cannot continue
-  fatal() << "CutFlowManager does not contain cut " << cutName << endl;
-  fatal() << "Did you forget to register it?" << endl;
-  exit(1);
+  int cutId = AddCut(fullCutName, cutName, collectionName, false, inMasks);
+  *cuts[cutId].weights = 0;
+  *cuts[cutId].rawEvents = 0;
+  return cutId;
 }
 
 float CutFlowManager::GetCurrentEventWeight() {
@@ -150,6 +225,7 @@ float CutFlowManager::GetCurrentEventWeight() {
   float weight = 1.0;
 
   if (weightsBranchName == "") return weight;
+  if (weightsHandle.IsValid()) return weightsHandle.Get();
 
   try {
     weight = eventReader->currentEvent->Get(weightsBranchName);
@@ -159,17 +235,153 @@ float CutFlowManager::GetCurrentEventWeight() {
   return weight;
 }
 
-void CutFlowManager::UpdateCutFlow(string cutName, string collectionName) {
+void CutFlowManager::UpdateCutFlow(string cutName, string collectionName, const vector<float> &variationWeights) {
   bool containsInitial = collectionName == "" ? inputContainsInitial : inputCollectionContainsInitial[collectionName];
   if (cutName == "initial" && containsInitial) return;
-  string fullCutName = GetFullCutName(cutName, collectionName);
-  if (collectionName == "") {
-    weightsAfterCuts[fullCutName] += GetCurrentEventWeight();
-    rawEventsAfterCuts[fullCutName] += 1;
-  } else {
-    weightsAfterCollectionCuts[collectionName][fullCutName] += GetCurrentEventWeight();
-    rawEventsAfterCollectionCuts[collectionName][fullCutName] += 1;
+
+  auto cutIdIt = cutIds.find(make_pair(cutName, collectionName));
+  if (cutIdIt == cutIds.end()) {
+    fatal() << "CutFlowManager does not contain cut " << cutName << endl;
+    fatal() << "Did you forget to register it?" << endl;
+    exit(1);
+  }
+  UpdateCutFlow(cutIdIt->second, variationWeights);
+}
+
+void CutFlowManager::SetWeightVariations(const vector<string> &names) {
+  if (names == variationNames) return;
+  if (!variationNames.empty()) {
+    fatal() << "Weight variations of the cut flow can only be set once" << endl;
+    exit(1);
+  }
+  variationNames = names;
+  variationWeightsAfterCuts.assign(cuts.size() * variationNames.size(), 0);
+}
+
+void CutFlowManager::ThrowWrongNumberOfVariations(size_t nWeights) const {
+  fatal() << "Updating cut flow with " << nWeights << " weights, but " << variationNames.size();
+  fatal() << " weight variations were set in CutFlowManager" << endl;
+  exit(1);
+}
+
+int CutFlowManager::GetCutId(string cutName, string collectionName) const {
+  auto cutIdIt = cutIds.find(make_pair(cutName, collectionName));
+  return cutIdIt == cutIds.end() ? -1 : cutIdIt->second;
+}
+
+set<string> CutFlowManager::GetWeightVariations() const {
+  set<string> names(variationNames.begin(), variationNames.end());
+  for (auto &[variationName, cutFlow] : inputVariationWeightsAfterCuts) names.insert(variationName);
+  return names;
+}
+
+map<string, float> CutFlowManager::GetVariationCutFlow(const string &variationName) {
+  map<string, float> inputCutFlow;
+  auto inputCutFlowIt = inputVariationWeightsAfterCuts.find(variationName);
+  if (inputCutFlowIt != inputVariationWeightsAfterCuts.end()) inputCutFlow = inputCutFlowIt->second;
+  map<string, float> cutFlow = inputCutFlow;
+
+  auto variationIt = find(variationNames.begin(), variationNames.end(), variationName);
+  size_t iVariation = variationIt - variationNames.begin();
+
+  for (size_t cutId = 0; cutId < cuts.size(); cutId++) {
+    const CutInfo &cut = cuts[cutId];
+    if (cut.collectionName != "") continue;
+
+    // counts from the input and from this job, each with nominal weights if there are none for this variation
+    auto nominalInputIt = inputWeightsAfterCuts.find(cut.name);
+    float nominalInput = nominalInputIt == inputWeightsAfterCuts.end() ? 0 : nominalInputIt->second;
+    auto inputIt = inputCutFlow.find(cut.name);
+    float weight = inputIt == inputCutFlow.end() ? nominalInput : inputIt->second;
+    if (variationIt != variationNames.end()) {
+      weight += variationWeightsAfterCuts[cutId * variationNames.size() + iVariation];
+    } else {
+      weight += *cut.weights - nominalInput;
+    }
+    cutFlow[cut.name] = weight;
   }
+  return cutFlow;
+}
+
+void CutFlowManager::BeginEventMask() {
+  if (maskCutNames.empty() || eventReader->currentEntry == eventMaskEntry) return;
+  FlushEventMask();
+  eventMaskEntry = eventReader->currentEntry;
+  eventMaskWeight = GetCurrentEventWeight();
+}
+
+void CutFlowManager::FlushEventMask() {
+  if (eventMaskEntry >= 0) {
+    auto &counts = maskCounts[eventMask];
+    counts.first += eventMaskWeight;
+    counts.second += 1;
+  }
+  eventMask = 0;
+  eventMaskEntry = -1;
+}
+
+vector<tuple<string, float, float>> CutFlowManager::GetCutFlow(const vector<string> &cutsOrder) {
+  FlushEventMask();
+
+  vector<tuple<string, float, float>> cutFlow;
+  uint64_t requiredMask = 0;
+  for (auto &cutName : cutsOrder) {
+    auto cutIdIt = cutIds.find(make_pair(cutName, ""));
+    if (cutIdIt == cutIds.end() || cuts[cutIdIt->second].maskBit < 0) {
+      error() << "Cut " << cutName << " is not recorded in event masks (only eventCuts from the config are) - skipping it" << endl;
+      continue;
+    }
+    requiredMask |= uint64_t(1) << cuts[cutIdIt->second].maskBit;
+
+    double sumOfWeights = 0, nEvents = 0;
+    for (auto &[mask, counts] : maskCounts) {
+      if ((mask & requiredMask) != requiredMask) continue;
+      sumOfWeights += counts.first;
+      nEvents += counts.second;
+    }
+    cutFlow.push_back({cutName, sumOfWeights, nEvents});
+  }
+  return cutFlow;
+}
+
+vector<tuple<string, float, float>> CutFlowManager::GetNminusOneCutFlow() {
+  FlushEventMask();
+
+  uint64_t allCutsMask = 0;
+  for (size_t bit = 0; bit < maskCutNames.size(); bit++) allCutsMask |= uint64_t(1) << bit;
+
+  vector<tuple<string, float, float>> cutFlow;
+  for (size_t bit = 0; bit < maskCutNames.size(); bit++) {
+    double sumOfWeights = 0, nEvents = 0;
+    for (auto &[mask, counts] : maskCounts) {
+      if ((mask | (uint64_t(1) << bit)) != allCutsMask) continue;
+      sumOfWeights += counts.first;
+      nEvents += counts.second;
+    }
+    cutFlow.push_back({maskCutNames[bit], sumOfWeights, nEvents});
+  }
+  return cutFlow;
+}
+
+vector<vector<float>> CutFlowManager::GetCutCorrelations() {
+  FlushEventMask();
+
+  size_t nCuts = maskCutNames.size();
+  vector<vector<double>> sums(nCuts, vector<double>(nCuts, 0));
+  for (auto &[mask, counts] : maskCounts) {
+    for (size_t i = 0; i < nCuts; i++) {
+      if (!(mask & (uint64_t(1) << i))) continue;
+      for (size_t j = 0; j < nCuts; j++) {
+        if (mask & (uint64_t(1) << j)) sums[i][j] += counts.first;
+      }
+    }
+  }
+
+  vector<vector<float>> correlations(nCuts, vector<float>(nCuts, 0));
+  for (size_t i = 0; i < nCuts; i++) {
+    for (size_t j = 0; j < nCuts; j++) correlations[i][j] = sums[i][j];
+  }
+  return correlations;
 }
 
 void CutFlowManager::SaveSingleCutFlow(string collectionName) {
@@ -193,6 +405,64 @@ void CutFlowManager::SaveCutFlow() {
   for (auto &[collectionName, vertexCuts] : weightsAfterCollectionCuts) {
     SaveSingleCutFlow(collectionName);
   }
+  if (eventWriter && !maskCutNames.empty()) WriteCutMasks();
+
+  for (auto &variationName : GetWeightVariations()) {
+    if (eventWriter) WriteCutFlow(GetVariationCutFlow(variationName), "CutFlow_" + variationName);
+  }
+}
+
+void CutFlowManager::Merge(const CutFlowManager &other) {
+  FlushEventMask();
+  for (auto &[mask, counts] : other.maskCounts) {
+    maskCounts[mask].first += counts.first;
+    maskCounts[mask].second += counts.second;
+  }
+  if (other.eventMaskEntry >= 0) {
+    maskCounts[other.eventMask].first += other.eventMaskWeight;
+    maskCounts[other.eventMask].second += 1;
+  }
+
+  if (other.variationNames != variationNames || other.variationWeightsAfterCuts.size() != variationWeightsAfterCuts.size()) {
+    fatal() << "Trying to merge cut flows with different cuts or weight variations" << endl;
+    exit(1);
+  }
+  for (size_t i = 0; i < variationWeightsAfterCuts.size(); i++) {
+    variationWeightsAfterCuts[i] += other.variationWeightsAfterCuts[i];
+  }
+
+  // Both managers start from the same counts read from the input, so only what the other one added on top of them is
+  // merged (cuts from the input can also be updated in the event loop)
+  auto mergeCutFlow = [](map<string, float> &cutFlow, const map<string, float> &otherCutFlow,
+                         const map<string, float> *otherInputCutFlow) {
+    for (auto &[cutName, sumOfWeights] : otherCutFlow) {
+      float inputSumOfWeights = 0;
+      if (otherInputCutFlow) {
+        auto inputIt = otherInputCutFlow->find(cutName);
+        if (inputIt != otherInputCutFlow->end()) inputSumOfWeights = inputIt->second;
+      }
+      cutFlow[cutName] += sumOfWeights - inputSumOfWeights;
+    }
+  };
+  auto findInputCutFlow = [](const map<string, map<string, float>> &inputCutFlows,
+                             const string &collectionName) -> const map<string, float> * {
+    auto inputIt = inputCutFlows.find(collectionName);
+    return inputIt == inputCutFlows.end() ? nullptr : &inputIt->second;
+  };
+
+  mergeCutFlow(weightsAfterCuts, other.weightsAfterCuts, &other.inputWeightsAfterCuts);
+  mergeCutFlow(rawEventsAfterCuts, other.rawEventsAfterCuts, &other.inputRawEventsAfterCuts);
+
+  for (auto &[collectionName, otherWeights] : other.weightsAfterCollectionCuts) {
+    if (!weightsAfterCollectionCuts.count(collectionName)) RegisterCollection(collectionName);
+    mergeCutFlow(weightsAfterCollectionCuts[collectionName], otherWeights,
+                 findInputCutFlow(other.inputWeightsAfterCollectionCuts, collectionName));
+    auto rawEventsIt = other.rawEventsAfterCollectionCuts.find(collectionName);
+    if (rawEventsIt != other.rawEventsAfterCollectionCuts.end()) {
+      mergeCutFlow(rawEventsAfterCollectionCuts[collectionName], rawEventsIt->second,
+                   findInputCutFlow(other.inputRawEventsAfterCollectionCuts, collectionName));
+    }
+  }
 }
 
 bool CutFlowManager::HasCut(string cutName, string collectionName) {
@@ -243,6 +513,25 @@ void CutFlowManager::Print(string collectionName) {
   cout << "╚═════════════════════════════╧═══════════════════════╧═══════════════════╝\033[0m\n\n";
 }
 
+void CutFlowManager::PrintNminusOne() {
+  cout << "\n\033[1;36m"  // Bright cyan
+       << "╔═════════════════════════════════════════════════════════════════════════╗\n"
+       << "║                               N-1 Cut Table                             ║\n"
+       << "╠═════════════════════════════╤═══════════════════════╤═══════════════════╣\n"
+       << "║ " << setw(27) << left << "Cut removed"
+       << " │ " << setw(21) << right << "Gen-weights sum"
+       << " │ " << setw(17) << right << "Raw events" << " ║\n";
+  cout << "╠═════════════════════════════╪═══════════════════════╪═══════════════════╣\n";
+
+  for (auto &[cutName, genWeight, rawEvents] : GetNminusOneCutFlow()) {
+    cout << "║ " << setw(27) << left << cutName
+         << " │ " << setw(21) << right << genWeight
+         << " │ " << setw(17) << right << rawEvents << " ║\n";
+  }
+
+  cout << "╚═════════════════════════════╧═══════════════════════╧═══════════════════╝\033[0m\n\n";
+}
+
 bool CutFlowManager::isEmpty(string collectionName) {
   if (collectionName != "") return weightsAfterCollectionCuts[collectionName].empty();
   return weightsAfterCuts.empty();
@@ -264,3 +553,47 @@ void CutFlowManager::WriteCutFlow(map<string, float> weights, string cutFlowName
   }
   eventWriter->outFile->cd();
 }
+
+void CutFlowManager::WriteCutMasks() {
+  FlushEventMask();
+
+  // Sums of weights for each combination of passed cuts, from which cut flows for any order of cuts can be computed.
+  // The directory name can't contain "CutFlow", as it would be read as a cut flow from the input.
+  eventWriter->outFile->mkdir("CutMasks");
+  eventWriter->outFile->cd("CutMasks");
+
+  int nCuts = maskCutNames.size();
+  auto cutNames = new TH1D("cuts", "cuts", nCuts, 0, nCuts);
+  for (int bit = 0; bit < nCuts; bit++) cutNames->GetXaxis()->SetBinLabel(bit + 1, maskCutNames[bit].c_str());
+  cutNames->Write();
+
+  auto masksTree = new TTree("masks", "masks");
+  ULong64_t mask;
+  Double_t sumOfWeights, rawEvents;
+  masksTree->Branch("mask", &mask, "mask/l");
+  masksTree->Branch("sumOfWeights", &sumOfWeights, "sumOfWeights/D");
+  masksTree->Branch("rawEvents", &rawEvents, "rawEvents/D");
+  for (auto &[eventMask, counts] : maskCounts) {
+    mask = eventMask;
+    sumOfWeights = counts.first;
+    rawEvents = counts.second;
+    masksTree->Fill();
+  }
+  masksTree->Write();
+
+  auto nMinusOne = new TH1D("nMinusOne", "nMinusOne", nCuts, 0, nCuts);
+  auto correlations = new TH2D("correlations", "correlations", nCuts, 0, nCuts, nCuts, 0, nCuts);
+  auto nMinusOneCutFlow = GetNminusOneCutFlow();
+  auto cutCorrelations = GetCutCorrelations();
+  for (int i = 0; i < nCuts; i++) {
+    nMinusOne->SetBinContent(i + 1, get<1>(nMinusOneCutFlow[i]));
+    nMinusOne->GetXaxis()->SetBinLabel(i + 1, maskCutNames[i].c_str());
+    correlations->GetXaxis()->SetBinLabel(i + 1, maskCutNames[i].c_str());
+    correlations->GetYaxis()->SetBinLabel(i + 1, maskCutNames[i].c_str());
+    for (int j = 0; j < nCuts; j++) correlations->SetBinContent(i + 1, j + 1, cutCorrelations[i][j]);
+  }
+  nMinusOne->Write();
+  correlations->Write();
+
+  eventWriter->outFile->cd();
+}
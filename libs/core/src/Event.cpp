@@ -31,6 +31,8 @@ Event::~Event() {}
 
 void Event::Reset() {
   extraCollections.clear();
+  // in case building a collection was interrupted by an exception
+  selectionPlansInProgress.assign(selectionPlans.size(), false);
   // Clearing just the type marker (not the value maps) is enough to hide a stale
   // Set()/SetVector() from a previous event, since HasCustomValue() checks this map.
   customValuesTypes.clear();
@@ -57,6 +59,7 @@ float Event::GetMetPt() {
   if (!metUpdatedBranchName.empty()) {
     return GetFloat(metUpdatedBranchName + "_pt");
   }
+  LoadBranch(metBranchName + "_pt");
   return GetFloat(metBranchName + "_pt"); 
 }
 
@@ -64,69 +67,64 @@ float Event::GetMetPhi() {
   if (!metUpdatedBranchName.empty()) {
     return GetFloat(metUpdatedBranchName + "_phi");
   }
+  LoadBranch(metBranchName + "_phi");
   return GetFloat(metBranchName + "_phi"); 
 }
 
-template <typename First, typename... Rest>
-bool Event::tryGet(shared_ptr<PhysicsObject> physicsObject, string branchName, pair<float, float> cuts) {
-  try {
-    First value = physicsObject->Get(branchName);
-    return value >= cuts.first && value <= cuts.second;
-  } catch (BadTypeException& e) {
-    if constexpr (sizeof...(Rest) > 0) {
-      return tryGet<Rest...>(physicsObject, branchName, cuts);
-    } else {
-      fatal() << e.what() << endl;
-      gErrorIgnoreLevel = kFatal;
-      exit(1);
-    }
-  }
+void Event::AddExtraCollections() {
+  if (!hasExtraCollections) return;
+  for (auto& [name, extraCollection] : extraCollectionsDescriptions) GetCollection(name);
 }
 
-bool Event::checkCuts(shared_ptr<PhysicsObject> physicsObject, string branchName, pair<float, float> cuts) {
-  // avoiding undefined cuts
-  if (cuts.first == 0.0 && cuts.second == 0.0) {
-    warn() << "Undefined cuts for branch " << branchName << endl;
-    return true;
+SelectionPlan* Event::FindSelectionPlan(const string& name) {
+  if (!hasExtraCollections) return nullptr;
+
+  if (selectionPlans.empty()) {
+    for (auto& [planName, extraCollection] : extraCollectionsDescriptions) {
+      selectionPlanIndices[planName] = selectionPlans.size();
+      selectionPlans.emplace_back(planName, extraCollection);
+    }
+    selectionPlansInProgress.assign(selectionPlans.size(), false);
   }
-  // important: checking float first makes things much faster, since most branches are floats
-  return tryGet<Float_t, Double_t, Bool_t, UChar_t, UInt_t, Int_t, UShort_t, Short_t>(physicsObject, branchName, cuts);
+  auto indexIt = selectionPlanIndices.find(name);
+  return indexIt == selectionPlanIndices.end() ? nullptr : &selectionPlans[indexIt->second];
 }
 
-void Event::AddExtraCollections() {
-  if (!hasExtraCollections) return;
-
-  for (auto& [name, extraCollection] : extraCollectionsDescriptions) {
-    auto newCollection = make_shared<PhysicsObjects>();
+shared_ptr<PhysicsObjects> Event::BuildExtraCollection(const string& name) {
+  SelectionPlan* plan = FindSelectionPlan(name);
+  if (!plan) {
+    string message = "Tried to get a collection that doesn't exist: " + name;
+    throw Exception(message.c_str());
+  }
 
-    for (auto inputCollectionName : extraCollection.inputCollections) {
-      shared_ptr<PhysicsObjects> inputCollection;
+  // input collections are built on demand, too, so the order of extraEventCollections doesn't matter
+  size_t planIndex = selectionPlanIndices.at(name);
+  if (selectionPlansInProgress[planIndex]) {
+    fatal() << "Extra collection " << name << " depends on itself -- check extraEventCollections in your config" << endl;
+    exit(1);
+  }
+  selectionPlansInProgress[planIndex] = true;
 
-      try {
-        inputCollection = GetCollection(inputCollectionName);
-      } catch (const Exception& e) {
-        error() << "Couldn't find collection " << inputCollectionName << " for extra collection " << name << endl;
-        continue;
-      }
+  auto newCollection = plan->NewOutputCollection();
 
-      for (auto physicsObject : *inputCollection) {
-        bool passes = true;
+  for (auto& inputCollectionName : plan->GetInputCollections()) {
+    shared_ptr<PhysicsObjects> inputCollection;
 
-        for (auto& [branchName, flag] : extraCollection.flags) {
-          passes = checkCuts(physicsObject, branchName, {flag, flag});
-          if (!passes) break;
-        }
-        if (!passes) continue;
+    try {
+      inputCollection = GetCollection(inputCollectionName);
+    } catch (const Exception& e) {
+      error() << "Couldn't find collection " << inputCollectionName << " for extra collection " << name << endl;
+      continue;
+    }
 
-        for (auto& [branchName, cuts] : extraCollection.allCuts) {
-          passes = checkCuts(physicsObject, branchName, cuts);
-          if (!passes) break;
-        }
-        if (!passes) continue;
+    // objects of collections read from the tree are the rows of their columns, in order
+    const ColumnarCollection* inputColumns = nullptr;
+    if (collections.count(inputCollectionName)) inputColumns = columnarCollections.at(inputCollectionName).get();
 
-        newCollection->push_back(physicsObject);
-      }
-    }
-    extraCollections.insert({name, newCollection});
+    plan->Select(inputCollection, inputColumns, *newCollection);
   }
+  selectionPlansInProgress[planIndex] = false;
+
+  extraCollections.insert({name, newCollection});
+  return newCollection;
 }
@@ -0,0 +1,44 @@
+//  EventLoop.cpp
+
+#include "EventLoop.hpp"
+
+#include "ConfigManager.hpp"
+#include "ScaleFactorsManager.hpp"
+
+using namespace std;
+
+EventLoop::EventLoop() {
+  auto& config = ConfigManager::GetInstance();
+
+  try {
+    config.GetValue("nThreads", nThreads);
+  } catch (const Exception& e) {
+  }
+
+  if (nThreads <= 0) nThreads = max(1u, thread::hardware_concurrency());
+}
+
+void EventLoop::Setup() {
+  nProcessedEvents = 0;
+  lastPrintedPercentage = -1;
+  if (nThreads == 1) return;
+
+  info() << "Running the event loop on " << nThreads << " threads" << endl;
+  ROOT::EnableThreadSafety();
+
+  // Each worker books histograms with the same names, so they cannot be registered in the current directory
+  TH1::AddDirectory(false);
+}
+
+void EventLoop::UpdateProgress(long long nEvents) {
+  long long iEvent = nProcessedEvents++;
+  int percentage = ((iEvent + 1) * 100) / nEvents;
+  int lastPrinted = lastPrintedPercentage;
+  if (percentage <= lastPrinted) return;
+  if (lastPrintedPercentage.compare_exchange_strong(lastPrinted, percentage)) EventReader::PrintProgress(iEvent, nEvents);
+}
+
+void EventLoop::PrintSummary(const vector<EventReader*>& eventReaders) {
+  EventReader::PrintIOStatistics(eventReaders);
+  ScaleFactorsManager::PrintUnusedCorrections();
+}
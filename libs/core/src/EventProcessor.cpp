@@ -25,33 +25,90 @@ EventProcessor::EventProcessor() {
   } catch (const Exception& e) {
   }
 
+  try {
+    config.GetValue("recordCutMasks", recordCutMasks);
+  } catch (const Exception& e) {
+  }
+
+  ReadGoldenJson();
+}
+
+void EventProcessor::ReadGoldenJson() {
+  auto& config = ConfigManager::GetInstance();
+
+  map<int, vector<vector<int>>> goldenJson;
   try {
     config.GetMap("goldenJson", goldenJson);
     if (goldenJson.empty()) {
       fatal() << "Golden JSON is empty" << endl;
       exit(1);
     }
-
   } catch (const Exception& e) {
   }
+
+  // map keys are already sorted by run
+  for (auto& [run, lumiRanges] : goldenJson) {
+    vector<pair<UInt_t, UInt_t>> ranges;
+    for (auto& lumiRange : lumiRanges) ranges.emplace_back(lumiRange[0], lumiRange[1]);
+    sort(ranges.begin(), ranges.end());
+
+    goldenJsonRuns.push_back(run);
+    goldenJsonRunStarts.push_back(goldenJsonLumiRanges.size());
+    for (auto& range : ranges) {
+      bool overlaps = goldenJsonLumiRanges.size() > goldenJsonRunStarts.back() && range.first <= goldenJsonLumiRanges.back().second;
+      if (overlaps) {
+        goldenJsonLumiRanges.back().second = max(goldenJsonLumiRanges.back().second, range.second);
+      } else {
+        goldenJsonLumiRanges.push_back(range);
+      }
+    }
+  }
+  goldenJsonRunStarts.push_back(goldenJsonLumiRanges.size());
+}
+
+bool EventProcessor::IsInGoldenJson(UInt_t run, UInt_t lumi) const {
+  auto runIt = lower_bound(goldenJsonRuns.begin(), goldenJsonRuns.end(), run);
+  if (runIt == goldenJsonRuns.end() || *runIt != run) return false;
+
+  size_t iRun = runIt - goldenJsonRuns.begin();
+  auto first = goldenJsonLumiRanges.begin() + goldenJsonRunStarts[iRun];
+  auto last = goldenJsonLumiRanges.begin() + goldenJsonRunStarts[iRun + 1];
+
+  // the last range starting at or before this lumi section is the only one that can contain it
+  auto range = upper_bound(first, last, lumi, [](UInt_t value, const pair<UInt_t, UInt_t>& range) { return value < range.first; });
+  return range != first && lumi <= prev(range)->second;
 }
 
 bool EventProcessor::PassesGoldenJson(const shared_ptr<Event> event) {
-  bool passes = true;
+  if (event.get() != goldenJsonHandlesEvent) {
+    goldenJsonHandlesEvent = event.get();
+    try {
+      runHandle = event->Handle<UInt_t>("run");
+      lumiHandle = event->Handle<UInt_t>("luminosityBlock");
+    } catch (const Exception& e) {
+      runHandle = lumiHandle = BranchHandle<UInt_t>();
+    } catch (const BadTypeException& e) {
+      runHandle = lumiHandle = BranchHandle<UInt_t>();
+    }
+  }
 
-  uint run = event->Get("run");
-  uint lumi = event->Get("luminosityBlock");
+  UInt_t run, lumi;
+  if (runHandle.IsValid() && lumiHandle.IsValid()) {
+    run = runHandle.Get();
+    lumi = lumiHandle.Get();
+  } else {
+    run = (uint)event->Get("run");
+    lumi = (uint)event->Get("luminosityBlock");
+  }
 
   if (run == 1) return true;  // MC
 
-  if (goldenJson.find(run) == goldenJson.end()) return false;
-
-  for (auto& lumiRange : goldenJson[run]) {
-    if (lumi >= lumiRange[0] && lumi <= lumiRange[1]) {
-      return true;
-    }
+  if (run != lastRun || lumi != lastLumi) {
+    lastRun = run;
+    lastLumi = lumi;
+    lastPassesGoldenJson = IsInGoldenJson(run, lumi);
   }
-  return false;
+  return lastPassesGoldenJson;
 }
 
 bool EventProcessor::PassesTriggerCuts(const shared_ptr<Event> event) {
@@ -77,27 +134,54 @@ bool EventProcessor::PassesMetFilters(const shared_ptr<Event> event) {
 }
 
 void EventProcessor::RegisterCuts(shared_ptr<CutFlowManager> cutFlowManager) {
+  eventCutIds.clear();
   for (auto& [cutName, cutValues] : eventCuts) {
-    cutFlowManager->RegisterCut(cutName);
+    // nano_ cuts are applied in NanoEventProcessor, which stops at the first failed one
+    bool inMasks = recordCutMasks && cutName.substr(0, 5) != "nano_";
+    eventCutIds.push_back(cutFlowManager->RegisterCut(cutName, "", inMasks));
   }
 }
 
-bool EventProcessor::PassesEventCuts(const shared_ptr<Event> event, shared_ptr<CutFlowManager> cutFlowManager) {
-  for (auto& [cutName, cutValues] : eventCuts) {
+bool EventProcessor::PassesEventCuts(const shared_ptr<Event> event, shared_ptr<CutFlowManager> cutFlowManager,
+                                     const vector<float>& variationWeights) {
+  bool useCutIds = eventCutIds.size() == eventCuts.size();
+  bool passedAll = true;
+  if (cutFlowManager && recordCutMasks) cutFlowManager->BeginEventMask();
+
+  for (size_t iCut = 0; iCut < eventCuts.size(); iCut++) {
+    auto& [cutName, cutValues] = eventCuts[iCut];
     if (cutName.substr(0, 5) == "nano_") continue;
 
+    bool passes;
     try {
       auto collection = event->GetCollection(cutName.substr(1));
-      if (!inRange(collection->size(), cutValues)) return false;
+      passes = inRange(collection->size(), cutValues);
     }
     catch (Exception&) {
       float variable = event->Get(cutName);
-      if (!inRange(variable, cutValues)) return false;
+      passes = inRange(variable, cutValues);
+    }
+
+    // Unless cut masks are recorded, we can stop at the first failed cut. Otherwise, the remaining cuts are still
+    // checked for N-1 tables and cut correlations, but only counted in the sequential cut flow if all cuts before
+    // them passed.
+    if (!passes) {
+      if (!cutFlowManager || !recordCutMasks) return false;
+      passedAll = false;
+      continue;
+    }
+    if (!cutFlowManager) continue;
+
+    if (!useCutIds) {
+      if (passedAll) cutFlowManager->UpdateCutFlow(cutName, "", variationWeights);
+    } else if (passedAll) {
+      cutFlowManager->UpdateCutFlow(eventCutIds[iCut], variationWeights);
+    } else {
+      cutFlowManager->MarkCutPassed(eventCutIds[iCut]);
     }
-    if (cutFlowManager) cutFlowManager->UpdateCutFlow(cutName);
   }
 
-  return true;
+  return passedAll;
 }
 
 float EventProcessor::GetMaxPt(shared_ptr<Event> event, string collectionName) {
@@ -6,6 +6,9 @@
 
 #include "Helpers.hpp"
 #include "Profiler.hpp"
+#include "TChain.h"
+#include "TEnv.h"
+#include "TTreeCache.h"
 
 using namespace std;
 
@@ -25,12 +28,142 @@ EventReader::EventReader() {
 
   config.GetValue("nEvents", maxEvents);
 
-  string inputFilePath;
-  config.GetValue("inputFilePath", inputFilePath);
+  try {
+    config.GetValue("lazyBranchLoading", lazyBranchLoading);
+  } catch (const Exception& e) {
+  }
+  try {
+    config.GetValue("treeCacheSize", treeCacheSize);
+  } catch (const Exception& e) {
+  }
+  try {
+    config.GetValue("treeCacheLearnEntries", treeCacheLearnEntries);
+  } catch (const Exception& e) {
+  }
+  try {
+    config.GetValue("asyncPrefetching", asyncPrefetching);
+  } catch (const Exception& e) {
+  }
+
+  // inputFilePath can be a single path, a glob pattern or a list of those. All files are read as one chain of events.
+  vector<string> inputFilePatterns;
+  try {
+    string inputFilePath;
+    config.GetValue("inputFilePath", inputFilePath);
+    inputFilePatterns.push_back(inputFilePath);
+  } catch (const Exception& e) {
+    config.GetVector("inputFilePath", inputFilePatterns);
+  }
+  for (auto& pattern : inputFilePatterns) {
+    auto paths = ExpandInputFilePattern(pattern);
+    if (paths.empty()) warn() << "No input files matching: " << pattern << endl;
+    inputFilePaths.insert(inputFilePaths.end(), paths.begin(), paths.end());
+  }
+  if (inputFilePaths.empty()) {
+    fatal() << "No input files to process" << endl;
+    exit(1);
+  }
 
   currentEvent = make_shared<Event>();
 
-  info() << "Input file path: " << inputFilePath << endl;
+  if (inputFilePaths.size() == 1) {
+    info() << "Input file path: " << inputFilePaths[0] << endl;
+  } else {
+    info() << "Input files: " << inputFilePaths.size() << " (first: " << inputFilePaths[0] << ")" << endl;
+  }
+
+  OpenFirstInputFile();
+
+  SetupTrees();
+  SetupBranches();
+
+  addedBranches = make_unique<AddedBranches>();
+  if (!addedBranches->Empty()) addedBranches->Setup(eventsTreeNames, inputTrees);
+
+  if (lazyBranchLoading) SetupAlwaysLoadedBranches();
+  if (treeCacheSize > 0) SetupTreeCache();
+}
+
+EventReader::~EventReader() {
+  if (treeCacheSize > 0 && !ioStatisticsPrinted) PrintIOStatistics({this});
+}
+
+void EventReader::SetupTreeCache() {
+  // The prefetching thread is started by the cache when it's created, so this has to be set first
+  if (asyncPrefetching) gEnv->SetValue("TFile.AsyncPrefetching", 1);
+
+  // The cache learns which branches are read during the first events and only fetches those afterwards.
+  // In the lazy loading mode, these are just the branches actually used by the app.
+  for (auto& eventsTreeName : eventsTreeNames) {
+    auto chain = inputTrees[eventsTreeName];
+    chain->SetCacheSize((Long64_t)treeCacheSize * 1024 * 1024);
+    chain->SetCacheLearnEntries(treeCacheLearnEntries);
+  }
+
+  info() << "TTreeCache of " << treeCacheSize << " MB enabled, learning branches during the first "
+         << treeCacheLearnEntries << " events" << (asyncPrefetching ? ", with asynchronous prefetching" : "") << endl;
+}
+
+void EventReader::PrintIOStatistics(const vector<EventReader*>& eventReaders) {
+  double sumOfHitRates = 0;
+  int nCaches = 0;
+
+  for (auto eventReader : eventReaders) {
+    if (eventReader->treeCacheSize <= 0) continue;
+    eventReader->ioStatisticsPrinted = true;
+    for (auto& eventsTreeName : eventReader->eventsTreeNames) {
+      auto tree = eventReader->inputTrees[eventsTreeName]->GetTree();
+      if (!tree) continue;
+      auto cache = tree->GetReadCache(tree->GetCurrentFile());
+      if (!cache) continue;
+      sumOfHitRates += cache->GetEfficiencyRel();
+      nCaches++;
+    }
+  }
+  if (nCaches == 0) return;
+
+  // read calls and bytes are counted by ROOT for all files opened in the process
+  info() << "TTreeCache hit rate: " << 100 * sumOfHitRates / nCaches << "%, read calls: " << TFile::GetFileReadCalls()
+         << ", bytes read: " << TFile::GetFileBytesRead() / (1024 * 1024) << " MB" << endl;
+}
+
+vector<string> EventReader::ExpandInputFilePattern(const string& pattern) {
+  bool isRemote = pattern.find("://") != string::npos || pattern.rfind("/store/", 0) == 0;
+  if (isRemote || pattern.find_first_of("*?") == string::npos) return {pattern};
+
+  // Only the file name can contain wildcards, as in TChain::Add
+  filesystem::path patternPath(pattern);
+  filesystem::path directory = patternPath.has_parent_path() ? patternPath.parent_path() : ".";
+
+  string fileNameRegex;
+  for (char c : patternPath.filename().string()) {
+    if (c == '*') {
+      fileNameRegex += ".*";
+    } else if (c == '?') {
+      fileNameRegex += ".";
+    } else {
+      if (string("\\^$.|+()[]{}").find(c) != string::npos) fileNameRegex += '\\';
+      fileNameRegex += c;
+    }
+  }
+  regex fileNameMatcher(fileNameRegex);
+
+  vector<string> paths;
+  error_code errorCode;
+  for (auto& entry : filesystem::directory_iterator(directory, errorCode)) {
+    if (!entry.is_regular_file()) continue;
+    if (regex_match(entry.path().filename().string(), fileNameMatcher)) paths.push_back(entry.path().string());
+  }
+  if (errorCode) error() << "Couldn't list input directory " << directory << ": " << errorCode.message() << endl;
+
+  // sorted, so that the order of events doesn't depend on the file system
+  sort(paths.begin(), paths.end());
+  return paths;
+}
+
+void EventReader::OpenFirstInputFile() {
+  auto& config = ConfigManager::GetInstance();
+  string inputFilePath = inputFilePaths[0];
 
   // if inputFilePath is a DAS dataset name, insert a redirector into it
   if ((inputFilePath.find("root://") == string::npos) && (inputFilePath.rfind("/store/", 0) == 0)) {
@@ -67,7 +200,12 @@ EventReader::EventReader() {
       fatal() << "All redirectors failed" << endl;
       exit(1);
     }
-    inputFilePath = tmpInputFilePath;
+
+    // other files from DAS are read with the same redirector as the first one
+    string redirectorPrefix = tmpInputFilePath.substr(0, tmpInputFilePath.size() - inputFilePath.size());
+    for (auto& path : inputFilePaths) {
+      if ((path.find("root://") == string::npos) && (path.rfind("/store/", 0) == 0)) path = redirectorPrefix + path;
+    }
   } else {
     gSystem->RedirectOutput("/dev/null", "a");
     inputFile = TFile::Open(inputFilePath.c_str());
@@ -78,16 +216,8 @@ EventReader::EventReader() {
       exit(1);
     }
   }
-
-  SetupTrees();
-  SetupBranches();
-
-  addedBranches = make_unique<AddedBranches>();
-  if (!addedBranches->Empty()) addedBranches->Setup(eventsTreeNames, inputTrees);
 }
 
-EventReader::~EventReader() {}
-
 long long EventReader::GetNevents() const {
   long long nEntries = inputTrees.at(eventsTreeNames[0])->GetEntries();
 
@@ -131,16 +261,29 @@ tuple<string, string> EventReader::GetCollectionAndVariableNames(string branchNa
   return make_tuple(collectionName, variableName);
 }
 
+TChain* EventReader::CreateChain(string treeName) {
+  if (!inputFile->Get(treeName.c_str())) return nullptr;
+
+  auto chain = new TChain(treeName.c_str());
+  for (auto& path : inputFilePaths) chain->Add(path.c_str());
+
+  // Counting entries opens all files, so it has to be done before branches are set up for the first one
+  chain->GetEntries();
+  chain->LoadTree(0);
+  currentTreeNumbers[treeName] = chain->GetTreeNumber();
+  return chain;
+}
+
 void EventReader::SetupTrees() {
   vector<string> treeNames = getListOfTrees(inputFile);
 
   cout << "\033[1;92mLoading trees: ";
   for (string treeName : treeNames) {
     if (inputTrees.find(treeName) != inputTrees.end()) continue;
-    auto tree = (TTree*)inputFile->Get(treeName.c_str());
+    auto chain = CreateChain(treeName);
 
-    if (tree) {
-      inputTrees[treeName] = tree;
+    if (chain) {
+      inputTrees[treeName] = chain;
       cout << treeName << " ✓  ";
     } else {
       cout << "\033[31m" << treeName << " ✗\033[1;92m  ";
@@ -150,7 +293,7 @@ void EventReader::SetupTrees() {
 
   for (string eventsTreeName : eventsTreeNames) {
     if (!inputTrees.count(eventsTreeName)) {
-      inputTrees[eventsTreeName] = (TTree*)inputFile->Get(eventsTreeName.c_str());
+      inputTrees[eventsTreeName] = CreateChain(eventsTreeName);
     }
   }
 
@@ -166,6 +309,53 @@ void EventReader::SetupTrees() {
   }
 }
 
+void EventReader::UpdateTreeBranches(string treeName) {
+  // TChain moves addresses of all branches to the new file by itself, so nothing has to be rebound as long as the
+  // file has the same branches as the first one. Only the lazy loaders keep pointers to branches of a specific file.
+  auto tree = inputTrees[treeName]->GetTree();
+  auto& expectedBranches = branchNamesPerTree[treeName];
+  size_t nFoundBranches = 0;
+
+  for (auto branchIter : *tree->GetListOfBranches()) {
+    auto branch = (TBranch*)branchIter;
+    string branchName = branch->GetName();
+    if (!expectedBranches.count(branchName)) {
+      warn() << "Branch " << branchName << " is not present in the first input file and will be ignored" << endl;
+      continue;
+    }
+    nFoundBranches++;
+
+    string branchType = GetLeaf(branch)->GetTypeName();
+    if (branchType != branchNamesAndTypes[branchName]) {
+      fatal() << "Branch " << branchName << " has type " << branchType << " in " << tree->GetCurrentFile()->GetName()
+              << ", but " << branchNamesAndTypes[branchName] << " in the first input file" << endl;
+      exit(1);
+    }
+
+    auto loader = currentEvent->branchLoaders.find(branchName);
+    if (loader != currentEvent->branchLoaders.end()) loader->second.SetBranch(branch);
+  }
+
+  if (nFoundBranches != expectedBranches.size()) {
+    fatal() << "Input file " << tree->GetCurrentFile()->GetName() << " is missing some of the branches of tree "
+            << treeName << " present in the first input file" << endl;
+    exit(1);
+  }
+}
+
+void EventReader::CheckTreeNumbers() {
+  for (auto& [name, tree] : inputTrees) {
+    int treeNumber = tree->GetTreeNumber();
+    if (treeNumber == currentTreeNumbers[name]) continue;
+    currentTreeNumbers[name] = treeNumber;
+
+    bool isEventsTree = find(eventsTreeNames.begin(), eventsTreeNames.end(), name) != eventsTreeNames.end();
+    if (!isEventsTree) continue;
+    UpdateTreeBranches(name);
+    if (!addedBranches->Empty()) addedBranches->UpdateFormulaLeaves();
+  }
+}
+
 TLeaf* EventReader::GetLeaf(TBranch* branch) {
   TLeaf* leaf = nullptr;
   string branchName = branch->GetName();
@@ -195,6 +385,8 @@ bool EventReader::IsVectorBranch(TBranch* branch) {
 
 void EventReader::SetupBranches() {
   branchesPerCollection.clear();
+  currentEvent->lazyLoading = lazyBranchLoading;
+
   for (string eventsTreeName : eventsTreeNames) {
     for (auto branchIter : *inputTrees[eventsTreeName]->GetListOfBranches()) {
       auto branch = (TBranch*)branchIter;
@@ -205,13 +397,21 @@ void EventReader::SetupBranches() {
 
       if (branchType == "") error() << "Couldn't find branch type for branch: " << branchName << endl;
       branchNamesAndTypes[branchName] = branchType;
+      branchNamesPerTree[eventsTreeName].insert(branchName);
 
       auto [collectionName, variableName] = GetCollectionAndVariableNames(branchName);
       branchesPerCollection[collectionName].push_back(branchName);
 
+      BranchLoader* loader = nullptr;
+      if (lazyBranchLoading) {
+        BranchLoader branchLoader(branch, &loadedEntries[eventsTreeName]);
+        loader = &currentEvent->branchLoaders.emplace(branchName, branchLoader).first->second;
+      }
+
       bool branchIsVector = IsVectorBranch(branch);
       if (branchIsVector) {
         SetupVectorBranch(branchName, branchType, eventsTreeName);
+        if (loader) currentEvent->columnarCollections.at(collectionName)->SetLoader(variableName, loader);
       } else {
         SetupScalarBranch(branchName, branchType, eventsTreeName);
       }
@@ -220,7 +420,7 @@ void EventReader::SetupBranches() {
 }
 
 void EventReader::SetupScalarBranch(string branchName, string branchType, string eventsTreeName) {
-  currentEvent->valuesTypes[branchName] = branchType;
+  currentEvent->valuesTypes[branchName] = RootTypeTag(branchType);
 
   if (branchType == "UInt_t") {
     currentEvent->valuesUint[branchName] = 0;
@@ -260,140 +460,206 @@ void EventReader::SetupScalarBranch(string branchName, string branchType, string
 void EventReader::SetupVectorBranch(string branchName, string branchType, string eventsTreeName) {
   auto [collectionName, variableName] = GetCollectionAndVariableNames(branchName);
   isCollectionAnStdVector[collectionName] = branchType.find("vector") != string::npos;
-  InitializeCollection(collectionName);
-
-  for (int i = 0; i < maxCollectionElements; i++) {
-    string branchTypeToStore = branchType;
-    if (branchType == "vector<float>") branchTypeToStore = "Float_t";
-    if (branchType == "vector<double>") branchTypeToStore = "Double_t";
-    if (branchType == "vector<int>") branchTypeToStore = "Int_t";
-    if (branchType == "vector<unsigned int>") branchTypeToStore = "UInt_t";
-    if (branchType == "vector<bool>") branchTypeToStore = "UInt_t";
-    currentEvent->collections[collectionName]->at(i)->valuesTypes[variableName] = branchTypeToStore;
-  }
+  auto columns = InitializeCollection(collectionName);
+  auto tree = inputTrees[eventsTreeName];
 
   if (branchType == "Float_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesFloatVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesFloat[variableName] = &currentEvent->valuesFloatVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesFloatVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kFloat, currentEvent->valuesFloatVector[branchName]);
   } else if (branchType == "Double_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesDoubleVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesDouble[variableName] = &currentEvent->valuesDoubleVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesDoubleVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kDouble, currentEvent->valuesDoubleVector[branchName]);
   } else if (branchType == "UChar_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUcharVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesUchar[variableName] = &currentEvent->valuesUcharVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUcharVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kUChar, currentEvent->valuesUcharVector[branchName]);
   } else if (branchType == "Char_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesCharVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesChar[variableName] = &currentEvent->valuesCharVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesCharVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kChar, currentEvent->valuesCharVector[branchName]);
   } else if (branchType == "Int_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesIntVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesInt[variableName] = &currentEvent->valuesIntVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesIntVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kInt, currentEvent->valuesIntVector[branchName]);
   } else if (branchType == "Bool_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesBoolVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesBool[variableName] = &currentEvent->valuesBoolVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesBoolVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kBool, currentEvent->valuesBoolVector[branchName]);
   } else if (branchType == "UInt_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUintVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesUint[variableName] = &currentEvent->valuesUintVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUintVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kUInt, currentEvent->valuesUintVector[branchName]);
   } else if (branchType == "UShort_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUshortVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesUshort[variableName] = &currentEvent->valuesUshortVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesUshortVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kUShort, currentEvent->valuesUshortVector[branchName]);
   } else if (branchType == "Short_t") {
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesShortVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesShort[variableName] = &currentEvent->valuesShortVector[branchName][i];
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesShortVector[branchName]);
+    columns->AddColumn(variableName, branchName, BranchType::kShort, currentEvent->valuesShortVector[branchName]);
   } else if (branchType == "vector<float>") {
     currentEvent->valuesStdFloatVector[branchName] = new vector<float>(maxCollectionElements, 0);
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdFloatVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesFloat[variableName] = &currentEvent->valuesStdFloatVector[branchName]->at(i);
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdFloatVector[branchName]);
+    columns->AddStdVectorColumn(variableName, branchName, currentEvent->valuesStdFloatVector[branchName]);
   } else if (branchType == "vector<double>") {
     currentEvent->valuesStdDoubleVector[branchName] = new vector<double>(maxCollectionElements, 0);
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdDoubleVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesDouble[variableName] = &currentEvent->valuesStdDoubleVector[branchName]->at(i);
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdDoubleVector[branchName]);
+    columns->AddStdVectorColumn(variableName, branchName, currentEvent->valuesStdDoubleVector[branchName]);
   } else if (branchType == "vector<int>") {
     currentEvent->valuesStdIntVector[branchName] = new vector<int>(maxCollectionElements, 0);
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdIntVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesInt[variableName] = &currentEvent->valuesStdIntVector[branchName]->at(i);
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdIntVector[branchName]);
+    columns->AddStdVectorColumn(variableName, branchName, currentEvent->valuesStdIntVector[branchName]);
   } else if (branchType == "vector<unsigned int>" || branchType == "vector<bool>") {
     currentEvent->valuesStdUintVector[branchName] = new vector<unsigned int>(maxCollectionElements, 0);
-    inputTrees[eventsTreeName]->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdUintVector[branchName]);
-    for (int i = 0; i < maxCollectionElements; i++) {
-      currentEvent->collections[collectionName]->at(i)->valuesUint[variableName] = &currentEvent->valuesStdUintVector[branchName]->at(i);
-    }
+    tree->SetBranchAddress(branchName.c_str(), &currentEvent->valuesStdUintVector[branchName]);
+    columns->AddStdVectorColumn(variableName, branchName, currentEvent->valuesStdUintVector[branchName]);
   } else {
     error() << "unsupported vector branch type: " << branchType << "\t (branch name: " << branchName << ")" << endl;
   }
 }
 
-void EventReader::InitializeCollection(string collectionName) {
-  if (currentEvent->collections.count(collectionName)) return;
+shared_ptr<ColumnarCollection> EventReader::InitializeCollection(string collectionName) {
+  auto& columns = currentEvent->columnarCollections[collectionName];
+  if (columns) return columns;
+
+  columns = make_shared<ColumnarCollection>(collectionName);
+  // Objects are only views of the columns, created when an event with more objects than ever before shows up
   currentEvent->collections[collectionName] = make_shared<PhysicsObjects>();
-  for (int i = 0; i < maxCollectionElements; i++) {
-    currentEvent->collections[collectionName]->push_back(make_shared<PhysicsObject>(collectionName));
+  return columns;
+}
+
+void EventReader::ResizeCollection(shared_ptr<PhysicsObjects> collection, shared_ptr<ColumnarCollection> columns,
+                                   size_t size) {
+  size = min(size, (size_t)maxCollectionElements);
+  columns->SetSize(size);
+
+  for (size_t row = collection->GetAllocatedSize(); row < size; row++) {
+    collection->push_back(make_shared<PhysicsObject>(columns.get(), row));
   }
+  collection->ChangeVisibleSize(size);
 }
 
-template <typename First, typename... Rest>
-int EventReader::tryGet(shared_ptr<Event> event, string branchName) {
+void EventReader::SetupAlwaysLoadedBranches() {
+  auto& config = ConfigManager::GetInstance();
+
+  vector<string> branchNames;
   try {
-    First value = event->Get(branchName);
-    return value;
-  } catch (BadTypeException& e) {
-    if constexpr (sizeof...(Rest) > 0) {
-      return tryGet<Rest...>(event, branchName);
-    } else {
-      return -1;
+    config.GetVector("alwaysLoadBranches", branchNames);
+  } catch (const Exception& e) {
+  }
+
+  // Sizes are needed to set up collections in every event, and the weight to fill the cut flow
+  for (auto& [name, collection] : currentEvent->collections) {
+    if (isCollectionAnStdVector[name]) continue;
+    branchNames.push_back(GetSizeBranchName(name));
+  }
+  string weightsBranchName;
+  try {
+    config.GetValue("weightsBranchName", weightsBranchName);
+    branchNames.push_back(weightsBranchName);
+  } catch (const Exception& e) {
+  }
+  for (auto& branchName : addedBranches->GetInputBranchNames()) branchNames.push_back(branchName);
+
+  for (auto& branchName : branchNames) {
+    auto loader = currentEvent->FindLoader(branchName);
+    if (!loader) continue;
+    if (find(alwaysLoadedBranches.begin(), alwaysLoadedBranches.end(), loader) != alwaysLoadedBranches.end()) continue;
+    alwaysLoadedBranches.push_back(loader);
+  }
+}
+
+void EventReader::LoadCurrentEntry(string treeName) {
+  if (!lazyBranchLoading) return;
+  inputTrees.at(treeName)->GetEntry(currentEntry);
+}
+
+const string& EventReader::GetSizeBranchName(const string& collectionName) {
+  auto it = sizeBranchNames.find(collectionName);
+  if (it != sizeBranchNames.end()) return it->second;
+
+  string sizeBranchName = "n" + collectionName;
+  if (specialBranchSizes.count(collectionName)) sizeBranchName = specialBranchSizes[collectionName];
+  return sizeBranchNames.emplace(collectionName, sizeBranchName).first->second;
+}
+
+vector<pair<long long, long long>> EventReader::GetEntryRanges(int nRanges) {
+  long long nEvents = GetNevents();
+
+  // Ranges start at cluster boundaries, so that no basket has to be read and decompressed by two threads.
+  // Clusters are defined per file, so all files of the chain are visited.
+  vector<long long> clusterStarts;
+  auto chain = inputTrees.at(eventsTreeNames[0]);
+  for (int iTree = 0; iTree < chain->GetNtrees(); iTree++) {
+    long long treeOffset = chain->GetTreeOffset()[iTree];
+    if (treeOffset >= nEvents) break;
+    chain->LoadTree(treeOffset);
+
+    auto clusterIterator = chain->GetTree()->GetClusterIterator(0);
+    long long treeEntries = chain->GetTree()->GetEntries();
+    long long clusterStart = clusterIterator.Next();
+    while (clusterStart < treeEntries && treeOffset + clusterStart < nEvents) {
+      if (!clusterStarts.empty() && treeOffset + clusterStart <= clusterStarts.back()) break;
+      clusterStarts.push_back(treeOffset + clusterStart);
+      clusterStart = clusterIterator.Next();
     }
   }
+  // the chain was moved to other files, so branches will be updated again when reading the next event
+  for (auto& [name, treeNumber] : currentTreeNumbers) treeNumber = -1;
+
+  vector<pair<long long, long long>> ranges;
+  long long rangeStart = 0;
+  for (size_t iCluster = 1; iCluster < clusterStarts.size() && (int)ranges.size() < nRanges - 1; iCluster++) {
+    long long boundary = clusterStarts[iCluster];
+    if (boundary < (long long)(ranges.size() + 1) * nEvents / nRanges) continue;
+    ranges.push_back({rangeStart, boundary});
+    rangeStart = boundary;
+  }
+  ranges.push_back({rangeStart, nEvents});
+  return ranges;
 }
 
-shared_ptr<Event> EventReader::GetEvent(int iEvent) {
-  static int lastPrinted = -1;
-  int nEvents = GetNevents();
+void EventReader::PrintProgress(long long iEvent, long long nEvents) {
   int percentage = ((iEvent + 1) * 100) / nEvents;
-  if (percentage != lastPrinted) {
-    lastPrinted = percentage;
-    std::ostringstream progress;
-    progress << "\033[1;92m[";
-    int width = 50;
-    int pos = (percentage * width) / 100;
-    for (int i = 0; i < width; ++i) {
-      if (i < pos)
-        progress << "=";
-      else if (i == pos)
-        progress << ">";
-      else
-        progress << " ";
+  std::ostringstream progress;
+  progress << "\033[1;92m[";
+  int width = 50;
+  int pos = (percentage * width) / 100;
+  for (int i = 0; i < width; ++i) {
+    if (i < pos)
+      progress << "=";
+    else if (i == pos)
+      progress << ">";
+    else
+      progress << " ";
+  }
+  progress << "] " << percentage << "% (Event " << iEvent + 1 << "/" << nEvents << ")";
+  Terminal::SetProgress(progress.str());
+
+  if (iEvent == nEvents - 1) {
+    cerr << "\033[0m\n" << endl;
+  }
+}
+
+shared_ptr<Event> EventReader::GetEvent(int iEvent) {
+  if (showProgress) {
+    long long nEvents = GetNevents();
+    int percentage = ((iEvent + 1) * 100) / nEvents;
+    if (percentage != lastPrintedPercentage) {
+      lastPrintedPercentage = percentage;
+      PrintProgress(iEvent, nEvents);
     }
-    progress << "] " << percentage << "% (Event " << iEvent + 1 << "/" << nEvents << ")";
-    Terminal::SetProgress(progress.str());
   }
 
   currentEvent->Reset();
 
-  // Move to desired entry in all trees
-  for (auto& [name, tree] : inputTrees) tree->GetEntry(iEvent);
+  // Move to desired entry in all trees. In the lazy mode, only branches from the always-load list are read here and
+  // the others are read the first time they are accessed in this event.
+  currentEntry = iEvent;
+  if (lazyBranchLoading) {
+    for (auto& [name, loadedEntry] : loadedEntries) {
+      loadedEntry.entry = inputTrees[name]->LoadTree(iEvent);
+      loadedEntry.serial++;
+    }
+    CheckTreeNumbers();
+    for (auto loader : alwaysLoadedBranches) loader->Load();
+  } else {
+    for (auto& [name, tree] : inputTrees) tree->GetEntry(iEvent);
+    CheckTreeNumbers();
+  }
 
   // Tell collections where to stop in loops, without actually changing their size in memory
   for (auto& [name, collection] : currentEvent->collections) {
@@ -402,6 +668,7 @@ shared_ptr<Event> EventReader::GetEvent(int iEvent) {
     if (isCollectionAnStdVector[name]) {
       const auto& branchList = branchesPerCollection[name];
       for (const auto& branchName : branchList) {
+        currentEvent->LoadBranch(branchName);
         if (currentEvent->valuesStdFloatVector.count(branchName)) {
           collectionSize = currentEvent->valuesStdFloatVector[branchName]->size();
           break;
@@ -416,51 +683,23 @@ shared_ptr<Event> EventReader::GetEvent(int iEvent) {
           break;
         }
       }
-    } else if (specialBranchSizes.count(name)) {
-      collectionSize = tryGet<Int_t, UInt_t>(currentEvent, specialBranchSizes[name]);
     } else if (name == "") {
       error() << "Empty collection name. This should never happen, so please report an issue." << endl;
       continue;
     } else {
-      std::string sizeBranch = "n" + name;
-      auto it = defaultBranchSizeTypes.find(name);
-      if (it != defaultBranchSizeTypes.end()) {
-        if (it->second == "UInt_t") {
-          collectionSize = currentEvent->GetAs<UInt_t>(sizeBranch);
-        } else if (it->second == "Int_t") {
-          collectionSize = currentEvent->GetAs<Int_t>(sizeBranch);
-        }
-      } else {
-        int size = -1;
-        try {
-          size = currentEvent->GetAs<Int_t>(sizeBranch);
-          defaultBranchSizeTypes[name] = "Int_t";
-        } catch (BadTypeException& e1) {
-          try {
-            size = currentEvent->GetAs<UInt_t>(sizeBranch);
-            defaultBranchSizeTypes[name] = "UInt_t";
-          } catch (BadTypeException& e2) {
-            size = -1;
-          }
-        }
-        collectionSize = size;
-      }
+      collectionSize = currentEvent->GetAs<Int_t>(GetSizeBranchName(name));
     }
 
     if (collectionSize < 0) {
       error() << "Couldn't determine collection size: " << name << endl;
       continue;
     }
-    collection->ChangeVisibleSize(collectionSize);
+    ResizeCollection(collection, currentEvent->columnarCollections.at(name), collectionSize);
   }
 
-  currentEvent->AddExtraCollections();
-
+  // extra collections are only built when asked for (see Event::GetCollection)
   if (!addedBranches->Empty()) addedBranches->Evaluate(currentEvent);
 
-  if (iEvent == nEvents - 1) {
-    cerr << "\033[0m\n" << endl;
-  }
   return currentEvent;
 }
 
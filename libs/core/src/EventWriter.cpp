@@ -7,6 +7,8 @@
 #include <algorithm>
 
 #include "Helpers.hpp"
+#include "TChain.h"
+#include "TFileMerger.h"
 
 using namespace std;
 
@@ -102,10 +104,17 @@ size_t FilterAddedBranchIfPruned(T *buffer, size_t writeIndex,
   return FilterBranch(buffer, *keepIndices);
 }
 
-EventWriter::EventWriter(const shared_ptr<EventReader> &eventReader_)
+EventWriter::EventWriter(const shared_ptr<EventReader> &eventReader_, int part)
     : eventReader(eventReader_) {
   auto &config = ConfigManager::GetInstance();
-  config.GetValue("treeOutputFilePath", outputFilePath);
+  config.GetValue("treeOutputFilePath", finalOutputFilePath);
+
+  outputFilePath = finalOutputFilePath;
+  if (part >= 0) {
+    filesystem::path path(finalOutputFilePath);
+    string partFileName = path.stem().string() + "_part" + to_string(part) + path.extension().string();
+    outputFilePath = (path.parent_path() / partFileName).string();
+  }
 
   try {
     config.GetVector("branchesToKeep", branchesToKeep);
@@ -492,6 +501,7 @@ void EventWriter::FillAddedBranches(string treeName) {
 }
 
 void EventWriter::AddCurrentEvent(string treeName) {
+  eventReader->LoadCurrentEntry(treeName);
   FillAddedBranches(treeName);
   RepackBoolVectorBranches(treeName);
   outputTrees[treeName]->Fill();
@@ -499,6 +509,7 @@ void EventWriter::AddCurrentEvent(string treeName) {
 
 void EventWriter::AddCurrentHepMCevent(string treeName,
                                        const vector<int> &keepIndices) {
+  eventReader->LoadCurrentEntry(treeName);
   auto &event = eventReader->currentEvent;
 
   size_t writeIndex;
@@ -549,9 +560,36 @@ void EventWriter::Save() {
            << endl;
   }
 
+  WriteOutputTrees();
+  if (outputFilePath != finalOutputFilePath) MergePartFiles();
+  info() << "Saved output trees to " << finalOutputFilePath << endl;
+}
+
+void EventWriter::Merge(EventWriter &other) {
+  for (auto &[name, setByApp] : other.everSetByApp) everSetByApp[name] = everSetByApp[name] || setByApp;
+
+  other.WriteOutputTrees();
+  partFilePaths.push_back(other.outputFilePath);
+}
+
+void EventWriter::WriteOutputTrees() {
   for (auto &[name, tree] : outputTrees) {
     tree->Write();
   }
-  info() << "Saved output trees to " << outputFilePath << endl;
   outFile->Close();
 }
+
+void EventWriter::MergePartFiles() {
+  partFilePaths.insert(partFilePaths.begin(), outputFilePath);
+
+  // parts are added in the order of their entries, so the merged trees have the same order of events as the input
+  TFileMerger merger(false);
+  merger.OutputFile(finalOutputFilePath.c_str(), "RECREATE");
+  for (auto &partFilePath : partFilePaths) merger.AddFile(partFilePath.c_str());
+
+  if (!merger.Merge()) {
+    error() << "Failed to merge output files into " << finalOutputFilePath << ". Parts were kept." << endl;
+    return;
+  }
+  for (auto &partFilePath : partFilePaths) filesystem::remove(partFilePath);
+}
@@ -11,12 +11,16 @@ using namespace std;
 namespace {
 // Objects that had a custom value set since the last Event::Reset(). Keeping the list means clearing
 // is proportional to the number of objects the app actually touched, rather than to all
-// maxCollectionElements objects of every collection.
-vector<PhysicsObject *> objectsWithCustomValues;
+// maxCollectionElements objects of every collection. Every event loop thread processes its own events, hence one
+// list per thread.
+thread_local vector<PhysicsObject *> objectsWithCustomValues;
 }  // namespace
 
 PhysicsObject::PhysicsObject(std::string originalCollection_, int index_) : originalCollection(originalCollection_), index(index_) {}
 
+PhysicsObject::PhysicsObject(const ColumnarCollection *columns_, int row_)
+    : originalCollection(columns_->GetName()), index(-1), columns(columns_), row(row_) {}
+
 void PhysicsObject::RememberCustomValues() {
   if (hasCustomValues) return;
   hasCustomValues = true;
@@ -39,12 +43,7 @@ void PhysicsObject::ClearAllCustomValues() {
 }
 
 void PhysicsObject::Reset() {
-  for (auto& [key, value] : valuesUint) value = 0;
-  for (auto& [key, value] : valuesInt) value = 0;
-  for (auto& [key, value] : valuesBool) value = 0;
-  for (auto& [key, value] : valuesFloat) value = 0;
-  for (auto& [key, value] : customValuesFloat) value = 0;
-  for (auto& [key, value] : valuesUlong) value = 0;
-  for (auto& [key, value] : valuesUchar) value = 0;
-  for (auto& [key, value] : valuesChar) value = 0;
+  // Input values belong to the collection's columns, so only the custom values of this object can be dropped
+  customValuesTypes.clear();
+  ForgetCustomValues();
 }
@@ -7,6 +7,9 @@
 #include <zlib.h>
 
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
 #include <type_traits>
 #include <utility>
 
@@ -36,11 +39,75 @@ std::shared_ptr<std::map<string, CorrectionRef>> from_file(const string& path) {
 }  // namespace
 #endif
 
+namespace {
+double ParseEdge(const json& edge) {
+  if (edge.is_number()) {
+    return edge.get<double>();
+  }
+  if (edge.is_string()) {
+    std::string s = edge.get<std::string>();
+    if (s == "Infinity" || s == "inf") return 1e30;
+    if (s == "-Infinity" || s == "-inf") return -1e30;
+    throw std::runtime_error("Unexpected string edge: " + s);
+  }
+  throw std::runtime_error("Unsupported edge type in JSON");
+}
+
+// bumped whenever the format of cached corrections changes
+const uint32_t correctionCacheVersion = 2;
+
+/// Inflates gzipped content in memory (returns it unchanged if it's not gzipped)
+string Decompress(const string& compressed) {
+  if (compressed.size() < 2 || (unsigned char)compressed[0] != 0x1f || (unsigned char)compressed[1] != 0x8b) return compressed;
+
+  z_stream stream = {};
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) throw std::runtime_error("Cannot initialize zlib");
+  stream.next_in = (Bytef*)compressed.data();
+  stream.avail_in = compressed.size();
+
+  string output;
+  const size_t chunkSize = 1 << 22;
+  int status = Z_OK;
+  while (status != Z_STREAM_END || stream.avail_in > 0) {
+    // concatenated gzip members are read one after another, like gzread does
+    if (status == Z_STREAM_END) inflateReset(&stream);
+
+    size_t size = output.size();
+    output.resize(size + chunkSize);
+    stream.next_out = (Bytef*)output.data() + size;
+    stream.avail_out = chunkSize;
+    status = inflate(&stream, Z_NO_FLUSH);
+    output.resize(size + chunkSize - stream.avail_out);
+
+    if (status != Z_OK && status != Z_STREAM_END) {
+      inflateEnd(&stream);
+      throw std::runtime_error("Cannot decompress scale factors file");
+    }
+  }
+  inflateEnd(&stream);
+  return output;
+}
+
+/// Replaces non-standard JSON literals, which nlohmann::json doesn't accept (-Infinity becomes -1e30)
+string ReplaceInfinities(const string& input) {
+  string output;
+  output.reserve(input.size());
+  size_t start = 0, pos;
+  while ((pos = input.find("Infinity", start)) != string::npos) {
+    output.append(input, start, pos - start);
+    output += "1e30";
+    start = pos + 8;
+  }
+  output.append(input, start, string::npos);
+  return output;
+}
+}  // namespace
+
 ScaleFactorsManager::ScaleFactorsManager() {
 #ifdef USE_CORRECTIONLIB
   info() << "Using correctionlib for scale factors." << endl;
 #else
-  info() << "correctionlib not found, will assume all SFs = 1.0." << endl;
+  info() << "correctionlib not found, only binned scale factors will be evaluated (others = 1.0)." << endl;
 #endif
 
   ReadScaleFactorFlags();
@@ -53,7 +120,7 @@ ScaleFactorsManager::ScaleFactorsManager() {
     }
     info() << "------------------------------------\n" << endl;
   }
-  ReadJetEnergyCorrections();
+  created = true;
 }
 
 bool ScaleFactorsManager::ShouldApplyScaleFactor(const std::string& name) {
@@ -64,7 +131,7 @@ bool ScaleFactorsManager::ShouldApplyVariation(const std::string& name) {
   return applyScaleFactors.count(name) ? applyScaleFactors[name][1] : false;
 }
 
-void ScaleFactorsManager::ExtractBounds(const json& node, map<string, pair<double, double>>& bounds) {
+void ScaleFactorsManager::ExtractBounds(const json& node, map<string, pair<double, double>>& bounds) const {
   if (node.find("nodetype") == node.end()) return;
 
   string type = node["nodetype"];
@@ -74,21 +141,8 @@ void ScaleFactorsManager::ExtractBounds(const json& node, map<string, pair<doubl
 
     const auto& edges = node["edges"];
 
-    auto parseEdge = [](const json& edge) -> double {
-      if (edge.is_number()) {
-        return edge.get<double>();
-      }
-      if (edge.is_string()) {
-        std::string s = edge.get<std::string>();
-        if (s == "Infinity" || s == "inf") return 1e30;
-        if (s == "-Infinity" || s == "-inf") return -1e30;
-        throw std::runtime_error("Unexpected string edge: " + s);
-      }
-      throw std::runtime_error("Unsupported edge type in JSON");
-    };
-
-    double min = parseEdge(edges.front());
-    double max = parseEdge(edges.back());
+    double min = ParseEdge(edges.front());
+    double max = ParseEdge(edges.back());
 
     bounds[input] = {min, max};
 
@@ -124,112 +178,321 @@ void ScaleFactorsManager::ExtractBounds(const json& node, map<string, pair<doubl
   }
 }
 
+void ScaleFactorsManager::ExtractBinEdges(const json& node, map<string, vector<double>>& edges, bool& piecewiseConstant) const {
+  if (node.is_number()) return;
+  if (!node.is_object() || node.find("nodetype") == node.end()) {
+    piecewiseConstant = false;
+    return;
+  }
+
+  string type = node["nodetype"];
+
+  // uniform binnings are given as {n, low, high} and correctionlib computes their bins arithmetically, so edges
+  // recomputed here could disagree with it exactly at the bin boundaries -- they're not cached
+  auto addEdges = [&](const string& input, const json& inputEdges) {
+    if (!inputEdges.is_array()) {
+      piecewiseConstant = false;
+      return;
+    }
+    for (const auto& edge : inputEdges) edges[input].push_back(ParseEdge(edge));
+  };
+
+  // flow can also be "clamp" or "error" instead of a node
+  auto addFlow = [&]() {
+    if (node.contains("flow") && !node["flow"].is_string()) ExtractBinEdges(node["flow"], edges, piecewiseConstant);
+  };
+
+  if (type == "binning") {
+    addEdges(node["input"], node["edges"]);
+    for (const auto& subnode : node["content"]) ExtractBinEdges(subnode, edges, piecewiseConstant);
+    addFlow();
+  } else if (type == "multibinning") {
+    for (size_t i = 0; i < node["inputs"].size(); ++i) addEdges(node["inputs"][i], node["edges"][i]);
+    for (const auto& subnode : node["content"]) ExtractBinEdges(subnode, edges, piecewiseConstant);
+    addFlow();
+  } else if (type == "category") {
+    for (const auto& item : node["content"]) ExtractBinEdges(item["value"], edges, piecewiseConstant);
+    if (node.contains("default") && !node["default"].is_null()) ExtractBinEdges(node["default"], edges, piecewiseConstant);
+  } else {
+    // formulas, transforms and random numbers change within a bin
+    piecewiseConstant = false;
+  }
+}
+
 void ScaleFactorsManager::ReadScaleFactors() {
-#ifndef USE_CORRECTIONLIB
-  return;
-#else
   auto& config = ConfigManager::GetInstance();
 
-  map<string, map<string, string>> scaleFactors;
   try {
-    config.GetMap("scaleFactors", scaleFactors);
-    scaleFactorsRead = !scaleFactors.empty();
+    config.GetMap("scaleFactors", scaleFactorsConfig);
+    scaleFactorsRead = !scaleFactorsConfig.empty();
   } catch (const Exception& e) {
     warn() << "Couldn't read scaleFactors from config (" << e.what() << ") -- no correctionlib scale factors will be loaded (weights default to 1.0)." << endl;
     return;
   }
+  try {
+    config.GetValue("scaleFactorsCacheDir", scaleFactorsCacheDir);
+  } catch (const Exception& e) {
+  }
 
-  for (auto& [name, values] : scaleFactors) {
-    if (!values.count("path") || !values.count("type")) continue;
-
-    auto cset = correction::CorrectionSet::from_file(values["path"]);
+  // only the arguments are set up here, the files are loaded when a correction is used for the first time
+  for (auto& [name, values] : scaleFactorsConfig) {
+    if (!values.count("path") || !values.count("type") || name.find("jec") != string::npos) continue;
     map<string, string> extraArgs;
-
     for (auto& [key, value] : values) {
       if (key == "path" || key == "type") continue;
       extraArgs[key] = value;
     }
-    if (corrections.count(name)) continue;
+    correctionsExtraArgs[name] = extraArgs;
+  }
+}
 
+void ScaleFactorsManager::LoadCorrection(const string& name) {
+  {
+    shared_lock<shared_mutex> lock(correctionsMutex);
+    if (usedCorrections.count(name)) return;
+  }
+
+  // workers share the manager, so the first one to use a correction loads it for all of them. Corrections are only
+  // added under loadingMutex, so they can be read without correctionsMutex here.
+  lock_guard<mutex> loadingLock(loadingMutex);
+  if (usedCorrections.count(name)) return;
+
+  auto entry = scaleFactorsConfig.find(name);
+  if (entry != scaleFactorsConfig.end() && !loadedEntries.count(name)) {
+    if (name.find("jec") != string::npos)
+      LoadJetEnergyCorrections({name});
+    else if (entry->second.count("path") && entry->second.count("type"))
+      LoadScaleFactors({entry->second["path"]});
+  }
+  unique_lock<shared_mutex> lock(correctionsMutex);
+  usedCorrections.insert(name);
+}
+
+void ScaleFactorsManager::LoadCorrections(const vector<string>& names) {
+  lock_guard<mutex> loadingLock(loadingMutex);
+
+  set<string> paths, jecNames;
+  for (auto& name : names) {
+    auto entry = scaleFactorsConfig.find(name);
+    if (entry == scaleFactorsConfig.end() || loadedEntries.count(name)) continue;
+    if (name.find("jec") != string::npos)
+      jecNames.insert(name);
+    else if (entry->second.count("path") && entry->second.count("type"))
+      paths.insert(entry->second["path"]);
+  }
+  LoadScaleFactors(paths);
+  LoadJetEnergyCorrections(jecNames);
+}
+
+void ScaleFactorsManager::LoadScaleFactors(const set<string>& paths) {
+  // each file is parsed once, so all corrections it provides are loaded together
+  map<string, set<string>> namesPerPath, typesPerPath;
+  for (auto& [name, values] : scaleFactorsConfig) {
+    if (!values.count("path") || !values.count("type") || !paths.count(values["path"])) continue;
     if (name.find("jec") != string::npos) continue;
-    try {
-      corrections[name] = cset->at(values["type"]);
-      correctionsExtraArgs[name] = extraArgs;
-    } catch (out_of_range& e) {
-      fatal() << "Incorrect correction type: " << values["type"] << endl;
-      fatal() << "Available corrections: " << endl;
-      for (auto& [name, corr] : *cset) fatal() << name << endl;
-      exit(1);
-    }
+    if (loadedEntries.count(name)) continue;
+    namesPerPath[values["path"]].insert(name);
+    typesPerPath[values["path"]].insert(values["type"]);
+  }
 
-    gzFile file = gzopen(values["path"].c_str(), "rb");
-    if (!file) throw std::runtime_error("Cannot open gz file");
+  // files are independent, so they're read and parsed in parallel
+  auto launchPolicy = typesPerPath.size() > 1 ? launch::async : launch::deferred;
+  map<string, future<CorrectionFile>> loadingFiles;
+  for (auto& [path, types] : typesPerPath) {
+    loadingFiles[path] = async(launchPolicy, &ScaleFactorsManager::LoadCorrectionFile, this, path, types);
+  }
+  map<string, CorrectionFile> files;
+  for (auto& [path, loadingFile] : loadingFiles) files[path] = loadingFile.get();
+
+  unique_lock<shared_mutex> lock(correctionsMutex);
+  for (auto& [path, names] : namesPerPath) {
+    auto& file = files[path];
+    for (auto& name : names) {
+      auto& values = scaleFactorsConfig[name];
+      loadedEntries.insert(name);
+
+      if (!file.corrections.count(values["type"])) {
+        fatal() << "Incorrect correction type: " << values["type"] << endl;
+        fatal() << "Available corrections: " << endl;
+        for (auto& available : file.availableCorrections) fatal() << available << endl;
+        exit(1);
+      }
+      auto& compiled = file.corrections[values["type"]];
 
-    std::string buffer;
-    char tmp[4096];
-    int bytes;
-    while ((bytes = gzread(file, tmp, sizeof(tmp))) > 0) {
-      buffer.append(tmp, bytes);
-    }
-    gzclose(file);
+#ifdef USE_CORRECTIONLIB
+      corrections[name] = file.correctionSet->at(values["type"]);
+#endif
+      boundsPerInput[name] = compiled.bounds;
 
-    // Replace non-standard JSON literals
-    size_t pos = 0;
-    while ((pos = buffer.find("Infinity", pos)) != std::string::npos) {
-      buffer.replace(pos, 8, "1e30");
-      pos += 4;
-    }
+      auto& cache = correctionCaches[name];
+      cache.binned = compiled.binned;
+      cache.edges = compiled.edges;
 
-    pos = 0;
-    while ((pos = buffer.find("-Infinity", pos)) != std::string::npos) {
-      buffer.replace(pos, 9, "-1e30");
-      pos += 5;
+      correctionTables.emplace(name, compiled.table);
+#ifndef USE_CORRECTIONLIB
+      if (!compiled.table.IsComplete())
+        warn() << "Scale factor " << name << " contains formulas, which need correctionlib -- they will be set to 1.0." << endl;
+#endif
     }
+    info() << "Loaded " << names.size() << " scale factors from " << path << endl;
+  }
+}
 
-    json fullJson = json::parse(buffer);
+void ScaleFactorsManager::PrintUnusedCorrections() {
+  if (!created) return;
+  auto& manager = GetInstance();
+  shared_lock<shared_mutex> lock(manager.correctionsMutex);
 
-    json corrJson;
+  set<string> loaded;
+  for (auto& [name, correction] : manager.corrections) loaded.insert(name);
+  for (auto& [name, correction] : manager.compoundCorrections) loaded.insert(name);
+  for (auto& [name, table] : manager.correctionTables) loaded.insert(name);
 
-    for (const auto& c : fullJson["corrections"]) {
-      if (c["name"] == values["type"]) {
-        corrJson = c;
-        break;
-      }
+  string unused;
+  for (auto& name : loaded) {
+    if (!manager.usedCorrections.count(name)) unused += " " + name;
+  }
+  if (!unused.empty()) info() << "Scale factors loaded but never used (can be removed from the config):" << unused << endl;
+}
+
+ScaleFactorsManager::CorrectionFile ScaleFactorsManager::LoadCorrectionFile(const string& path, const set<string>& types) const {
+  CorrectionFile file;
+  string content;
+  if (!readFile(path, content)) throw std::runtime_error("Cannot open scale factors file: " + path);
+
+  // compiled corrections are cached next to each other, keyed by the hash of the file they come from
+  string cachePrefix;
+  if (!scaleFactorsCacheDir.empty()) {
+    stringstream prefix;
+    prefix << scaleFactorsCacheDir << "/" << hex << hashBytes(content) << "_";
+    cachePrefix = prefix.str();
+
+    for (auto& type : types) {
+      ifstream cacheFile(cachePrefix + type + ".bin", ios::binary);
+      CompiledCorrection compiled;
+      if (cacheFile && compiled.Read(cacheFile)) file.corrections[type] = move(compiled);
     }
+  }
+  bool allCached = file.corrections.size() == types.size();
 
-    if (corrJson.is_null()) {
-      throw std::runtime_error("Correction not found in JSON");
+#ifndef USE_CORRECTIONLIB
+  if (allCached) return file;
+  content = Decompress(content);
+#else
+  content = Decompress(content);
+  // correctionlib gets the original content, it accepts infinities
+  file.correctionSet = correction::CorrectionSet::from_string(content.c_str());
+  if (allCached) return file;
+#endif
+
+  json fullJson = json::parse(ReplaceInfinities(content));
+  for (const auto& correction : fullJson["corrections"]) {
+    string type = correction["name"];
+    file.availableCorrections.push_back(type);
+    if (!types.count(type) || file.corrections.count(type)) continue;
+
+    file.corrections[type] = CompileCorrection(correction);
+    if (cachePrefix.empty()) continue;
+
+    // written to a temporary file first, so that jobs sharing the cache never read a partially written one
+    string cachePath = cachePrefix + type + ".bin";
+    string temporaryPath = cachePath + ".tmp" + to_string(randInt(0, 1000000000));
+    {
+      ofstream cacheFile(temporaryPath, ios::binary);
+      file.corrections[type].Write(cacheFile);
     }
+    error_code errorCode;
+    filesystem::rename(temporaryPath, cachePath, errorCode);
+    if (errorCode) filesystem::remove(temporaryPath, errorCode);
+  }
+  return file;
+}
 
-    map<string, pair<double, double>> bounds;
-    ExtractBounds(corrJson["data"], bounds);
-    boundsPerInput[name] = bounds;
+ScaleFactorsManager::CompiledCorrection ScaleFactorsManager::CompileCorrection(const json& correction) const {
+  CompiledCorrection compiled;
+  ExtractBounds(correction["data"], compiled.bounds);
+
+  map<string, vector<double>> binEdges;
+  bool piecewiseConstant = true;
+  ExtractBinEdges(correction["data"], binEdges, piecewiseConstant);
+
+  compiled.binned = piecewiseConstant;
+  double nKeys = 1;
+  for (const auto& input : correction["inputs"]) {
+    auto& edges = binEdges[input["name"].get<string>()];
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+    nKeys *= edges.size() + 1;
+    compiled.edges.push_back(edges);
   }
-#endif
+  if (nKeys > (double)numeric_limits<uint64_t>::max()) compiled.binned = false;
+
+  compiled.table = CorrectionTable(correction);
+  return compiled;
 }
 
-void ScaleFactorsManager::ReadJetEnergyCorrections() {
-#ifndef USE_CORRECTIONLIB
-  return;
-#else
+void ScaleFactorsManager::CompiledCorrection::Write(ostream& out) const {
+  WriteBinary(out, correctionCacheVersion);
 
-  if (!ShouldApplyScaleFactor("jec") && !ShouldApplyVariation("jec")) return;
+  vector<string> inputs;
+  vector<double> lows, highs;
+  for (auto& [input, bound] : bounds) {
+    inputs.push_back(input);
+    lows.push_back(bound.first);
+    highs.push_back(bound.second);
+  }
+  WriteBinary(out, inputs);
+  WriteBinary(out, lows);
+  WriteBinary(out, highs);
+  WriteBinary(out, edges);
+  WriteBinary(out, binned);
+  table.Write(out);
+}
 
-  auto& config = ConfigManager::GetInstance();
+bool ScaleFactorsManager::CompiledCorrection::Read(istream& in) {
+  uint32_t version;
+  if (!ReadBinary(in, version) || version != correctionCacheVersion) return false;
 
-  map<string, map<string, string>> scaleFactors;
-  try {
-    config.GetMap("scaleFactors", scaleFactors);
-  } catch (const Exception& e) {
-    warn() << "Couldn't read scaleFactors from config (" << e.what() << ") -- no JEC corrections will be loaded (weights default to 1.0)." << endl;
-    return;
+  vector<string> inputs;
+  vector<double> lows, highs;
+  if (!ReadBinary(in, inputs) || !ReadBinary(in, lows) || !ReadBinary(in, highs)) return false;
+  if (lows.size() != inputs.size() || highs.size() != inputs.size()) return false;
+  for (size_t i = 0; i < inputs.size(); i++) bounds[inputs[i]] = {lows[i], highs[i]};
+
+  return ReadBinary(in, edges) && ReadBinary(in, binned) && table.Read(in);
+}
+
+void ScaleFactorsManager::ReadJetEnergyCorrections() {
+  vector<string> names;
+  for (auto& [name, values] : scaleFactorsConfig) {
+    if (name.find("jec") != string::npos) names.push_back(name);
   }
+  LoadCorrections(names);
+}
 
-  for (auto& [name, values] : scaleFactors) {
-    if (name.find("jec") == std::string::npos) continue;
-    auto cset = correction::CorrectionSet::from_file(values["path"]);
+void ScaleFactorsManager::LoadJetEnergyCorrections(const set<string>& names) {
+  for (auto& name : names) loadedEntries.insert(name);
+#ifdef USE_CORRECTIONLIB
+  if (!ShouldApplyScaleFactor("jec") && !ShouldApplyVariation("jec")) return;
 
+  // each file is read once, and different files in parallel
+  auto launchPolicy = names.size() > 1 ? launch::async : launch::deferred;
+  map<string, future<shared_ptr<correction::CorrectionSet>>> loadingFiles;
+  for (auto& name : names) {
+    string path = scaleFactorsConfig[name]["path"];
+    if (loadingFiles.count(path)) continue;
+    loadingFiles[path] = async(launchPolicy, [path]() {
+      return shared_ptr<correction::CorrectionSet>(correction::CorrectionSet::from_file(path));
+    });
+  }
+  map<string, shared_ptr<correction::CorrectionSet>> files;
+  for (auto& [path, loadingFile] : loadingFiles) files[path] = loadingFile.get();
+
+  unique_lock<shared_mutex> lock(correctionsMutex);
+  for (auto& name : names) {
+    auto& values = scaleFactorsConfig[name];
     if (corrections.count(name)) continue;
+    auto& cset = files[values["path"]];
 
     string type = values["type"] + "_" + values["level"] + "_" + values["algo"];
     try {
@@ -246,6 +509,10 @@ void ScaleFactorsManager::ReadJetEnergyCorrections() {
         exit(1);
       }
     }
+
+    // uncertainty sources are only needed for variations
+    if (!ShouldApplyVariation("jec")) continue;
+
     vector<string> uncertainties = GetScaleFactorVariations(values["uncertainties"]);
     for (auto uncertainty : uncertainties) {
       string unc_type = values["type"] + "_" + uncertainty + "_" + values["algo"];
@@ -277,150 +544,124 @@ void ScaleFactorsManager::ReadScaleFactorFlags() {
 }
 
 map<string, float> ScaleFactorsManager::GetPUJetIDScaleFactors(string name, float eta, float pt) {
+  ScaleFactorsBatch batch;
+  GetPUJetIDScaleFactors(name, &eta, &pt, 1, batch);
+  return batch.GetProducts();
+}
+
+void ScaleFactorsManager::GetPUJetIDScaleFactors(string name, const float* eta, const float* pt, size_t nObjects,
+                                                 ScaleFactorsBatch& batch) {
   bool applyDefault = ShouldApplyScaleFactor("PUjetID");
   bool applyVariations = ShouldApplyVariation("PUjetID");
+  if (!applyDefault && !applyVariations) return FillNeutralBatch(nObjects, batch);
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations)
       warn() << "Requested PUJetID SF, which was not defined in the scale_factors_config: " << name << endl;
-    return {{"systematic", 1.0}};
-  }
-  map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else
-    scaleFactors["systematic"] = TryToEvaluate(name, {eta, pt, extraArgs["systematic"], extraArgs["workingPoint"]});
-  if (!applyVariations) return scaleFactors;
-
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, {eta, pt, variation, extraArgs["workingPoint"]});
+    return FillNeutralBatch(nObjects, batch);
   }
-  return scaleFactors;
+  vector<CorrectionArgType> args = {0.0, 0.0, "", GetExtraArgs(name)["workingPoint"]};
+  EvaluateBatch(name, args, 2, 0, false, eta, pt, nObjects, applyDefault, applyVariations, batch);
 }
 
 map<string, float> ScaleFactorsManager::GetMuonScaleFactors(string name, float eta, float pt) {
+  ScaleFactorsBatch batch;
+  GetMuonScaleFactors(name, &eta, &pt, 1, batch);
+  return batch.GetProducts();
+}
+
+void ScaleFactorsManager::GetMuonScaleFactors(string name, const float* eta, const float* pt, size_t nObjects,
+                                              ScaleFactorsBatch& batch) {
   bool applyDefault = ShouldApplyScaleFactor("muon");
   bool applyVariations = ShouldApplyVariation("muon");
+  if (!applyDefault && !applyVariations) return FillNeutralBatch(nObjects, batch);
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations) warn() << "Requested muon SF, which was not defined in the scale_factors_config: " << name << endl;
-    return {{"systematic", 1.0}};
-  }
-
-  auto extraArgs = correctionsExtraArgs[name];
-  map<string, float> scaleFactors;
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else
-    scaleFactors["systematic"] = TryToEvaluate(name, {fabs(eta), pt, extraArgs["systematic"]});
-  if (!applyVariations) return scaleFactors;
-
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, {fabs(eta), pt, variation});
+    return FillNeutralBatch(nObjects, batch);
   }
 
-  if (extraArgs.find("statistical") != extraArgs.end()) {
-    string statistical = extraArgs["statistical"];
-    float statSF = TryToEvaluate(name, {fabs(eta), pt, statistical});
-    scaleFactors[name + "_" + statistical + "_up"] = scaleFactors["systematic"] + statSF;
-    scaleFactors[name + "_" + statistical + "_down"] = scaleFactors["systematic"] - statSF;
-  }
-
-  return scaleFactors;
+  vector<CorrectionArgType> args = {0.0, 0.0, ""};
+  EvaluateBatch(name, args, 2, 0, true, eta, pt, nObjects, applyDefault, applyVariations, batch, true);
 }
 
 map<string, float> ScaleFactorsManager::GetDSAMuonScaleFactors(string name, const vector<CorrectionArgType>& args) {
   bool applyDefault = ShouldApplyScaleFactor("dsamuon");
   bool applyVariations = ShouldApplyVariation("dsamuon");
+  if (!applyDefault && !applyVariations) return {{"systematic", 1.0}};
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations)
       warn() << "Requested DSA muon SF, which was not defined in the scale_factors_config: " << name << endl;
     return {{"systematic", 1.0}};
   }
-  auto extraArgs = correctionsExtraArgs[name];
-  auto systematic_args = args;
-  systematic_args.push_back(extraArgs["systematic"]);
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations);
+  auto variation_args = args;
+  variation_args.push_back("");
+  vector<float> values;
+  EvaluateVariations(name, cache, variation_args, args.size(), 0, args.size(), values);
+
   map<string, float> scaleFactors;
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else
-    scaleFactors["systematic"] = TryToEvaluate(name, systematic_args);
+  size_t iValue = 0;
+  scaleFactors["systematic"] = applyDefault ? values[iValue++] : 1.0;
   if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    auto variation_args = args;
-    variation_args.push_back(variation);
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, variation_args);
-  }
+  for (auto& variation : cache.variations) scaleFactors[name + "_" + variation] = values[iValue++];
   return scaleFactors;
 }
 
 map<string, float> ScaleFactorsManager::GetMuonTriggerScaleFactors(string name, float eta, float pt) {
   bool applyDefault = ShouldApplyScaleFactor("muonTrigger");
   bool applyVariations = ShouldApplyVariation("muonTrigger");
+  if (!applyDefault && !applyVariations) return {{"systematic", 1.0}};
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations)
       warn() << "Requested muon trigger SF, which was not defined in the scale_factors_config: " << name << endl;
     return {{"systematic", 1.0}};
   }
 
-  auto extraArgs = correctionsExtraArgs[name];
-  map<string, float> scaleFactors;
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations, true);
+  vector<CorrectionArgType> args = {fabs(eta), pt, ""};
+  vector<float> values;
+  EvaluateVariations(name, cache, args, 2, 0, 2, values);
 
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else
-    scaleFactors["systematic"] = TryToEvaluate(name, {fabs(eta), pt, extraArgs["systematic"]});
+  map<string, float> scaleFactors;
+  size_t iValue = 0;
+  scaleFactors["systematic"] = applyDefault ? values[iValue++] : 1.0;
   if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, {fabs(eta), pt, variation});
-  }
+  for (auto& variation : cache.variations) scaleFactors[name + "_" + variation] = values[iValue++];
 
-  if (extraArgs.find("statistical") != extraArgs.end()) {
-    string statistical = extraArgs["statistical"];
-    float statSF = TryToEvaluate(name, {fabs(eta), pt, statistical});
-    scaleFactors[name + "_" + statistical + "_up"] = scaleFactors["systematic"] + statSF;
-    scaleFactors[name + "_" + statistical + "_down"] = scaleFactors["systematic"] - statSF;
+  if (!cache.statistical.empty()) {
+    float statSF = values[iValue++];
+    scaleFactors[name + "_" + cache.statistical + "_up"] = scaleFactors["systematic"] + statSF;
+    scaleFactors[name + "_" + cache.statistical + "_down"] = scaleFactors["systematic"] - statSF;
   }
-  
+
   return scaleFactors;
 }
 
 map<string, float> ScaleFactorsManager::GetBTagScaleFactors(string name, float eta, float pt) {
+  ScaleFactorsBatch batch;
+  GetBTagScaleFactors(name, &eta, &pt, 1, batch);
+  return batch.GetProducts();
+}
+
+void ScaleFactorsManager::GetBTagScaleFactors(string name, const float* eta, const float* pt, size_t nObjects,
+                                              ScaleFactorsBatch& batch) {
   bool applyDefault = ShouldApplyScaleFactor("bTagging");
   bool applyVariations = ShouldApplyVariation("bTagging");
+  if (!applyDefault && !applyVariations) return FillNeutralBatch(nObjects, batch);
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations) warn() << "Requested bTag SF, which was not defined in the scale_factors_config: " << name << endl;
-    return {{"systematic", 1.0}};
-  }
-
-  map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
-  if (!applyDefault) {
-    scaleFactors["systematic"] = 1.0;
-  } else {
-    vector<CorrectionArgType> args = {extraArgs["systematic"], extraArgs["workingPoint"], static_cast<int>(std::stol(extraArgs["flavour"])),
-                                      static_cast<double>(eta), static_cast<double>(pt)};
-    scaleFactors["systematic"] = TryToEvaluate(name, args);
+    return FillNeutralBatch(nObjects, batch);
   }
-  if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    vector<CorrectionArgType> args = {variation, extraArgs["workingPoint"], static_cast<int>(std::stol(extraArgs["flavour"])),
-                                      static_cast<double>(eta), static_cast<double>(pt)};
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, args);
-  }
-  return scaleFactors;
+  auto extraArgs = GetExtraArgs(name);
+  vector<CorrectionArgType> args = {"", extraArgs["workingPoint"], static_cast<int>(std::stol(extraArgs["flavour"])), 0.0, 0.0};
+  EvaluateBatch(name, args, 0, 3, false, eta, pt, nObjects, applyDefault, applyVariations, batch);
 }
 
 float ScaleFactorsManager::GetJetTagEfficiency(string name, string datasetName, float pt) {
@@ -428,12 +669,12 @@ float ScaleFactorsManager::GetJetTagEfficiency(string name, string datasetName,
   bool applyVariations = ShouldApplyVariation("bTagging");
   if (!applyDefault && !applyVariations) return 1.0;
 
-  if (corrections.find(name) == corrections.end()) {
+  if (!IsCorrectionDefined(name)) {
     if (applyDefault || applyVariations) warn() << "Requested bTag efficiency, which was not defined in the scale_factors_config: " << name << endl;
     return 1.0;
   }
 
-  auto extraArgs = correctionsExtraArgs[name];
+  auto extraArgs = GetExtraArgs(name);
 
   float efficiency = TryToEvaluate(name, {datasetName, pt});
   return efficiency;
@@ -443,7 +684,7 @@ vector<string> ScaleFactorsManager::GetBTagVariationNames(string name) {
   vector<string> variations;
   if (!ShouldApplyVariation("bTagging")) return variations;
 
-  auto extraArgs = correctionsExtraArgs[name];
+  auto extraArgs = GetExtraArgs(name);
   variations = GetScaleFactorVariations(extraArgs["variations"]);
   return variations;
 }
@@ -451,23 +692,27 @@ vector<string> ScaleFactorsManager::GetBTagVariationNames(string name) {
 map<string, float> ScaleFactorsManager::GetPileupScaleFactor(string name, float nVertices) {
   bool applyDefault = ShouldApplyScaleFactor("pileup");
   bool applyVariations = ShouldApplyVariation("pileup");
+  if (!applyDefault && !applyVariations) return {{"systematic", 1.0}};
+
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations);
+  vector<CorrectionArgType> args = {nVertices, ""};
+  vector<float> values;
+  EvaluateVariations(name, cache, args, 1, 0, 1, values);
 
   map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else
-    scaleFactors["systematic"] = TryToEvaluate(name, {nVertices, extraArgs["systematic"]});
+  size_t iValue = 0;
+  scaleFactors["systematic"] = applyDefault ? values[iValue++] : 1.0;
 
   if (!applyVariations) return scaleFactors;
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, {nVertices, variation});
-  }
+  for (auto& variation : cache.variations) scaleFactors[name + "_" + variation] = values[iValue++];
   return scaleFactors;
 }
 
 float ScaleFactorsManager::TryToEvaluate(const std::string& name, const vector<CorrectionArgType>& args) {
+  const CorrectionTable* table = Find(correctionTables, name);
+  double value;
+  if (table && table->Evaluate(args, value)) return value;
+
 #ifndef USE_CORRECTIONLIB
   return 1.0;
 #else
@@ -480,16 +725,167 @@ float ScaleFactorsManager::TryToEvaluate(const std::string& name, const vector<C
 #endif
 }
 
+ScaleFactorsManager::CorrectionCache& ScaleFactorsManager::GetCorrectionCache(const string& name, bool applyDefault,
+                                                                              bool applyVariations, bool withStatistical) {
+  {
+    shared_lock<shared_mutex> lock(correctionsMutex);
+    auto cacheIt = correctionCaches.find(name);
+    if (cacheIt != correctionCaches.end() && cacheIt->second.initialized) return cacheIt->second;
+  }
+  LoadCorrection(name);
+
+  // workers share the manager, so the first one to use a correction sets up its cache for all of them
+  lock_guard<mutex> loadingLock(loadingMutex);
+  CorrectionCache* cache;
+  {
+    unique_lock<shared_mutex> lock(correctionsMutex);
+    cache = &correctionCaches[name];
+  }
+  if (cache->initialized) return *cache;
+
+  auto extraArgs = GetExtraArgs(name);
+  cache->variations = GetScaleFactorVariations(extraArgs["variations"]);
+  if (withStatistical && extraArgs.count("statistical")) cache->statistical = extraArgs["statistical"];
+
+  if (applyDefault) cache->variationArgs.push_back(extraArgs["systematic"]);
+  if (applyVariations) {
+    cache->variationArgs.insert(cache->variationArgs.end(), cache->variations.begin(), cache->variations.end());
+    if (!cache->statistical.empty()) cache->variationArgs.push_back(cache->statistical);
+  }
+  cache->initialized = true;
+  return *cache;
+}
+
+bool ScaleFactorsManager::GetCacheKey(const CorrectionCache& cache, const vector<CorrectionArgType>& args, size_t firstObjectArg,
+                                      size_t nObjectArgs, uint64_t& key) {
+  if (!cache.binned || firstObjectArg + nObjectArgs > cache.edges.size()) return false;
+
+  key = 0;
+  uint64_t stride = 1;
+  for (size_t i = firstObjectArg; i < firstObjectArg + nObjectArgs; i++) {
+    const auto& edges = cache.edges[i];
+    if (edges.empty()) return false;
+
+    double value = numeric_limits<double>::quiet_NaN();
+    std::visit(
+        [&](const auto& arg) {
+          if constexpr (std::is_arithmetic_v<std::decay_t<decltype(arg)>>) value = arg;
+        },
+        args[i]);
+    if (std::isnan(value)) return false;
+
+    key += (upper_bound(edges.begin(), edges.end(), value) - edges.begin()) * stride;
+    stride *= edges.size() + 1;
+  }
+  return true;
+}
+
+void ScaleFactorsManager::EvaluateVariations(const string& name, CorrectionCache& cache, vector<CorrectionArgType>& args,
+                                             size_t variationArg, size_t firstObjectArg, size_t nObjectArgs,
+                                             vector<float>& values) {
+  uint64_t key;
+  bool cacheable = GetCacheKey(cache, args, firstObjectArg, nObjectArgs, key);
+  if (cacheable) {
+    shared_lock<shared_mutex> lock(cache.valuesMutex);
+    auto cached = cache.values.find(key);
+    if (cached != cache.values.end()) {
+      values = cached->second;
+      return;
+    }
+  }
+
+  values.clear();
+  for (auto& value : cache.variationArgs) {
+    args[variationArg] = value;
+    values.push_back(TryToEvaluate(name, args));
+  }
+  if (!cacheable) return;
+
+  // another worker may have filled the same bin in the meantime, with the same values
+  unique_lock<shared_mutex> lock(cache.valuesMutex);
+  cache.values.emplace(key, values);
+}
+
+void ScaleFactorsManager::EvaluateBatch(const string& name, vector<CorrectionArgType>& args, size_t variationArg, size_t etaArg,
+                                        bool absEta, const float* eta, const float* pt, size_t nObjects, bool applyDefault,
+                                        bool applyVariations, ScaleFactorsBatch& batch, bool withStatistical) {
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations, withStatistical);
+
+  if (batch.names.empty()) {
+    batch.names.push_back("systematic");
+    if (applyVariations) {
+      for (auto& variation : cache.variations) batch.names.push_back(name + "_" + variation);
+      if (!cache.statistical.empty()) {
+        batch.names.push_back(name + "_" + cache.statistical + "_up");
+        batch.names.push_back(name + "_" + cache.statistical + "_down");
+      }
+    }
+  }
+  size_t nNames = batch.names.size();
+  batch.nObjects = nObjects;
+  batch.values.resize(nNames * nObjects);
+
+  vector<float> values;
+  for (size_t iObject = 0; iObject < nObjects; iObject++) {
+    args[etaArg] = absEta ? (double)fabs(eta[iObject]) : (double)eta[iObject];
+    args[etaArg + 1] = (double)pt[iObject];
+    EvaluateVariations(name, cache, args, variationArg, etaArg, 2, values);
+
+    size_t iValue = 0;
+    float systematic = applyDefault ? values[iValue++] : 1.0;
+    batch.values[iObject] = systematic;
+    if (!applyVariations) continue;
+
+    size_t iName = 1;
+    for (size_t iVariation = 0; iVariation < cache.variations.size(); iVariation++) {
+      batch.values[iName++ * nObjects + iObject] = values[iValue++];
+    }
+    if (!cache.statistical.empty()) {
+      float statSF = values[iValue++];
+      batch.values[iName++ * nObjects + iObject] = systematic + statSF;
+      batch.values[iName++ * nObjects + iObject] = systematic - statSF;
+    }
+  }
+
+  batch.products.assign(nNames, 1.0);
+  for (size_t iName = 0; iName < nNames; iName++) {
+    for (size_t iObject = 0; iObject < nObjects; iObject++) batch.products[iName] *= batch.Get(iName, iObject);
+  }
+}
+
+void ScaleFactorsManager::FillNeutralBatch(size_t nObjects, ScaleFactorsBatch& batch) {
+  if (batch.names.size() != 1) batch.names = {"systematic"};
+  batch.nObjects = nObjects;
+  batch.values.assign(nObjects, 1.0);
+  batch.products.assign(1, 1.0);
+}
+
+map<string, float> ScaleFactorsBatch::GetProducts() const {
+  map<string, float> scaleFactors;
+  for (size_t iName = 0; iName < names.size(); iName++) scaleFactors[names[iName]] = products[iName];
+  return scaleFactors;
+}
+
 #ifdef USE_CORRECTIONLIB
+const CorrectionRef& ScaleFactorsManager::GetCorrection(const string& name) {
+  const CorrectionRef* correction = Find(corrections, name);
+  if (!correction) {
+    fatal() << "Correction " << name << " was not loaded -- is it defined in the scale_factors_config?" << endl;
+    exit(1);
+  }
+  return *correction;
+}
+
 float ScaleFactorsManager::EvaluateCorrectionArgs(const std::string& name, const vector<correction::Variable::Type>& args) {
+  const CorrectionRef& correction = GetCorrection(name);
   try {
-    return corrections[name]->evaluate(args);
+    return correction->evaluate(args);
   } catch (std::runtime_error& e) {
     std::string msg = e.what();
 
     if (msg.find("inputs") != std::string::npos) {
       fatal() << "Expected inputs:\n";
-      for (auto corr : corrections[name]->inputs()) fatal() << corr.name() << "\t" << corr.description() << "\n";
+      for (auto corr : correction->inputs()) fatal() << corr.name() << "\t" << corr.description() << "\n";
       exit(1);
     }
 
@@ -500,13 +896,14 @@ float ScaleFactorsManager::EvaluateCorrectionArgs(const std::string& name, const
 
     auto clampedArgs = args;
 
-    if (!boundsPerInput.count(name)) {
+    const auto* boundsPtr = Find(boundsPerInput, name);
+    if (!boundsPtr) {
       warn() << "No stored bounds for SF " << name << ". Returning SF=1.\n";
       return 1.0;
     }
 
-    const auto& bounds = boundsPerInput.at(name);
-    const auto& inputs = corrections[name]->inputs();
+    const auto& bounds = *boundsPtr;
+    const auto& inputs = correction->inputs();
 
     for (size_t i = 0; i < inputs.size(); ++i) {
       const std::string& varName = inputs[i].name();
@@ -531,7 +928,7 @@ float ScaleFactorsManager::EvaluateCorrectionArgs(const std::string& name, const
     }
 
     try {
-      return corrections[name]->evaluate(clampedArgs);
+      return correction->evaluate(clampedArgs);
     } catch (const std::exception& e2) {
       fatal() << "Clamped evaluation still failed. Original correction: " << name << " Error message: " << e2.what() << endl;
       ;
@@ -597,7 +994,8 @@ map<string, float> ScaleFactorsManager::GetCustomScaleFactorsForCategory(string
   bool applyVariations = ShouldApplyVariation(name);
 
   map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
+  auto extraArgs = GetExtraArgs(name);
+  if (applyDefault || applyVariations) LoadCorrection(name);
   if (!applyDefault) scaleFactors["systematic"] = 1.0;
   // handle empty category - needed to setup the scale factor names for the first event
   else if (category == "")
@@ -621,50 +1019,42 @@ map<string, float> ScaleFactorsManager::GetCustomScaleFactorsForCategory(string
 map<string, float> ScaleFactorsManager::GetCustomScaleFactors(string name, const vector<CorrectionArgType>& args) {
   bool applyDefault = ShouldApplyScaleFactor(name);
   bool applyVariations = ShouldApplyVariation(name);
+  if (!applyDefault && !applyVariations) return {{"systematic", 1.0}};
+
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations);
+  auto variation_args = args;
+  variation_args.push_back("");
+  vector<float> values;
+  EvaluateVariations(name, cache, variation_args, args.size(), 0, args.size(), values);
 
   map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else {
-    auto systematic_args = args;
-    systematic_args.push_back(extraArgs["systematic"]);
-    scaleFactors["systematic"] = TryToEvaluate(name, systematic_args);
-  }
+  size_t iValue = 0;
+  scaleFactors["systematic"] = applyDefault ? values[iValue++] : 1.0;
 
   if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    auto variation_args = args;
-    variation_args.push_back(variation);
-    scaleFactors[name + "_" + variation] = TryToEvaluate(name, variation_args);
-  }
+  for (auto& variation : cache.variations) scaleFactors[name + "_" + variation] = values[iValue++];
   return scaleFactors;
 }
 
 map<string, float> ScaleFactorsManager::GetDimuonScaleFactors(string name, const vector<CorrectionArgType>& args) {
   bool applyDefault = ShouldApplyScaleFactor(name);
   bool applyVariations = ShouldApplyVariation(name);
+  if (!applyDefault && !applyVariations) return {{"systematic", 1.0}};
+
+  auto& cache = GetCorrectionCache(name, applyDefault, applyVariations);
+  auto variation_args = args;
+  variation_args.push_back("");
+  vector<float> values;
+  EvaluateVariations(name, cache, variation_args, args.size(), 0, args.size(), values);
 
   map<string, float> scaleFactors;
-  auto extraArgs = correctionsExtraArgs[name];
-  if (!applyDefault)
-    scaleFactors["systematic"] = 1.0;
-  else {
-    auto systematic_args = args;
-    systematic_args.push_back(extraArgs["systematic"]);
-    scaleFactors["systematic"] = TryToEvaluate(name, systematic_args);
-  }
+  size_t iValue = 0;
+  scaleFactors["systematic"] = applyDefault ? values[iValue++] : 1.0;
 
   if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs["variations"]);
-  for (auto variation : variations) {
-    auto variation_args = args;
-    variation_args.push_back(variation);
-    scaleFactors[name + variation] = TryToEvaluate(name, variation_args);
-  }
+  for (auto& variation : cache.variations) scaleFactors[name + variation] = values[iValue++];
   return scaleFactors;
 }
 
@@ -681,14 +1071,16 @@ map<string, float> ScaleFactorsManager::GetJetEnergyCorrectionUncertainties(std:
   return scaleFactors;
 #else
   string name = "jecMC";
-  auto extraArgs = correctionsExtraArgs[name];
   if (!applyVariations) return scaleFactors;
+  LoadCorrection(name);
+  auto extraArgs = GetExtraArgs(name);
 
   vector<string> uncertainties = GetScaleFactorVariations(extraArgs["uncertainties"]);
   for (auto uncertainty : uncertainties) {
     string unc_name = name + "_" + uncertainty;
+    LoadCorrection(unc_name);
     vector<correction::Variable::Type> unc_inputs;
-    for (const correction::Variable& input : corrections[unc_name]->inputs()) {
+    for (const correction::Variable& input : GetCorrection(unc_name)->inputs()) {
       unc_inputs.push_back(inputArguments.at(input.name()));
     }
     float unc = TryToEvaluate(unc_name, unc_inputs);
@@ -718,14 +1110,15 @@ map<string, float> ScaleFactorsManager::GetJetEnergyCorrections(vector<string> j
   return scaleFactors;
 #else
   for (auto name : jecNames) {
+    LoadCorrection(name);
     vector<correction::Variable::Type> inputs;
-    if (compoundCorrections.count(name)) {
-      for (const correction::Variable& input : compoundCorrections[name]->inputs()) {
+    if (const CompoundCorrectionRef* compoundCorrection = Find(compoundCorrections, name)) {
+      for (const correction::Variable& input : (*compoundCorrection)->inputs()) {
         inputs.push_back(inputArguments.at(input.name()));
       }
-      scaleFactors[name] = compoundCorrections[name]->evaluate(inputs);
-    } else if (corrections.count(name)) {
-      for (const correction::Variable& input : corrections[name]->inputs()) {
+      scaleFactors[name] = (*compoundCorrection)->evaluate(inputs);
+    } else if (const CorrectionRef* correction = Find(corrections, name)) {
+      for (const correction::Variable& input : (*correction)->inputs()) {
         inputs.push_back(inputArguments.at(input.name()));
       }
       scaleFactors[name] = TryToEvaluate(name, inputs);
@@ -745,20 +1138,21 @@ map<string, float> ScaleFactorsManager::GetJetEnergyResolutionScaleFactorAndPtRe
   map<string, float> scaleFactors;
   scaleFactors["systematic"] = 1.0;
   scaleFactors["PtResolution"] = 1.0;
+  if (!applyDefault && !applyVariations) return scaleFactors;
 
-  if (corrections.find(name_sf) == corrections.end()) {
+  if (!IsCorrectionDefined(name_sf)) {
     if (applyDefault || applyVariations)
       warn() << "Requested bTag SF, which was not defined in the scale_factors_config: " << name_sf << endl;
     return scaleFactors;
   }
-  if (corrections.find(name_pt) == corrections.end()) {
+  if (!IsCorrectionDefined(name_pt)) {
     if (applyDefault || applyVariations)
       warn() << "Requested bTag SF, which was not defined in the scale_factors_config: " << name_pt << endl;
     return scaleFactors;
   }
 
-  auto extraArgs_sf = correctionsExtraArgs[name_sf];
-  auto extraArgs_pt = correctionsExtraArgs[name_pt];
+  auto extraArgs_sf = GetExtraArgs(name_sf);
+  auto extraArgs_pt = GetExtraArgs(name_pt);
 
   // Run 2 only use jet eta as input, but Run 3 alos need jet pT
   bool useJetPt =
@@ -772,24 +1166,21 @@ map<string, float> ScaleFactorsManager::GetJetEnergyResolutionScaleFactorAndPtRe
   args_sfs.push_back(jetEta);
   if (useJetPt)
     args_sfs.push_back(jetPt);
-  args_sfs.push_back(extraArgs_sf["systematic"]);
-  
+  args_sfs.push_back("");
+
+  auto& cache = GetCorrectionCache(name_sf, applyDefault, applyVariations);
+  vector<float> values;
+  EvaluateVariations(name_sf, cache, args_sfs, args_sfs.size() - 1, 0, args_sfs.size() - 1, values);
+  size_t iValue = 0;
+
   if (applyDefault) {
-    scaleFactors["systematic"] = TryToEvaluate(name_sf, args_sfs);
+    scaleFactors["systematic"] = values[iValue++];
     scaleFactors["PtResolution"] = TryToEvaluate(name_pt, {jetEta, jetPt, rho});
   }
 
   if (!applyVariations) return scaleFactors;
 
-  vector<string> variations = GetScaleFactorVariations(extraArgs_sf["variations"]);
-  for (auto variation : variations) {
-    vector<CorrectionArgType> args;
-    args.push_back(jetEta);
-    if (useJetPt)
-      args.push_back(jetPt);
-    args.push_back(variation);
-    scaleFactors[name_sf + "_" + variation] = TryToEvaluate(name_sf, args);
-  }
+  for (auto& variation : cache.variations) scaleFactors[name_sf + "_" + variation] = values[iValue++];
   return scaleFactors;
 }
 
@@ -799,8 +1190,9 @@ float ScaleFactorsManager::GetJetEnergyResolutionSmearingFactor(map<string, Corr
   return 1.0;
 #else
   string name = "jerMC_smear";
+  LoadCorrection(name);
   vector<correction::Variable::Type> inputs;
-  for (const correction::Variable& input : corrections[name]->inputs()) {
+  for (const correction::Variable& input : GetCorrection(name)->inputs()) {
     std::visit([&](const auto& value) { inputs.emplace_back(MakeCorrectionArg(value)); }, inputArguments.at(input.name()));
   }
   float factor = EvaluateCorrectionArgs(name, inputs);
@@ -808,7 +1200,17 @@ float ScaleFactorsManager::GetJetEnergyResolutionSmearingFactor(map<string, Corr
 #endif
 }
 
-bool ScaleFactorsManager::IsJetVetoMapDefined(string name) { return (corrections.find(name) != corrections.end()); }
+bool ScaleFactorsManager::IsJetVetoMapDefined(string name) { return IsCorrectionDefined(name); }
+
+map<string, string> ScaleFactorsManager::GetExtraArgs(const string& name) {
+  const auto* extraArgs = Find(correctionsExtraArgs, name);
+  return extraArgs ? *extraArgs : map<string, string>();
+}
+
+bool ScaleFactorsManager::IsCorrectionDefined(const string& name) {
+  LoadCorrection(name);
+  return Find(corrections, name) || Find(correctionTables, name);
+}
 
 bool ScaleFactorsManager::IsJetInBadRegion(string name, float eta, float phi) {
   if (!IsJetVetoMapDefined(name)) {
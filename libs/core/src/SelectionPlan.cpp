@@ -0,0 +1,141 @@
+//  SelectionPlan.cpp
+
+#include "SelectionPlan.hpp"
+
+using namespace std;
+
+namespace {
+template <typename T>
+void ApplyCut(const void *values, size_t nObjects, double min, double max, unsigned char *passes) {
+  const T *data = static_cast<const T *>(values);
+  // no branches in the loop, so that the compiler can vectorize it
+  for (size_t i = 0; i < nObjects; i++) {
+    double value = static_cast<double>(data[i]);
+    passes[i] &= (value >= min) & (value <= max);
+  }
+}
+
+void ApplyCut(const SelectionCut &cut, size_t nObjects, unsigned char *passes) {
+  const void *values = cut.column->Data();
+  switch (cut.column->type) {
+    case BranchType::kFloat: ApplyCut<Float_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kDouble: ApplyCut<Double_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kInt: ApplyCut<Int_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kUInt: ApplyCut<UInt_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kBool: ApplyCut<Bool_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kUChar: ApplyCut<UChar_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kChar: ApplyCut<Char_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kUShort: ApplyCut<UShort_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kShort: ApplyCut<Short_t>(values, nObjects, cut.min, cut.max, passes); break;
+    case BranchType::kULong64: ApplyCut<ULong64_t>(values, nObjects, cut.min, cut.max, passes); break;
+    default:
+      error() << "Unsupported type of branch " << cut.branchName << " in extra collection cuts" << endl;
+      break;
+  }
+}
+
+inline bool PassesCut(const shared_ptr<PhysicsObject> &physicsObject, const string &branchName, double min,
+                      double max) {
+  double value = physicsObject->GetAs<double>(branchName);
+  return value >= min && value <= max;
+}
+}  // namespace
+
+SelectionPlan::SelectionPlan(string name_, const ExtraCollection &description)
+    : name(name_), inputCollections(description.inputCollections) {
+  auto addCut = [&](const string &branchName, pair<float, float> range) {
+    // undefined cuts let all objects through
+    if (range.first == 0.0 && range.second == 0.0) {
+      warn() << "Undefined cuts for branch " << branchName << endl;
+      return;
+    }
+    cuts.push_back({branchName, {range.first, range.second}});
+  };
+
+  for (auto &[branchName, flag] : description.flags) addCut(branchName, {flag, flag});
+  for (auto &[branchName, range] : description.allCuts) addCut(branchName, range);
+}
+
+shared_ptr<PhysicsObjects> SelectionPlan::NewOutputCollection() {
+  if (!outputCollection || outputCollection.use_count() > 1) {
+    outputCollection = make_shared<PhysicsObjects>();
+  } else {
+    outputCollection->clear();
+    outputCollection->ChangeVisibleSize(0);
+  }
+  return outputCollection;
+}
+
+const vector<SelectionCut> &SelectionPlan::GetResolvedCuts(const ColumnarCollection *columns) {
+  for (auto &[resolvedColumns, cutsForColumns] : resolvedCuts) {
+    if (resolvedColumns == columns) return cutsForColumns;
+  }
+
+  vector<SelectionCut> cutsForColumns;
+  for (auto &[branchName, range] : cuts) {
+    cutsForColumns.push_back({branchName, columns->GetColumn(branchName), range.first, range.second});
+  }
+  resolvedCuts.push_back({columns, cutsForColumns});
+  return resolvedCuts.back().second;
+}
+
+void SelectionPlan::Select(const shared_ptr<PhysicsObjects> &input, const ColumnarCollection *inputColumns,
+                           PhysicsObjects &output) {
+  if (inputColumns) {
+    SelectRows(input, inputColumns, output);
+  } else {
+    SelectObjects(input, output);
+  }
+}
+
+void SelectionPlan::SelectRows(const shared_ptr<PhysicsObjects> &input, const ColumnarCollection *inputColumns,
+                               PhysicsObjects &output) {
+  size_t nObjects = input->size();
+  if (nObjects == 0) return;
+
+  const auto &cutsForColumns = GetResolvedCuts(inputColumns);
+  passes.assign(nObjects, 1);
+  for (auto &cut : cutsForColumns) {
+    if (cut.column) ApplyCut(cut, nObjects, passes.data());
+  }
+
+  for (size_t i = 0; i < nObjects; i++) {
+    if (!passes[i]) continue;
+    auto &physicsObject = input->at(i);
+
+    // variables which are not input branches (e.g. set by the app) are checked object by object
+    bool passesAll = true;
+    for (auto &cut : cutsForColumns) {
+      if (cut.column) continue;
+      passesAll = PassesCut(physicsObject, cut.branchName, cut.min, cut.max);
+      if (!passesAll) break;
+    }
+    if (passesAll) output.push_back(physicsObject);
+  }
+}
+
+void SelectionPlan::SelectObjects(const shared_ptr<PhysicsObjects> &input, PhysicsObjects &output) {
+  for (auto physicsObject : *input) {
+    bool passesAll = true;
+    auto columns = physicsObject->GetColumns();
+
+    if (columns) {
+      int row = physicsObject->GetRow();
+      for (auto &cut : GetResolvedCuts(columns)) {
+        if (cut.column) {
+          double value = ReadValueAs<double>(cut.column->type, cut.column->Data(), row);
+          passesAll = value >= cut.min && value <= cut.max;
+        } else {
+          passesAll = PassesCut(physicsObject, cut.branchName, cut.min, cut.max);
+        }
+        if (!passesAll) break;
+      }
+    } else {
+      for (auto &[branchName, range] : cuts) {
+        passesAll = PassesCut(physicsObject, branchName, range.first, range.second);
+        if (!passesAll) break;
+      }
+    }
+    if (passesAll) output.push_back(physicsObject);
+  }
+}
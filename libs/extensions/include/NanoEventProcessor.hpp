@@ -10,12 +10,14 @@
 #include "EventProcessor.hpp"
 #include "NanoMuon.hpp" 
 #include "CutFlowManager.hpp"
+#include "ScaleFactorsManager.hpp"
 
 class NanoEventProcessor {
  public:
   NanoEventProcessor();
 
-  bool PassesEventCuts(const std::shared_ptr<NanoEvent> event, std::shared_ptr<CutFlowManager> cutFlowManager);
+  bool PassesEventCuts(const std::shared_ptr<NanoEvent> event, std::shared_ptr<CutFlowManager> cutFlowManager,
+                       const std::vector<float> &variationWeights = {});
 
   float GetGenWeight(const std::shared_ptr<NanoEvent> event);
   std::map<std::string, float> GetL1PreFiringWeight(const std::shared_ptr<NanoEvent> event, std::string name);
@@ -80,6 +82,50 @@ class NanoEventProcessor {
   std::string eventIDBranchName;
   std::string datasetName;
 
+  // read once in the constructor, so that the config isn't looked up for every event
+  std::map<std::string, std::vector<bool>> applyScaleFactors;
+  std::map<std::string, std::map<std::string, std::string>> scaleFactors;
+  std::string applyScaleFactorsError, scaleFactorsError;
+
+  // SF inputs and outputs of all objects in the event, grouped by the correction they need and reused between events
+  struct BTaggingFlavour {
+    std::string correctionName, efficiencyName, suffix;
+    std::vector<float> eta, pt;
+    ScaleFactorsBatch batch;
+    std::vector<size_t> rows;  // row in the SF batch for each of bTaggingWeightNames (0 = systematic if not defined)
+  };
+  struct BTaggingJet {
+    size_t flavour, index;
+    bool isBJet;
+    float efficiency;
+  };
+  BTaggingFlavour bTaggingFlavours[3] = {{"bTaggingMedium", "bTaggingEfficiency", ""},
+                                         {"bTaggingMedium_cjet", "cTaggingEfficiency", "_cjet"},
+                                         {"bTaggingMedium_qjet", "qTaggingEfficiency", "_qjet"}};
+  std::vector<BTaggingJet> bTaggingJets;
+  std::vector<std::string> bTaggingWeightNames;
+  std::vector<float> bTaggingWeights;
+
+  struct MuonIDGroup {
+    std::string idName, isoName;
+    std::vector<float> eta, pt;
+    ScaleFactorsBatch idBatch, isoBatch;
+  };
+  MuonIDGroup muonIDGroups[2] = {{"muonIDTight", "muonIsoTight"}, {"muonIDLoose", "muonIsoLoose"}};
+  std::vector<std::pair<int, size_t>> muonGroupIndices;  // group of each muon (-1 for DSA) and its index in the group
+  std::vector<float> muonEta, muonPt;                     // all non-DSA muons
+  ScaleFactorsBatch muonRecoBatch;
+  std::vector<std::string> muonWeightNames;
+  std::map<std::string, size_t> muonWeightIndices;
+  std::map<std::string, std::vector<size_t>> muonWeightRows;  // for each correction, index of each of its batch rows
+  std::vector<float> muonWeights, muonFactors;
+
+  std::vector<float> jetEta, jetPt;
+  ScaleFactorsBatch puJetIDBatch;
+
+  void SetupBTaggingWeightNames();
+  const std::vector<size_t>& GetMuonWeightRows(const std::string& correctionName, const ScaleFactorsBatch& batch);
+
   // Updates up and down variation weights in weightsToUpdate with the systematic weight in alreadyUpdatedWeights, and skips any up/down variations in alreadyUpdatedWeights.
   void UpdateVariationWeights(std::map<std::string, float>& weightsToUpdate, std::map<std::string, float>& alreadyUpdatedWeights);
 
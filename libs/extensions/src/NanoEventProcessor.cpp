@@ -46,6 +46,16 @@ NanoEventProcessor::NanoEventProcessor() {
   } catch (const Exception &e) {
     warn() << "datasetName not specified in config -- is needed for b-tagging SFs" << endl;
   }
+  try {
+    config.GetMap("applyScaleFactors", applyScaleFactors);
+  } catch (const Exception &e) {
+    applyScaleFactorsError = e.what();
+  }
+  try {
+    config.GetMap("scaleFactors", scaleFactors);
+  } catch (const Exception &e) {
+    scaleFactorsError = e.what();
+  }
 }
 
 float NanoEventProcessor::GetGenWeight(const std::shared_ptr<NanoEvent> event) {
@@ -75,12 +85,7 @@ map<string, float> NanoEventProcessor::GetL1PreFiringWeight(const std::shared_pt
     return {{"systematic", 1.0}};
   }
 
-  auto& config = ConfigManager::GetInstance();
-
-  map<string, vector<bool>> applyScaleFactors;
-  try {
-    config.GetMap("applyScaleFactors", applyScaleFactors);
-  } catch (const Exception&) {
+  if (!applyScaleFactorsError.empty()) {
     warn() << "Couldn't read applyScaleFactors from config -- will assume L1PreFiringWeight SF = 1.0." << endl;
     return {{"systematic", 1.0}};
   }
@@ -89,11 +94,8 @@ map<string, float> NanoEventProcessor::GetL1PreFiringWeight(const std::shared_pt
     return {{"systematic", 1.0}};
   }
 
-  map<string, map<string, string>> scaleFactors;
-  try {
-    config.GetMap("scaleFactors", scaleFactors);
-  } catch (const Exception& e) {
-    warn() << "Couldn't read scaleFactors from config (" << e.what()
+  if (!scaleFactorsError.empty()) {
+    warn() << "Couldn't read scaleFactors from config (" << scaleFactorsError
            << ") -- will assume L1PreFiringWeight SF = 1.0." << endl;
     return {{"systematic", 1.0}};
   }
@@ -102,11 +104,11 @@ map<string, float> NanoEventProcessor::GetL1PreFiringWeight(const std::shared_pt
     return {{"systematic", 1.0}};
   }
 
-  auto extraArgs = scaleFactors[name];
+  auto extraArgs = scaleFactors.at(name);
 
-  weights["systematic"] = applyScaleFactors[name][0] ? event->Get(name + "_" + extraArgs["systematic"]) : 1.0;
+  weights["systematic"] = applyScaleFactors.at(name)[0] ? event->Get(name + "_" + extraArgs["systematic"]) : 1.0;
 
-  if (!applyScaleFactors[name][1]) return weights;
+  if (!applyScaleFactors.at(name)[1]) return weights;
 
   stringstream ss(extraArgs["variations"]);
   string variation;
@@ -136,12 +138,23 @@ map<string, float> NanoEventProcessor::GetMuonTriggerScaleFactors(const shared_p
 
 map<string, float> NanoEventProcessor::GetMediumBTaggingScaleFactors(const shared_ptr<NanoEvent> event, const shared_ptr<NanoJets> jets) {
   map<string, float> weights;
-  bool firstIteration = true;
   if (datasetName.empty())
     return weights;
+  if (jets->size() == 0) return {{"systematic", 1.0}};
+
+  auto& scaleFactorsManager = ScaleFactorsManager::GetInstance();
+  if (!scaleFactorsManager.ShouldApplyScaleFactor("bTagging") && !scaleFactorsManager.ShouldApplyVariation("bTagging"))
+    return {{"systematic", 1.0}};
 
   auto allBJets = event->GetCollection("GoodMediumBtaggedJets");
 
+  // jets are grouped by flavour, so that SFs of each flavour are evaluated for all its jets at once
+  for (auto& flavour : bTaggingFlavours) {
+    flavour.eta.clear();
+    flavour.pt.clear();
+  }
+  bTaggingJets.clear();
+
   for (auto jet : *jets) {
     bool isBJet = false;
     for (auto bJet : *allBJets) {
@@ -150,79 +163,184 @@ map<string, float> NanoEventProcessor::GetMediumBTaggingScaleFactors(const share
         break;
       }
     }
-    map<string, float> weights_ = jet->GetBtaggingScaleFactors("bTaggingMedium", isBJet, datasetName);
-    if (firstIteration) {
-      weights = weights_;
-      firstIteration = false;
-      continue;
-    }
-    for (auto& [name, weight] : weights_) {
-      weights[name] *= weight;
+    int hadronFlavour = abs(jet->GetAs<int>("hadronFlavour"));
+    size_t iFlavour = hadronFlavour == 5 ? 0 : (hadronFlavour == 4 ? 1 : 2);
+    auto& flavour = bTaggingFlavours[iFlavour];
+
+    float efficiency = scaleFactorsManager.GetJetTagEfficiency(flavour.efficiencyName, datasetName, jet->GetPtSmeared());
+    bTaggingJets.push_back({iFlavour, flavour.pt.size(), isBJet, efficiency});
+    flavour.eta.push_back(jet->GetAbsEta());
+    flavour.pt.push_back(jet->GetPtSmeared());
+  }
+
+  for (auto& flavour : bTaggingFlavours) {
+    scaleFactorsManager.GetBTagScaleFactors(flavour.correctionName, flavour.eta.data(), flavour.pt.data(), flavour.pt.size(),
+                                            flavour.batch);
+  }
+  if (bTaggingWeightNames.empty()) SetupBTaggingWeightNames();
+
+  bTaggingWeights.assign(bTaggingWeightNames.size(), 1.0);
+  for (auto& jet : bTaggingJets) {
+    auto& flavour = bTaggingFlavours[jet.flavour];
+    for (size_t iName = 0; iName < bTaggingWeightNames.size(); iName++) {
+      float weight = flavour.batch.Get(flavour.rows[iName], jet.index);
+      if (jet.isBJet)
+        bTaggingWeights[iName] *= weight;
+      else if (jet.efficiency == 1)  // Avoiding unstable efficiencies from low stat datasets.
+        bTaggingWeights[iName] *= 1.0;
+      else
+        bTaggingWeights[iName] *= (1 - weight * jet.efficiency) / (1 - jet.efficiency);
     }
   }
-  if (firstIteration) return {{"systematic", 1.0}};
+  for (size_t iName = 0; iName < bTaggingWeightNames.size(); iName++) weights[bTaggingWeightNames[iName]] = bTaggingWeights[iName];
   return weights;
 }
 
-map<string, float> NanoEventProcessor::GetPUJetIDScaleFactors(const shared_ptr<NanoJets> jets) {
-  map<string, float> weights;
-  bool firstIteration = true;
-  for (auto jet : *jets) {
-    map<string, float> weights_ = jet->GetPUJetIDScaleFactors("PUjetIDtight");
-    if (firstIteration) {
-      weights = weights_;
-      firstIteration = false;
-      continue;
+void NanoEventProcessor::SetupBTaggingWeightNames() {
+  // names without the flavour suffix, so that c and light jets contribute to the same weights as b jets
+  vector<vector<string>> flavourNames(3);
+  for (size_t iFlavour = 0; iFlavour < 3; iFlavour++) {
+    string suffix = bTaggingFlavours[iFlavour].suffix;
+    for (string name : bTaggingFlavours[iFlavour].batch.names) {
+      size_t pos = suffix.empty() ? string::npos : name.find(suffix);
+      if (pos != string::npos) name.erase(pos, suffix.size());
+      flavourNames[iFlavour].push_back(name);
+      if (find(bTaggingWeightNames.begin(), bTaggingWeightNames.end(), name) == bTaggingWeightNames.end())
+        bTaggingWeightNames.push_back(name);
     }
-    for (auto& [name, weight] : weights_) {
-      weights[name] *= weight;
+  }
+  for (size_t iFlavour = 0; iFlavour < 3; iFlavour++) {
+    auto& names = flavourNames[iFlavour];
+    auto& rows = bTaggingFlavours[iFlavour].rows;
+    for (auto& name : bTaggingWeightNames) {
+      auto row = find(names.begin(), names.end(), name);
+      rows.push_back(row == names.end() ? 0 : row - names.begin());
     }
   }
-  return weights;
+}
+
+map<string, float> NanoEventProcessor::GetPUJetIDScaleFactors(const shared_ptr<NanoJets> jets) {
+  if (jets->size() == 0) return {};
+
+  jetEta.clear();
+  jetPt.clear();
+  for (auto jet : *jets) {
+    // PU jet ID only applied to low pT jets with pT < 50 GeV, others have SF = 1
+    if (jet->GetPtSmeared() > 50) continue;
+    jetEta.push_back(jet->GetEta());
+    jetPt.push_back(jet->GetPtSmeared());
+  }
+  auto& scaleFactorsManager = ScaleFactorsManager::GetInstance();
+  scaleFactorsManager.GetPUJetIDScaleFactors("PUjetIDtight", jetEta.data(), jetPt.data(), jetPt.size(), puJetIDBatch);
+  return puJetIDBatch.GetProducts();
 }
 
 map<string, float> NanoEventProcessor::GetMuonScaleFactors(const std::shared_ptr<NanoMuons> muonCollection) {
   map<string, float> weights;
-  bool firstIteration = true;
-  for (auto muon : *muonCollection) {
-    if (firstIteration) {
-      auto weights_loose = muon->GetEmptyScaleFactors("muonIDLoose", "muonIsoLoose", "muonReco", year);
-      auto weights_tight = muon->GetEmptyScaleFactors("muonIDTight", "muonIsoTight", "muonReco", year);
-      auto weights_dsa = muon->GetEmptyDSAScaleFactors("dsamuonID", "dsamuonReco_cosmic");
-      for (auto& [name, weight] : weights_loose) {
-        weights[name] = 1.0;
-      }
-      for (auto& [name, weight] : weights_tight) {
-        weights[name] = 1.0;
-      }
-      for (auto& [name, weight] : weights_dsa) {
-        weights[name] = 1.0;
-      }
-      firstIteration = false;
+  if (muonCollection->size() == 0) return weights;
+
+  if (muonWeightNames.empty()) {
+    auto muon = (*muonCollection)[0];
+    auto weights_loose = muon->GetEmptyScaleFactors("muonIDLoose", "muonIsoLoose", "muonReco", year);
+    auto weights_tight = muon->GetEmptyScaleFactors("muonIDTight", "muonIsoTight", "muonReco", year);
+    auto weights_dsa = muon->GetEmptyDSAScaleFactors("dsamuonID", "dsamuonReco_cosmic");
+    for (auto& [name, weight] : weights_loose) weights[name] = 1.0;
+    for (auto& [name, weight] : weights_tight) weights[name] = 1.0;
+    for (auto& [name, weight] : weights_dsa) weights[name] = 1.0;
+    for (auto& [name, weight] : weights) {
+      muonWeightIndices[name] = muonWeightNames.size();
+      muonWeightNames.push_back(name);
     }
+  }
 
+  // muons are grouped by ID, so that SFs of each group are evaluated for all its muons at once
+  for (auto& group : muonIDGroups) {
+    group.eta.clear();
+    group.pt.clear();
+  }
+  muonGroupIndices.clear();
+  muonEta.clear();
+  muonPt.clear();
+  for (auto muon : *muonCollection) {
     if (muon->IsDSA()) {
-      auto weights_dsa = muon->GetDSAScaleFactors("dsamuonID", "dsamuonReco_cosmic");
-      for (auto& [name, weight] : weights_dsa) weights[name] *= weight;
-      // update all other variations with new systematic
-      UpdateVariationWeights(weights, weights_dsa);
+      muonGroupIndices.push_back({-1, 0});
+      continue;
+    }
+    int iGroup = muon->IsTight() ? 0 : 1;
+    auto& group = muonIDGroups[iGroup];
+    muonGroupIndices.push_back({iGroup, group.pt.size()});
+    group.eta.push_back(muon->GetEta());
+    group.pt.push_back(muon->GetPt());
+    muonEta.push_back(muon->GetEta());
+    muonPt.push_back(muon->GetPt());
+  }
+
+  // No Muon Reco SF for Run 3
+  bool hasRecoSF = year == "2016preVFP" || year == "2016postVFP" || year == "2017" || year == "2018";
+
+  auto& scaleFactorsManager = ScaleFactorsManager::GetInstance();
+  for (auto& group : muonIDGroups) {
+    size_t nMuons = group.pt.size();
+    scaleFactorsManager.GetMuonScaleFactors(group.idName, group.eta.data(), group.pt.data(), nMuons, group.idBatch);
+    scaleFactorsManager.GetMuonScaleFactors(group.isoName, group.eta.data(), group.pt.data(), nMuons, group.isoBatch);
+  }
+  // reco SFs are the same for both IDs, so they're evaluated for all non-DSA muons together
+  const ScaleFactorsBatch* recoBatch = nullptr;
+  if (hasRecoSF) {
+    scaleFactorsManager.GetMuonScaleFactors("muonReco", muonEta.data(), muonPt.data(), muonPt.size(), muonRecoBatch);
+    recoBatch = &muonRecoBatch;
+  }
+
+  // each muon multiplies its own variations, and all the other weights with its systematic
+  muonWeights.assign(muonWeightNames.size(), 1.0);
+  size_t recoIndex = 0;
+  for (size_t iMuon = 0; iMuon < muonGroupIndices.size(); iMuon++) {
+    auto [iGroup, index] = muonGroupIndices[iMuon];
+
+    if (iGroup < 0) {
+      auto weights_dsa = (*muonCollection)[iMuon]->GetDSAScaleFactors("dsamuonID", "dsamuonReco_cosmic");
+      muonFactors.assign(muonWeightNames.size(), weights_dsa["systematic"]);
+      for (auto& [name, weight] : weights_dsa) {
+        if (muonWeightIndices.count(name)) muonFactors[muonWeightIndices[name]] = weight;
+      }
     } else {
-      if (muon->IsTight()) {
-        auto weights_tight = muon->GetScaleFactors("muonIDTight", "muonIsoTight", "muonReco", year);
-        for (auto& [name, weight] : weights_tight) weights[name] *= weight;
-        // update all other variations with new systematic
-        UpdateVariationWeights(weights, weights_tight);
-      } else {
-        auto weights_loose = muon->GetScaleFactors("muonIDLoose", "muonIsoLoose", "muonReco", year);
-        for (auto& [name, weight] : weights_loose) weights[name] *= weight;
-        // update all other variations with new systematic
-        UpdateVariationWeights(weights, weights_loose);
+      auto &idBatch = muonIDGroups[iGroup].idBatch, &isoBatch = muonIDGroups[iGroup].isoBatch;
+      float recoSF = recoBatch ? recoBatch->Get(0, recoIndex) : 1.0;
+      float idSF = idBatch.Get(0, index);
+      float isoSF = isoBatch.Get(0, index);
+      muonFactors.assign(muonWeightNames.size(), recoSF * idSF * isoSF);
+
+      if (recoBatch) {
+        auto& recoRows = GetMuonWeightRows("muonReco", *recoBatch);
+        for (size_t row = 1; row < recoRows.size(); row++) {
+          if (recoRows[row] != string::npos) muonFactors[recoRows[row]] = recoBatch->Get(row, recoIndex) * idSF * isoSF;
+        }
+      }
+      auto& idRows = GetMuonWeightRows(muonIDGroups[iGroup].idName, idBatch);
+      for (size_t row = 1; row < idRows.size(); row++) {
+        if (idRows[row] != string::npos) muonFactors[idRows[row]] = recoSF * idBatch.Get(row, index) * isoSF;
       }
+      auto& isoRows = GetMuonWeightRows(muonIDGroups[iGroup].isoName, isoBatch);
+      for (size_t row = 1; row < isoRows.size(); row++) {
+        if (isoRows[row] != string::npos) muonFactors[isoRows[row]] = recoSF * idSF * isoBatch.Get(row, index);
+      }
+      recoIndex++;
     }
+    for (size_t iName = 0; iName < muonWeightNames.size(); iName++) muonWeights[iName] *= muonFactors[iName];
   }
+  for (size_t iName = 0; iName < muonWeightNames.size(); iName++) weights[muonWeightNames[iName]] = muonWeights[iName];
   return weights;
 }
 
+const vector<size_t>& NanoEventProcessor::GetMuonWeightRows(const string& correctionName, const ScaleFactorsBatch& batch) {
+  auto& rows = muonWeightRows[correctionName];
+  if (rows.size() == batch.names.size()) return rows;
+
+  rows.clear();
+  for (auto& name : batch.names) rows.push_back(muonWeightIndices.count(name) ? muonWeightIndices[name] : string::npos);
+  return rows;
+}
+
 void NanoEventProcessor::UpdateVariationWeights(map<string, float>& weightsToUpdate, map<string, float>& alreadyUpdatedWeights) {
   for (auto& [name, weight] : weightsToUpdate) {
     if (name == "systematic") {
@@ -322,7 +440,8 @@ float NanoEventProcessor::PropagateMET(const shared_ptr<NanoEvent> event, float
   return sqrt(newMetPx * newMetPx + newMetPy * newMetPy);
 }
 
-bool NanoEventProcessor::PassesEventCuts(const shared_ptr<NanoEvent> event, shared_ptr<CutFlowManager> cutFlowManager) {
+bool NanoEventProcessor::PassesEventCuts(const shared_ptr<NanoEvent> event, shared_ptr<CutFlowManager> cutFlowManager,
+                                         const vector<float>& variationWeights) {
   for (auto& [cutName, cutValues] : eventCuts) {
     if (cutName.substr(0, 5) != "nano_") continue;
 
@@ -338,9 +457,9 @@ bool NanoEventProcessor::PassesEventCuts(const shared_ptr<NanoEvent> event, shar
       continue;
     }
 
-    if (cutFlowManager) cutFlowManager->UpdateCutFlow(cutName);
+    if (cutFlowManager) cutFlowManager->UpdateCutFlow(cutName, "", variationWeights);
   }
-  if (!eventProcessor->PassesEventCuts(event->GetEvent(), cutFlowManager)) return false;
+  if (!eventProcessor->PassesEventCuts(event->GetEvent(), cutFlowManager, variationWeights)) return false;
 
   return true;
 }
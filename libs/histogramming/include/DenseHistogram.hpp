@@ -0,0 +1,105 @@
+//  DenseHistogram.hpp
+
+#ifndef DenseHistogram_hpp
+#define DenseHistogram_hpp
+
+#include "Helpers.hpp"
+
+/// Fixed binning of a histogram axis, with uniform or variable bin widths
+struct DenseAxis {
+  DenseAxis() = default;
+  DenseAxis(const TAxis *axis);
+
+  int nBins = 0;
+  double min = 0, max = 0;
+  std::vector<double> edges;  // only set for variable bin widths
+
+  /// Same as TAxis::FindBin(): 0 for underflow, nBins+1 for overflow and NaN
+  inline int FindBin(double value) const {
+    if (value < min) return 0;
+    if (!(value < max)) return nBins + 1;
+    if (edges.empty()) return 1 + int(nBins * (value - min) / (max - min));
+    return std::upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+  }
+
+  /// Finds bins for n values at once
+  inline void FindBins(const float *values, size_t n, int *bins) const {
+    if (edges.empty()) {
+      // branchless, so that the compiler can vectorize it
+      for (size_t i = 0; i < n; i++) {
+        double value = values[i];
+        bool underflow = value < min;
+        bool inRange = !underflow && value < max;
+        double position = nBins * ((inRange ? value : min) - min) / (max - min);
+        bins[i] = underflow ? 0 : (inRange ? 1 + int(position) : nBins + 1);
+      }
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        bins[i] = std::upper_bound(edges.begin(), edges.end(), (double)values[i]) - edges.begin();
+      }
+    }
+  }
+};
+
+/// 1D or 2D histogram with contiguous bin contents and sums of squared weights, filled during the event loop instead
+/// of a TH1D/TH2D. It keeps exactly what ROOT would (contents, sumw2, entries and statistics, accumulated in the same
+/// order), so the ROOT histogram it's copied to in the end is the same as if it was filled directly.
+class DenseHistogram {
+ public:
+  /// Binning is taken from the given TH1D or TH2D, which is not modified
+  DenseHistogram(const TH1 *binningHistogram);
+
+  inline void Fill(double value, double weight) {
+    int bin = xAxis.FindBin(value);
+    AddToBin(bin, bin >= 1 && bin <= xAxis.nBins, weight, value, 0);
+  }
+
+  inline void Fill(double valueX, double valueY, double weight) {
+    int binX = xAxis.FindBin(valueX);
+    int binY = yAxis.FindBin(valueY);
+    bool inRange = binX >= 1 && binX <= xAxis.nBins && binY >= 1 && binY <= yAxis.nBins;
+    AddToBin(binX + (xAxis.nBins + 2) * binY, inRange, weight, valueX, valueY);
+  }
+
+  /// Fills a 1D histogram with n values whose bins are already known. Each value is weighted with
+  /// weight * valueWeights[i] (or just weight if valueWeights is nullptr).
+  void FillBins(const int *bins, const float *values, const float *valueWeights, double weight, size_t n);
+
+  void Add(const DenseHistogram &other);
+
+  /// Overwrites contents, errors, entries and statistics of a ROOT histogram with the same binning
+  void CopyTo(TH1 *histogram) const;
+
+  inline bool Is2D() const { return is2D; }
+  inline const DenseAxis &GetXaxis() const { return xAxis; }
+  inline const DenseAxis &GetYaxis() const { return yAxis; }
+
+ private:
+  DenseAxis xAxis, yAxis;
+  bool is2D;
+
+  std::vector<double> contents;
+  std::vector<double> sumw2;
+  double stats[7] = {0};  // sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy (like TH2, the last 3 unused in 1D)
+  double entries = 0;
+  bool weighted = false;  // ROOT only stores sumw2 once a weight other than 1 was used
+
+  inline void AddToBin(int bin, bool inRange, double weight, double x, double y) {
+    contents[bin] += weight;
+    sumw2[bin] += weight * weight;
+    entries++;
+    if (weight != 1) weighted = true;
+
+    // like in ROOT, under- and overflows don't count for statistics
+    if (!inRange) return;
+    stats[0] += weight;
+    stats[1] += weight * weight;
+    stats[2] += weight * x;
+    stats[3] += weight * x * x;
+    stats[4] += weight * y;
+    stats[5] += weight * y * y;
+    stats[6] += weight * x * y;
+  }
+};
+
+#endif /* DenseHistogram_hpp */
@@ -0,0 +1,102 @@
+//  HistogramHandle.hpp
+
+#ifndef HistogramHandle_hpp
+#define HistogramHandle_hpp
+
+#include "DenseHistogram.hpp"
+#include "Helpers.hpp"
+#include "MultiWeightHistogram.hpp"
+#include "SparseHistogram.hpp"
+
+/// Current event weights: the default one first, then SF variations in the order they were set up in
+struct HistogramWeights {
+  std::vector<std::string> names = {"default"};
+  std::vector<float> values = {1.0};
+  std::vector<char> isSet = {true};  // variations missing in the current event are not filled
+};
+
+/// A histogram together with its SF variations (all weights except the default one, in the same order)
+struct HistogramEntry {
+  std::string name;
+  DenseHistogram *hist1D = nullptr;
+  DenseHistogram *hist2D = nullptr;
+  MultiWeightHistogram *variations = nullptr;
+  SparseHistogram *sparse = nullptr;
+  bool filled = false;
+  std::vector<int> bins;  // buffer for FillN()
+
+  /// Fills hist1D and its variations with n values, each weighted with the event weight times its valueWeight
+  inline void FillN(const float *values, const float *valueWeights, size_t n, const HistogramWeights &weights) {
+    if (n == 0) return;
+    filled = true;
+    bins.resize(n);
+    hist1D->GetXaxis().FindBins(values, n, bins.data());
+    hist1D->FillBins(bins.data(), values, valueWeights, weights.values[0], n);
+    if (variations) variations->FillBins(bins.data(), values, valueWeights, n, &weights.values[1], &weights.isSet[1]);
+  }
+
+  [[noreturn]] void ThrowMissing(std::string type) const {
+    fatal() << "Couldn't find key: " << name << " in " << type << " histograms map" << std::endl;
+    exit(1);
+  }
+};
+
+/// Direct access to a histogram booked by HistogramsHandler, created once with HistogramsHandler::GetHandle().
+/// Filling through the handle doesn't involve any name lookups: it fills the nominal histogram and all SF variations
+/// in a single pass. It stays valid for the whole lifetime of the HistogramsHandler.
+///
+///   auto muonPt = histogramsHandler->GetHandle("Muon_pt");   // before the event loop
+///   muonPt.Fill(muon->GetAs<float>("pt"));                    // in the event loop
+class HistogramHandle {
+ public:
+  HistogramHandle() = default;
+  HistogramHandle(HistogramEntry *entry_, const HistogramWeights *weights_) : entry(entry_), weights(weights_) {}
+
+  inline void Fill(double value) {
+    if (!entry->hist1D) entry->ThrowMissing("1D");
+    entry->hist1D->Fill(value, weights->values[0]);
+    entry->filled = true;
+    if (entry->variations) entry->variations->Fill(value, &weights->values[1], &weights->isSet[1]);
+  }
+
+  inline void Fill(double valueX, double valueY) {
+    if (!entry->hist2D && entry->sparse && entry->sparse->GetNdimensions() == 2) {
+      double values[2] = {valueX, valueY};
+      entry->sparse->Fill(values, weights->values[0]);
+      entry->filled = true;
+      return;
+    }
+    if (!entry->hist2D) entry->ThrowMissing("2D");
+    entry->hist2D->Fill(valueX, valueY, weights->values[0]);
+    entry->filled = true;
+    if (entry->variations) entry->variations->Fill(valueX, valueY, &weights->values[1], &weights->isSet[1]);
+  }
+
+  /// Fills a sparse histogram with one value per axis
+  inline void Fill(const std::vector<double> &values) {
+    if (!entry->sparse) entry->ThrowMissing("sparse");
+    if (values.size() != entry->sparse->GetNdimensions()) {
+      fatal() << "Filling sparse histogram " << entry->name << " with " << values.size() << " values, but it has ";
+      fatal() << entry->sparse->GetNdimensions() << " axes" << std::endl;
+      exit(1);
+    }
+    entry->sparse->Fill(values.data(), weights->values[0]);
+    entry->filled = true;
+  }
+
+  /// Fills a 1D histogram with n values at once, e.g. a variable of all objects in a collection. Bins are found for all
+  /// values first and then filled in one go. valueWeights multiply the event weight and can be nullptr.
+  inline void FillN(const float *values, const float *valueWeights, size_t n) {
+    if (!entry->hist1D) entry->ThrowMissing("1D");
+    entry->FillN(values, valueWeights, n, *weights);
+  }
+
+  inline bool IsValid() const { return entry != nullptr; }
+  inline const std::string &GetName() const { return entry->name; }
+
+ private:
+  HistogramEntry *entry = nullptr;
+  const HistogramWeights *weights = nullptr;
+};
+
+#endif /* HistogramHandle_hpp */
@@ -22,10 +22,17 @@ class HistogramsFiller {
  private:
   std::shared_ptr<HistogramsHandler> histogramsHandler;
   std::map<std::string, HistogramParams> defaultHistVariables;
+  std::vector<std::pair<HistogramParams, HistogramHandle>> defaultHistograms;
+  std::vector<float> columnValues;  // buffer for input branches of types other than float
   std::string weightsBranchName;
 
   std::map<std::string, std::string> defaultCollectionsTypes;
 
+  /// Fills the histogram with a variable of all objects at once, if they're rows of an input collection's columns.
+  /// Returns false if the collection can't be filled this way.
+  bool FillFromColumns(const std::shared_ptr<Event> event, const std::shared_ptr<PhysicsObjects> collection,
+                       const HistogramParams &params, HistogramHandle &histogram);
+
   template <typename T>
   float GetValue(std::shared_ptr<T> object, std::string branchName);
 };
@@ -7,6 +7,7 @@
 
 #include "Event.hpp"
 #include "Helpers.hpp"
+#include "HistogramHandle.hpp"
 
 typedef std::pair<std::string,std::string> HistNames;
 
@@ -17,34 +18,54 @@ class HistogramsHandler {
 
   void SetEventWeights(std::map<std::string,float> weights);
 
-  void Fill(std::string name, double value);
-  void Fill(std::string name, double valueX, double valueY);
+  /// Returns a handle to fill a histogram defined in the config without looking it up by name in every event
+  HistogramHandle GetHandle(const std::string &name);
 
-  void SetHistogram1D(HistNames names, TH1D *histogram) { histograms1D[names] = histogram; }
-  TH1D* GetHistogram1D(HistNames names) { return histograms1D[names]; }
-  std::map<HistNames, TH1D*> GetHistograms1D() { return histograms1D; }
-  std::map<HistNames, TH2D*> GetHistograms2D() { return histograms2D; }
+  void Fill(const std::string &name, double value) { GetHandle(name).Fill(value); }
+  void Fill(const std::string &name, double valueX, double valueY) { GetHandle(name).Fill(valueX, valueY); }
+  void Fill(const std::string &name, const std::vector<double> &values) { GetHandle(name).Fill(values); }
+
+  /// Fills a 1D histogram with n values at once (weights multiply the event weight and can be nullptr)
+  void FillN(HistogramHandle &handle, const float *values, const float *weights, size_t n) {
+    handle.FillN(values, weights, n);
+  }
+
+  /// Histograms set this way are saved as they are and can't be filled through the handler
+  void SetHistogram1D(HistNames names, TH1D *histogram);
+  void SetHistogram2D(HistNames names, TH2D *histogram);
+
+  /// Histograms from the config are filled in dense histograms, and only copied to these when asked for
+  TH1D* GetHistogram1D(HistNames names) { UpdateROOTHistograms(); return histograms1D[names]; }
+  std::map<HistNames, TH1D*> GetHistograms1D() { UpdateROOTHistograms(); return histograms1D; }
+  std::map<HistNames, TH2D*> GetHistograms2D() { UpdateROOTHistograms(); return histograms2D; }
   void SaveHistograms();
   void Print();
+
+  /// Adds histograms filled by another handler (e.g. in another thread of the event loop) to this one's
+  void Merge(const HistogramsHandler &other);
   
  private:
   std::map<HistNames, TH1D*> histograms1D;
   std::map<HistNames, TH2D*> histograms2D;
   std::map<std::string, std::string> histogramDirectories;
-  std::vector<std::string> unfilledHistograms;
+  std::unordered_map<std::string, HistogramEntry> entries;  // nodes never move, so handles can point to them
+  std::map<std::string, DenseHistogram*> denseHistograms1D;  // filled in the event loop instead of histograms1D
+  std::map<std::string, DenseHistogram*> denseHistograms2D;
+  std::map<std::string, MultiWeightHistogram*> variationHistograms;
+  std::map<std::string, SparseHistogram*> sparseHistograms;  // exploded into <title>_<sfName> when saving
 
   std::map<std::string, HistogramParams> histParams;
   std::map<std::string, IrregularHistogramParams> irregularHistParams;
   std::map<std::string, HistogramParams2D> histParams2D;
   std::map<std::string, IrregularHistogramParams2D> irregularHistParams2D;
+  std::map<std::string, SparseHistogramParams> sparseHistParams;
   std::vector<std::string> SFvariationVariables;
   std::string outputPath;
-  std::map<std::string,float> eventWeights;
+  HistogramWeights eventWeights;
   bool sfSetup = false;
 
-  void RemoveFromUnfilled(std::string name);
-  void CheckHistogram(std::string name, std::string directory);
-  void CheckHistogram2D(std::string name, std::string directory);
+  void UpdateEntry(const std::string &name);
+  void UpdateROOTHistograms();
   void SetupHistograms();
   void SetupSFvariationHistograms();
 
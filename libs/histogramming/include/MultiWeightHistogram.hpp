@@ -0,0 +1,87 @@
+//  MultiWeightHistogram.hpp
+
+#ifndef MultiWeightHistogram_hpp
+#define MultiWeightHistogram_hpp
+
+#include "DenseHistogram.hpp"
+#include "Helpers.hpp"
+
+/// Histogram of one variable filled with many weights at once (e.g. all SF variations). There's a single binning,
+/// and for each bin the sums of weights (and of squared weights) for all weight slots are stored next to each other,
+/// so a fill finds the bin once and then updates N contiguous values. When saving, it's exploded into one regular
+/// histogram per weight, named <title>_<weightName>.
+class MultiWeightHistogram {
+ public:
+  /// Binning (1D or 2D) is taken from the given histogram, which is not modified
+  MultiWeightHistogram(const TH1 *binningHistogram, std::vector<std::string> weightNames_);
+  MultiWeightHistogram(const MultiWeightHistogram &other);
+  ~MultiWeightHistogram();
+
+  /// Fills all weight slots for which isSet is true
+  inline void Fill(double value, const float *weights, const char *isSet) {
+    int binX = xAxis.FindBin(value);
+    bool inRange = binX >= 1 && binX <= xAxis.nBins;
+    FillBin(binX, inRange, weights, isSet, value, 0);
+  }
+
+  inline void Fill(double valueX, double valueY, const float *weights, const char *isSet) {
+    int binX = xAxis.FindBin(valueX);
+    int binY = yAxis.FindBin(valueY);
+    bool inRange = binX >= 1 && binX <= xAxis.nBins && binY >= 1 && binY <= yAxis.nBins;
+    FillBin(binX + (xAxis.nBins + 2) * binY, inRange, weights, isSet, valueX, valueY);
+  }
+
+  /// Fills a 1D histogram with n values whose bins are already known, each scaled by its valueWeight (can be nullptr)
+  void FillBins(const int *bins, const float *values, const float *valueWeights, size_t n, const float *weights,
+                const char *isSet);
+
+  void Add(const MultiWeightHistogram &other);
+
+  /// Creates a histogram for each weight slot (the caller owns them)
+  std::vector<std::pair<std::string, TH1 *>> Explode(const std::string &title) const;
+
+  inline const std::vector<std::string> &GetWeightNames() const { return weightNames; }
+
+ private:
+  // sums per weight slot, the same as TH1/TH2 keep for statistics (sumw, sumw2, sumwx, sumwx2, sumwy, sumwy2, sumwxy)
+  static constexpr int nStats = 7;
+
+  TH1 *binning;  // empty copy of the input histogram, used to create exploded histograms
+  DenseAxis xAxis, yAxis;
+  bool is2D;
+
+  std::vector<std::string> weightNames;
+  size_t nWeights;
+  std::vector<double> sumw;   // [bin * nWeights + iWeight]
+  std::vector<double> sumw2;  // [bin * nWeights + iWeight]
+  std::vector<double> stats;  // [iWeight * nStats + iStat]
+  std::vector<double> entries;
+  std::vector<char> weighted;  // whether a weight other than 1 was used (only then ROOT stores sumw2)
+
+  inline void FillBin(int bin, bool inRange, const float *weights, const char *isSet, double x, double y) {
+    double *binSumw = &sumw[bin * nWeights];
+    double *binSumw2 = &sumw2[bin * nWeights];
+
+    for (size_t iWeight = 0; iWeight < nWeights; iWeight++) {
+      if (!isSet[iWeight]) continue;
+      double weight = weights[iWeight];
+      binSumw[iWeight] += weight;
+      binSumw2[iWeight] += weight * weight;
+      entries[iWeight]++;
+      if (weight != 1) weighted[iWeight] = true;
+
+      // like in ROOT, under- and overflows don't count for statistics
+      if (!inRange) continue;
+      double *weightStats = &stats[iWeight * nStats];
+      weightStats[0] += weight;
+      weightStats[1] += weight * weight;
+      weightStats[2] += weight * x;
+      weightStats[3] += weight * x * x;
+      weightStats[4] += weight * y;
+      weightStats[5] += weight * y * y;
+      weightStats[6] += weight * x * y;
+    }
+  }
+};
+
+#endif /* MultiWeightHistogram_hpp */
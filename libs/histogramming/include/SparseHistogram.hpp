@@ -0,0 +1,69 @@
+//  SparseHistogram.hpp
+
+#ifndef SparseHistogram_hpp
+#define SparseHistogram_hpp
+
+#include "DenseHistogram.hpp"
+#include "Helpers.hpp"
+#include "THnSparse.h"
+
+/// N-dimensional histogram which only stores bins that were filled, in a hash map keyed by the global bin number.
+/// Memory scales with the number of occupied bins rather than the size of the grid, which makes very fine binnings
+/// (e.g. ABCD plane scans or mass x ctau grids) possible. It's converted to THnSparseD or TH2D when saving.
+class SparseHistogram {
+ public:
+  SparseHistogram(const SparseHistogramParams &params);
+
+  /// Fills the histogram with one value per axis
+  inline void Fill(const double *values, double weight) {
+    uint64_t bin = 0;
+    bool inRange = true;
+    for (size_t iAxis = 0; iAxis < axes.size(); iAxis++) {
+      int axisBin = axes[iAxis].FindBin(values[iAxis]);
+      inRange &= axisBin >= 1 && axisBin <= axes[iAxis].nBins;
+      bin += axisBin * strides[iAxis];
+    }
+
+    auto &content = bins[bin];
+    content.first += weight;
+    content.second += weight * weight;
+    entries++;
+    if (weight != 1) weighted = true;
+
+    // like in ROOT, under- and overflows don't count for statistics
+    if (!inRange) return;
+    sumw += weight;
+    sumw2 += weight * weight;
+    for (size_t iAxis = 0; iAxis < axes.size(); iAxis++) {
+      sumwx[iAxis] += weight * values[iAxis];
+      sumwx2[iAxis] += weight * values[iAxis] * values[iAxis];
+    }
+    if (axes.size() == 2) sumwxy += weight * values[0] * values[1];
+  }
+
+  void Add(const SparseHistogram &other);
+
+  inline size_t GetNdimensions() const { return axes.size(); }
+  inline size_t GetNoccupiedBins() const { return bins.size(); }
+  inline bool IsProjectedTo2D() const { return params.projectTo2D; }
+
+  /// Creates a ROOT histogram with the filled bins (the caller owns it)
+  THnSparseD *ToTHnSparse(const std::string &name) const;
+  TH2D *ToTH2D(const std::string &name) const;
+
+ private:
+  SparseHistogramParams params;
+  std::vector<DenseAxis> axes;
+  std::vector<uint64_t> strides;  // global bin = sum of bin on each axis (including under/overflow) times its stride
+
+  std::unordered_map<uint64_t, std::pair<double, double>> bins;  // sum of weights and of squared weights
+  double entries = 0;
+  bool weighted = false;
+  double sumw = 0, sumw2 = 0, sumwxy = 0;
+  std::vector<double> sumwx, sumwx2;
+
+  /// Bin number on each axis for a global bin
+  void GetAxesBins(uint64_t bin, int *axesBins) const;
+};
+
+#endif /* SparseHistogram_hpp */
@@ -0,0 +1,68 @@
+//  DenseHistogram.cpp
+
+#include "DenseHistogram.hpp"
+
+using namespace std;
+
+DenseAxis::DenseAxis(const TAxis *axis) {
+  nBins = axis->GetNbins();
+  min = axis->GetXmin();
+  max = axis->GetXmax();
+  const TArrayD *binEdges = axis->GetXbins();
+  if (binEdges->GetSize() > 0) edges.assign(binEdges->GetArray(), binEdges->GetArray() + binEdges->GetSize());
+}
+
+DenseHistogram::DenseHistogram(const TH1 *binningHistogram) {
+  auto histogram = const_cast<TH1 *>(binningHistogram);  // axes getters are not const
+  is2D = dynamic_cast<const TH2 *>(binningHistogram) != nullptr;
+  xAxis = DenseAxis(histogram->GetXaxis());
+  if (is2D) yAxis = DenseAxis(histogram->GetYaxis());
+
+  size_t nCells = (xAxis.nBins + 2) * (is2D ? yAxis.nBins + 2 : 1);
+  contents.assign(nCells, 0);
+  sumw2.assign(nCells, 0);
+}
+
+void DenseHistogram::FillBins(const int *bins, const float *values, const float *valueWeights, double weight,
+                              size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    double valueWeight = valueWeights ? weight * valueWeights[i] : weight;
+    AddToBin(bins[i], bins[i] >= 1 && bins[i] <= xAxis.nBins, valueWeight, values[i], 0);
+  }
+}
+
+void DenseHistogram::Add(const DenseHistogram &other) {
+  if (other.contents.size() != contents.size() || other.is2D != is2D) {
+    fatal() << "Trying to add histograms with different binning" << endl;
+    exit(1);
+  }
+  for (size_t i = 0; i < contents.size(); i++) {
+    contents[i] += other.contents[i];
+    sumw2[i] += other.sumw2[i];
+  }
+  for (int i = 0; i < 7; i++) stats[i] += other.stats[i];
+  entries += other.entries;
+  weighted |= other.weighted;
+}
+
+void DenseHistogram::CopyTo(TH1 *histogram) const {
+  if (histogram->GetNcells() != (int)contents.size()) {
+    fatal() << "Trying to copy a histogram to " << histogram->GetName() << ", which has different binning" << endl;
+    exit(1);
+  }
+  for (size_t bin = 0; bin < contents.size(); bin++) histogram->SetBinContent(bin, contents[bin]);
+
+  // the target may already have sumw2 (with TH1::SetDefaultSumw2) - for unweighted fills it's equal to bin contents,
+  // like ROOT would have it
+  if (weighted || histogram->GetSumw2N() > 0) {
+    if (histogram->GetSumw2N() == 0) histogram->Sumw2();
+    double *histogramSumw2 = histogram->GetSumw2()->GetArray();
+    for (size_t bin = 0; bin < sumw2.size(); bin++) histogramSumw2[bin] = sumw2[bin];
+  }
+
+  // setting bin contents resets statistics, so they're restored at the end
+  histogram->SetEntries(entries);
+  double histogramStats[7];
+  copy(begin(stats), end(stats), histogramStats);
+  histogram->PutStats(histogramStats);
+}
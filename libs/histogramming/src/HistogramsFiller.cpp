@@ -17,6 +17,15 @@ HistogramsFiller::HistogramsFiller(shared_ptr<HistogramsHandler> histogramsHandl
   } catch (const Exception& e) {
     warn() << "Couldn't read defaultHistParams from config file - no default histograms will be included" << endl;
   }
+
+  if (!histogramsHandler) return;
+  for (auto& [title, params] : defaultHistVariables) {
+    if (params.variable.empty()) {
+      warn() << "Skipping default histogram '" << title << "': empty variable name" << endl;
+      continue;
+    }
+    defaultHistograms.push_back({params, histogramsHandler->GetHandle(title)});
+  }
 }
 
 HistogramsFiller::~HistogramsFiller() {}
@@ -24,14 +33,9 @@ HistogramsFiller::~HistogramsFiller() {}
 void HistogramsFiller::FillDefaultVariables(const std::shared_ptr<Event> event) {
   if (!event || !histogramsHandler) return;
 
-  for (auto& [title, params] : defaultHistVariables) {
-    string collectionName = params.collection;
-    string branchName = params.variable;
-
-    if (branchName.empty()) {
-      warn() << "Skipping default histogram '" << title << "': empty variable name" << endl;
-      continue;
-    }
+  for (auto& [params, histogram] : defaultHistograms) {
+    const string& collectionName = params.collection;
+    const string& branchName = params.variable;
 
     if (collectionName == "Event") {
       float eventVariable;
@@ -42,42 +46,89 @@ void HistogramsFiller::FillDefaultVariables(const std::shared_ptr<Event> event)
       } else {
         eventVariable = event->GetAs<float>(branchName);
       }
-      histogramsHandler->Fill(title, eventVariable);
+      histogram.Fill(eventVariable);
     } else {
       auto collection = event->GetCollection(collectionName);
       if (!collection) continue;
+      if (FillFromColumns(event, collection, params, histogram)) continue;
       for (auto object : *collection) {
         if (!object) continue;
-        histogramsHandler->Fill(title, object->GetAs<float>(branchName));
+        histogram.Fill(object->GetAs<float>(branchName));
       }
     }
   }
 }
 
+bool HistogramsFiller::FillFromColumns(const shared_ptr<Event> event, const shared_ptr<PhysicsObjects> collection,
+                                       const HistogramParams& params, HistogramHandle& histogram) {
+  // only input collections are stored in columns, with objects being the rows in order
+  auto columns = event->GetColumnarCollection(params.collection);
+  if (!columns || collection->size() == 0 || collection->size() != columns->GetSize()) return false;
+  if ((*collection)[0]->GetColumns() != columns) return false;
+
+  const Column* column = columns->GetColumn(params.variable);
+  if (!column) return false;
+
+  size_t size = collection->size();
+  const void* data = column->Data();
+  const float* values = static_cast<const float*>(data);
+  if (column->type != BranchType::kFloat) {
+    columnValues.resize(size);
+    for (size_t row = 0; row < size; row++) columnValues[row] = ReadValueAs<float>(column->type, data, row);
+    values = columnValues.data();
+  }
+  histogramsHandler->FillN(histogram, values, nullptr, size);
+  return true;
+}
+
 void HistogramsFiller::FillCutFlow(const std::shared_ptr<CutFlowManager> cutFlowManager) {
-  int cutFlowLength = cutFlowManager->GetCutFlow().size();
-  auto cutFlowHist = new TH1D("cutFlow", "cutFlow", cutFlowLength, 0, cutFlowLength);
-  auto rawEventsCutFlowHist = new TH1D("rawEventsCutFlow", "rawEventsCutFlow", cutFlowLength, 0, cutFlowLength);
-
-  map<int, pair<string, float>> sortedWeightsAfterCuts;
-  map<int, pair<string, float>> sortedRawEventsAfterCuts;
-  auto cutFlow = cutFlowManager->GetCutFlow();
-  auto rawEventsCutFlow = cutFlowManager->GetRawEventsCutFlow();
-  for (auto& [cutName, sumOfWeights] : cutFlow) {
-    string number = cutName.substr(0, cutName.find("_"));
-    int index = stoi(number);
-    sortedWeightsAfterCuts[index] = {cutName, sumOfWeights};
-    sortedRawEventsAfterCuts[index] = {cutName, rawEventsCutFlow[cutName]};
+  auto fillCutFlowHist = [&](string histName, const map<string, float>& cutFlow) {
+    // cut names start with their index, which sets the order of bins
+    map<int, pair<string, float>> sortedCutFlow;
+    for (auto& [cutName, sumOfWeights] : cutFlow) {
+      string number = cutName.substr(0, cutName.find("_"));
+      int index = stoi(number);
+      sortedCutFlow[index] = {cutName, sumOfWeights};
+    }
+
+    int cutFlowLength = cutFlow.size();
+    auto hist = new TH1D(histName.c_str(), histName.c_str(), cutFlowLength, 0, cutFlowLength);
+    int bin = 1;
+    for (auto& [index, values] : sortedCutFlow) {
+      hist->SetBinContent(bin, get<1>(values));
+      hist->GetXaxis()->SetBinLabel(bin, get<0>(values).c_str());
+      bin++;
+    }
+    histogramsHandler->SetHistogram1D(make_pair(histName, ""), hist);
+  };
+
+  fillCutFlowHist("cutFlow", cutFlowManager->GetCutFlow());
+  fillCutFlowHist("rawEventsCutFlow", cutFlowManager->GetRawEventsCutFlow());
+  for (auto& variationName : cutFlowManager->GetWeightVariations()) {
+    fillCutFlowHist("cutFlow_" + variationName, cutFlowManager->GetVariationCutFlow(variationName));
   }
 
-  int bin = 1;
-  for (auto& [index, values] : sortedWeightsAfterCuts) {
-    cutFlowHist->SetBinContent(bin, get<1>(values));
-    rawEventsCutFlowHist->SetBinContent(bin, get<1>(sortedRawEventsAfterCuts[index]));
-    cutFlowHist->GetXaxis()->SetBinLabel(bin, get<0>(values).c_str());
-    rawEventsCutFlowHist->GetXaxis()->SetBinLabel(bin, get<0>(sortedRawEventsAfterCuts[index]).c_str());
-    bin++;
+  // only available with recordCutMasks in the config
+  auto nMinusOneCutFlow = cutFlowManager->GetNminusOneCutFlow();
+  if (nMinusOneCutFlow.empty()) return;
+
+  int nCuts = nMinusOneCutFlow.size();
+  auto nMinusOneHist = new TH1D("cutFlowNminusOne", "cutFlowNminusOne", nCuts, 0, nCuts);
+  auto rawEventsNminusOneHist = new TH1D("rawEventsCutFlowNminusOne", "rawEventsCutFlowNminusOne", nCuts, 0, nCuts);
+  auto correlationsHist = new TH2D("cutCorrelations", "cutCorrelations", nCuts, 0, nCuts, nCuts, 0, nCuts);
+  auto cutCorrelations = cutFlowManager->GetCutCorrelations();
+
+  for (int i = 0; i < nCuts; i++) {
+    auto& [cutName, sumOfWeights, rawEvents] = nMinusOneCutFlow[i];
+    nMinusOneHist->SetBinContent(i + 1, sumOfWeights);
+    rawEventsNminusOneHist->SetBinContent(i + 1, rawEvents);
+    nMinusOneHist->GetXaxis()->SetBinLabel(i + 1, cutName.c_str());
+    rawEventsNminusOneHist->GetXaxis()->SetBinLabel(i + 1, cutName.c_str());
+    correlationsHist->GetXaxis()->SetBinLabel(i + 1, cutName.c_str());
+    correlationsHist->GetYaxis()->SetBinLabel(i + 1, cutName.c_str());
+    for (int j = 0; j < nCuts; j++) correlationsHist->SetBinContent(i + 1, j + 1, cutCorrelations[i][j]);
   }
-  histogramsHandler->SetHistogram1D(make_pair("cutFlow",""), cutFlowHist);
-  histogramsHandler->SetHistogram1D(make_pair("rawEventsCutFlow",""), rawEventsCutFlowHist);
+  histogramsHandler->SetHistogram1D(make_pair("cutFlowNminusOne", ""), nMinusOneHist);
+  histogramsHandler->SetHistogram1D(make_pair("rawEventsCutFlowNminusOne", ""), rawEventsNminusOneHist);
+  histogramsHandler->SetHistogram2D(make_pair("cutCorrelations", ""), correlationsHist);
 }
@@ -39,6 +39,11 @@ HistogramsHandler::HistogramsHandler() {
   } catch (const Exception& e) {
   }
 
+  try {
+    config.GetHistogramsParams(sparseHistParams, "sparseHistParams");
+  } catch (const Exception& e) {
+  }
+
   try {
     config.GetValue("histogramsOutputFilePath", outputPath);
   } catch (const Exception& e) {
@@ -48,12 +53,15 @@ HistogramsHandler::HistogramsHandler() {
   } catch (const Exception& e) {
   }
 
-  eventWeights["default"] = 1.0;  // Default weight
-
   SetupHistograms();
 }
 
-HistogramsHandler::~HistogramsHandler() {}
+HistogramsHandler::~HistogramsHandler() {
+  for (auto& [title, hist] : denseHistograms1D) delete hist;
+  for (auto& [title, hist] : denseHistograms2D) delete hist;
+  for (auto& [title, hist] : sparseHistograms) delete hist;
+  for (auto& [title, hist] : variationHistograms) delete hist;
+}
 
 void HistogramsHandler::SetupHistograms() {
   for (auto& [title, params] : histParams) {
@@ -78,115 +86,186 @@ void HistogramsHandler::SetupHistograms() {
                                                   params.binEdgesY.size() - 1, &params.binEdgesY[0]);
   }
 
-  // copy names of all histograms to unfilledHistograms vector
-  for (auto& [names, hist] : histograms1D) {
-    unfilledHistograms.push_back(names.first);
-  }
-  for (auto& [names, hist] : histograms2D) {
-    unfilledHistograms.push_back(names.first);
+  for (auto& [names, hist] : histograms1D) denseHistograms1D[names.first] = new DenseHistogram(hist);
+  for (auto& [names, hist] : histograms2D) denseHistograms2D[names.first] = new DenseHistogram(hist);
+
+  for (auto& [title, params] : sparseHistParams) {
+    histogramDirectories[title] = params.directory;
+    sparseHistograms[title] = new SparseHistogram(params);
   }
+
+  for (auto& [names, hist] : histograms1D) UpdateEntry(names.first);
+  for (auto& [names, hist] : histograms2D) UpdateEntry(names.first);
+  for (auto& [title, hist] : sparseHistograms) UpdateEntry(title);
 }
 
 void HistogramsHandler::SetupSFvariationHistograms() {
-  for (auto& [title, params] : histParams) {
-    if (find(SFvariationVariables.begin(), SFvariationVariables.end(), title) == SFvariationVariables.end()) continue;
-    for (auto& [sfName, weight] : eventWeights) {
-      if (sfName == "default") continue;
-      string titlesf = title + "_" + sfName;
-      histograms1D[make_pair(title, sfName)] = new TH1D(titlesf.c_str(), titlesf.c_str(), params.nBins, params.min, params.max);
-    }
-  }
+  vector<string> sfNames(eventWeights.names.begin() + 1, eventWeights.names.end());
+  if (sfNames.empty()) return;
 
-  for (auto& [title, params] : irregularHistParams) {
-    if (find(SFvariationVariables.begin(), SFvariationVariables.end(), title) == SFvariationVariables.end()) continue;
-    for (auto& [sfName, weight] : eventWeights) {
-      if (sfName == "default") continue;
-      string titlesf = title + "_" + sfName;
-      histograms1D[make_pair(title, sfName)] = new TH1D(titlesf.c_str(), titlesf.c_str(), params.binEdges.size() - 1, &params.binEdges[0]);
-    }
-  }
+  for (auto& title : SFvariationVariables) {
+    if (variationHistograms.count(title)) continue;
 
-  for (auto& [title, params] : histParams2D) {
-    if (find(SFvariationVariables.begin(), SFvariationVariables.end(), title) == SFvariationVariables.end()) continue;
-    for (auto& [sfName, weight] : eventWeights) {
-      if (sfName == "default") continue;
-      string titlesf = title + "_" + sfName;
-      histograms2D[make_pair(title, sfName)] =
-          new TH2D(titlesf.c_str(), titlesf.c_str(), params.nBinsX, params.minX, params.maxX, params.nBinsY, params.minY, params.maxY);
-    }
-  }
+    TH1* nominal = nullptr;
+    auto hist1DIt = histograms1D.find(make_pair(title, ""));
+    auto hist2DIt = histograms2D.find(make_pair(title, ""));
+    if (hist1DIt != histograms1D.end()) nominal = hist1DIt->second;
+    else if (hist2DIt != histograms2D.end()) nominal = hist2DIt->second;
+    if (!nominal) continue;
 
-  for (auto& [title, params] : irregularHistParams2D) {
-    if (find(SFvariationVariables.begin(), SFvariationVariables.end(), title) == SFvariationVariables.end()) continue;
-    for (auto& [sfName, weight] : eventWeights) {
-      if (sfName == "default") continue;
-      string titlesf = title + "_" + sfName;
-      histograms2D[make_pair(title, sfName)] = new TH2D(titlesf.c_str(), titlesf.c_str(), params.binEdgesX.size() - 1, &params.binEdgesX[0],
-                                                        params.binEdgesY.size() - 1, &params.binEdgesY[0]);
-    }
+    variationHistograms[title] = new MultiWeightHistogram(nominal, sfNames);
   }
 }
 
 void HistogramsHandler::SetEventWeights(map<string, float> weights) {
-  eventWeights = weights;
+  // SF variations are fixed by the first event's weights, and their histograms booked at that point
   if (!sfSetup) {
+    for (auto& [sfName, weight] : weights) {
+      if (sfName == "default") continue;
+      eventWeights.names.push_back(sfName);
+      eventWeights.values.push_back(1.0);
+      eventWeights.isSet.push_back(true);
+    }
     SetupSFvariationHistograms();
+    for (auto& [name, entry] : entries) UpdateEntry(name);
     sfSetup = true;
   }
-};
 
-void HistogramsHandler::Fill(string name, double value) {
-  double weight = eventWeights["default"];
-  CheckHistogram(name, "");
-  histograms1D[make_pair(name, "")]->Fill(value, weight);
-
-  RemoveFromUnfilled(name);
+  size_t nSet = 0;
+  for (size_t iWeight = 0; iWeight < eventWeights.names.size(); iWeight++) {
+    auto weightIt = weights.find(eventWeights.names[iWeight]);
+    eventWeights.isSet[iWeight] = weightIt != weights.end();
+    eventWeights.values[iWeight] = weightIt == weights.end() ? 0 : weightIt->second;
+    nSet += eventWeights.isSet[iWeight];
+  }
+  if (nSet == weights.size() || SFvariationVariables.empty()) return;
 
-  // handle SF variation histograms
-  if (find(SFvariationVariables.begin(), SFvariationVariables.end(), name) == SFvariationVariables.end()) return;
-  for (auto& [sfName, weight] : eventWeights) {
-    if (sfName == "default") continue;
-    CheckHistogram(name, sfName);
-    histograms1D[make_pair(name, sfName)]->Fill(value, weight);
+  for (auto& [sfName, weight] : weights) {
+    if (find(eventWeights.names.begin(), eventWeights.names.end(), sfName) != eventWeights.names.end()) continue;
+    fatal() << "Event weight " << sfName << " wasn't there when SF variation histograms were created" << endl;
+    exit(1);
   }
 }
 
-void HistogramsHandler::Fill(string name, double valueX, double valueY) {
-  double weight = eventWeights["default"];
-  CheckHistogram2D(name, "");
-  histograms2D[make_pair(name, "")]->Fill(valueX, valueY, weight);
+HistogramHandle HistogramsHandler::GetHandle(const string& name) {
+  auto entryIt = entries.find(name);
+  if (entryIt == entries.end()) {
+    fatal() << "Couldn't find key: " << name << " in histograms map" << endl;
+    exit(1);
+  }
+  return HistogramHandle(&entryIt->second, &eventWeights);
+}
 
-  RemoveFromUnfilled(name);
+void HistogramsHandler::SetHistogram1D(HistNames names, TH1D* histogram) {
+  histograms1D[names] = histogram;
 
-  if (find(SFvariationVariables.begin(), SFvariationVariables.end(), name) == SFvariationVariables.end()) return;
-  for (auto& [sfName, weight] : eventWeights) {
-    if (sfName == "default") continue;
-    CheckHistogram2D(name, sfName);
-    histograms2D[make_pair(name, sfName)]->Fill(valueX, valueY, weight);
+  auto denseIt = denseHistograms1D.find(names.first);
+  if (names.second.empty() && denseIt != denseHistograms1D.end()) {
+    delete denseIt->second;
+    denseHistograms1D.erase(denseIt);
   }
+  if (entries.count(names.first)) UpdateEntry(names.first);
 }
 
-void HistogramsHandler::RemoveFromUnfilled(string name) {
-  auto it = find(unfilledHistograms.begin(), unfilledHistograms.end(), name);
-  if (it != unfilledHistograms.end()) {
-    unfilledHistograms.erase(it);
+void HistogramsHandler::SetHistogram2D(HistNames names, TH2D* histogram) {
+  histograms2D[names] = histogram;
+
+  auto denseIt = denseHistograms2D.find(names.first);
+  if (names.second.empty() && denseIt != denseHistograms2D.end()) {
+    delete denseIt->second;
+    denseHistograms2D.erase(denseIt);
   }
+  if (entries.count(names.first)) UpdateEntry(names.first);
 }
 
-void HistogramsHandler::CheckHistogram(string name, string directory) {
-  if (!histograms1D.count(make_pair(name, directory))) {
-    fatal() << "Couldn't find key: " << name << ", " << directory << " in 1D histograms map" << endl;
-    exit(1);
+void HistogramsHandler::Merge(const HistogramsHandler &other) {
+  // ROOT histograms backed by dense ones may be out of date, so only their dense histograms are added
+  for (auto &[names, otherHist] : other.histograms1D) {
+    bool isDense = names.second.empty() && other.denseHistograms1D.count(names.first);
+    auto it = histograms1D.find(names);
+    if (it == histograms1D.end()) {
+      histograms1D[names] = (TH1D *)otherHist->Clone();
+      histogramDirectories[names.first] = other.histogramDirectories.at(names.first);
+    } else if (!isDense) {
+      it->second->Add(otherHist);
+    }
+  }
+  for (auto &[names, otherHist] : other.histograms2D) {
+    bool isDense = names.second.empty() && other.denseHistograms2D.count(names.first);
+    auto it = histograms2D.find(names);
+    if (it == histograms2D.end()) {
+      histograms2D[names] = (TH2D *)otherHist->Clone();
+      histogramDirectories[names.first] = other.histogramDirectories.at(names.first);
+    } else if (!isDense) {
+      it->second->Add(otherHist);
+    }
   }
-}
 
-void HistogramsHandler::CheckHistogram2D(string name, string directory) {
-  if (!histograms2D.count(make_pair(name, directory))) {
-    fatal() << "Couldn't find key: " << name << ", " << directory << " in 2D histograms map" << endl;
-    exit(1);
+  for (auto &[title, otherHist] : other.denseHistograms1D) {
+    auto it = denseHistograms1D.find(title);
+    if (it == denseHistograms1D.end()) {
+      denseHistograms1D[title] = new DenseHistogram(*otherHist);
+    } else {
+      it->second->Add(*otherHist);
+    }
+  }
+  for (auto &[title, otherHist] : other.denseHistograms2D) {
+    auto it = denseHistograms2D.find(title);
+    if (it == denseHistograms2D.end()) {
+      denseHistograms2D[title] = new DenseHistogram(*otherHist);
+    } else {
+      it->second->Add(*otherHist);
+    }
+  }
+
+  for (auto &[title, otherHist] : other.sparseHistograms) {
+    auto it = sparseHistograms.find(title);
+    if (it == sparseHistograms.end()) {
+      sparseHistograms[title] = new SparseHistogram(*otherHist);
+      histogramDirectories[title] = other.histogramDirectories.at(title);
+    } else {
+      it->second->Add(*otherHist);
+    }
+  }
+
+  for (auto &[title, otherHist] : other.variationHistograms) {
+    auto it = variationHistograms.find(title);
+    if (it == variationHistograms.end()) {
+      variationHistograms[title] = new MultiWeightHistogram(*otherHist);
+    } else {
+      it->second->Add(*otherHist);
+    }
+  }
+
+  // a histogram is unfilled only if none of the handlers filled it
+  for (auto &[name, otherEntry] : other.entries) {
+    bool filled = otherEntry.filled;
+    if (entries.count(name)) filled |= entries[name].filled;
+    UpdateEntry(name);
+    entries[name].filled = filled;
   }
 }
 
+void HistogramsHandler::UpdateEntry(const string& name) {
+  auto& entry = entries[name];
+  entry.name = name;
+
+  auto hist1DIt = denseHistograms1D.find(name);
+  entry.hist1D = hist1DIt == denseHistograms1D.end() ? nullptr : hist1DIt->second;
+  auto hist2DIt = denseHistograms2D.find(name);
+  entry.hist2D = hist2DIt == denseHistograms2D.end() ? nullptr : hist2DIt->second;
+
+  auto variationsIt = variationHistograms.find(name);
+  entry.variations = variationsIt == variationHistograms.end() ? nullptr : variationsIt->second;
+  auto sparseIt = sparseHistograms.find(name);
+  entry.sparse = sparseIt == sparseHistograms.end() ? nullptr : sparseIt->second;
+}
+
+void HistogramsHandler::UpdateROOTHistograms() {
+  for (auto& [title, dense] : denseHistograms1D) dense->CopyTo(histograms1D[make_pair(title, "")]);
+  for (auto& [title, dense] : denseHistograms2D) dense->CopyTo(histograms2D[make_pair(title, "")]);
+}
+
 template <typename THist>
 void HistogramsHandler::SaveHistogram(HistNames names, THist* hist, TFile* outputFile) {
   string name = names.first;
@@ -213,7 +292,7 @@ void HistogramsHandler::SaveHistogram(HistNames names, THist* hist, TFile* outpu
     if (hist->GetNbinsX() * hist->GetNbinsY() > 2000 * 2000) {
       warn() << "You're creating a very large 2D histogram: " << name << " with ";
       warn() << hist->GetNbinsX() << " x " << hist->GetNbinsY() << " bins. ";
-      warn() << "This may cause memory issues." << endl;
+      warn() << "This may cause memory issues - consider defining it in sparseHistParams instead." << endl;
     }
   }
 
@@ -235,6 +314,8 @@ void HistogramsHandler::SaveHistograms() {
     warn() << "Failed to create histogram output directory: " << path << " (" << ec.message() << ")" << endl;
   }
 
+  UpdateROOTHistograms();
+
   auto outputFile = new TFile((path + "/" + filename).c_str(), "recreate");
   outputFile->cd();
 
@@ -244,6 +325,23 @@ void HistogramsHandler::SaveHistograms() {
   for (auto& [names, hist] : histograms2D) {
     SaveHistogram(names, hist, outputFile);
   }
+  for (auto& [title, sparse] : sparseHistograms) {
+    if (sparse->IsProjectedTo2D()) {
+      TH2D* hist = sparse->ToTH2D(title);
+      SaveHistogram(make_pair(title, ""), hist, outputFile);
+      delete hist;
+    } else {
+      THnSparseD* hist = sparse->ToTHnSparse(title);
+      SaveHistogram(make_pair(title, ""), hist, outputFile);
+      delete hist;
+    }
+  }
+  for (auto& [title, variations] : variationHistograms) {
+    for (auto& [sfName, hist] : variations->Explode(title)) {
+      SaveHistogram(make_pair(title, sfName), hist, outputFile);
+      delete hist;
+    }
+  }
 
   outputFile->Close();
 
@@ -253,6 +351,10 @@ void HistogramsHandler::SaveHistograms() {
 }
 
 void HistogramsHandler::Print() {
+  set<string> unfilledHistograms;
+  for (auto& [name, entry] : entries) {
+    if (!entry.filled) unfilledHistograms.insert(name);
+  }
   for (auto& name : unfilledHistograms) {
     warn() << "Histogram defined but not filled: " << name << endl;
   }
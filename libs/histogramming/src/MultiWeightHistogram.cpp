@@ -0,0 +1,87 @@
+//  MultiWeightHistogram.cpp
+
+#include "MultiWeightHistogram.hpp"
+
+using namespace std;
+
+MultiWeightHistogram::MultiWeightHistogram(const TH1 *binningHistogram, vector<string> weightNames_)
+    : weightNames(weightNames_), nWeights(weightNames_.size()) {
+  binning = (TH1 *)binningHistogram->Clone();
+  binning->SetDirectory(nullptr);
+  binning->Reset();
+
+  is2D = dynamic_cast<const TH2 *>(binningHistogram) != nullptr;
+  xAxis = DenseAxis(binning->GetXaxis());
+  if (is2D) yAxis = DenseAxis(binning->GetYaxis());
+
+  sumw.assign(binning->GetNcells() * nWeights, 0);
+  sumw2.assign(binning->GetNcells() * nWeights, 0);
+  stats.assign(nWeights * nStats, 0);
+  entries.assign(nWeights, 0);
+  weighted.assign(nWeights, false);
+}
+
+MultiWeightHistogram::MultiWeightHistogram(const MultiWeightHistogram &other)
+    : MultiWeightHistogram(other.binning, other.weightNames) {
+  Add(other);
+}
+
+MultiWeightHistogram::~MultiWeightHistogram() { delete binning; }
+
+void MultiWeightHistogram::FillBins(const int *bins, const float *values, const float *valueWeights, size_t n,
+                                    const float *weights, const char *isSet) {
+  vector<float> scaledWeights(valueWeights ? nWeights : 0);
+
+  for (size_t i = 0; i < n; i++) {
+    bool inRange = bins[i] >= 1 && bins[i] <= xAxis.nBins;
+    if (!valueWeights) {
+      FillBin(bins[i], inRange, weights, isSet, values[i], 0);
+      continue;
+    }
+    for (size_t iWeight = 0; iWeight < nWeights; iWeight++) scaledWeights[iWeight] = weights[iWeight] * valueWeights[i];
+    FillBin(bins[i], inRange, scaledWeights.data(), isSet, values[i], 0);
+  }
+}
+
+void MultiWeightHistogram::Add(const MultiWeightHistogram &other) {
+  if (other.weightNames != weightNames || other.sumw.size() != sumw.size()) {
+    fatal() << "Trying to add multi-weight histograms with different binning or weights: " << binning->GetName() << endl;
+    exit(1);
+  }
+  for (size_t i = 0; i < sumw.size(); i++) {
+    sumw[i] += other.sumw[i];
+    sumw2[i] += other.sumw2[i];
+  }
+  for (size_t i = 0; i < stats.size(); i++) stats[i] += other.stats[i];
+  for (size_t i = 0; i < entries.size(); i++) {
+    entries[i] += other.entries[i];
+    weighted[i] |= other.weighted[i];
+  }
+}
+
+vector<pair<string, TH1 *>> MultiWeightHistogram::Explode(const string &title) const {
+  vector<pair<string, TH1 *>> histograms;
+  int nCells = binning->GetNcells();
+
+  for (size_t iWeight = 0; iWeight < nWeights; iWeight++) {
+    string name = title + "_" + weightNames[iWeight];
+    auto histogram = (TH1 *)binning->Clone(name.c_str());
+    histogram->SetTitle(name.c_str());
+
+    for (int bin = 0; bin < nCells; bin++) histogram->SetBinContent(bin, sumw[bin * nWeights + iWeight]);
+    // the clone may already have sumw2 (with TH1::SetDefaultSumw2), which then has to be filled for unweighted fills too
+    if (weighted[iWeight] || histogram->GetSumw2N() > 0) {
+      if (histogram->GetSumw2N() == 0) histogram->Sumw2();
+      double *histogramSumw2 = histogram->GetSumw2()->GetArray();
+      for (int bin = 0; bin < nCells; bin++) histogramSumw2[bin] = sumw2[bin * nWeights + iWeight];
+    }
+    // setting bin contents resets statistics, so they're restored at the end
+    histogram->SetEntries(entries[iWeight]);
+    vector<double> histogramStats(stats.begin() + iWeight * nStats, stats.begin() + (iWeight + 1) * nStats);
+    if (!is2D) histogramStats.resize(4);
+    histogram->PutStats(histogramStats.data());
+
+    histograms.push_back({weightNames[iWeight], histogram});
+  }
+  return histograms;
+}
@@ -0,0 +1,122 @@
+//  SparseHistogram.cpp
+
+#include "SparseHistogram.hpp"
+
+using namespace std;
+
+namespace {
+// THnBase has no setters for the statistics of fills, so they're restored through its protected members
+struct THnSparseStats : public THnSparseD {
+  static void Put(THnSparseD *histogram, double sumw, double sumw2, const vector<double> &sumwx,
+                  const vector<double> &sumwx2) {
+    histogram->*(&THnSparseStats::fTsumw) = sumw;
+    histogram->*(&THnSparseStats::fTsumw2) = sumw2;
+    for (size_t iAxis = 0; iAxis < sumwx.size(); iAxis++) {
+      (histogram->*(&THnSparseStats::fTsumwx)).SetAt(sumwx[iAxis], iAxis);
+      (histogram->*(&THnSparseStats::fTsumwx2)).SetAt(sumwx2[iAxis], iAxis);
+    }
+  }
+};
+}  // namespace
+
+SparseHistogram::SparseHistogram(const SparseHistogramParams &params_) : params(params_) {
+  uint64_t stride = 1;
+  for (size_t iAxis = 0; iAxis < params.variables.size(); iAxis++) {
+    DenseAxis axis;
+    axis.nBins = params.nBins[iAxis];
+    axis.min = params.min[iAxis];
+    axis.max = params.max[iAxis];
+    axes.push_back(axis);
+
+    strides.push_back(stride);
+    if (stride > numeric_limits<uint64_t>::max() / (axis.nBins + 2)) {
+      fatal() << "Sparse histogram " << params.name << " has too many bins to be indexed" << endl;
+      exit(1);
+    }
+    stride *= axis.nBins + 2;
+  }
+  sumwx.assign(axes.size(), 0);
+  sumwx2.assign(axes.size(), 0);
+}
+
+void SparseHistogram::Add(const SparseHistogram &other) {
+  if (other.strides != strides) {
+    fatal() << "Trying to add sparse histograms with different binning: " << params.name << endl;
+    exit(1);
+  }
+  for (auto &[bin, otherContent] : other.bins) {
+    auto &content = bins[bin];
+    content.first += otherContent.first;
+    content.second += otherContent.second;
+  }
+  entries += other.entries;
+  weighted |= other.weighted;
+  sumw += other.sumw;
+  sumw2 += other.sumw2;
+  sumwxy += other.sumwxy;
+  for (size_t iAxis = 0; iAxis < axes.size(); iAxis++) {
+    sumwx[iAxis] += other.sumwx[iAxis];
+    sumwx2[iAxis] += other.sumwx2[iAxis];
+  }
+}
+
+void SparseHistogram::GetAxesBins(uint64_t bin, int *axesBins) const {
+  for (size_t iAxis = 0; iAxis < axes.size(); iAxis++) {
+    axesBins[iAxis] = (bin / strides[iAxis]) % (axes[iAxis].nBins + 2);
+  }
+}
+
+THnSparseD *SparseHistogram::ToTHnSparse(const string &name) const {
+  vector<double> min, max;
+  for (auto &axis : axes) {
+    min.push_back(axis.min);
+    max.push_back(axis.max);
+  }
+  auto histogram = new THnSparseD(name.c_str(), name.c_str(), axes.size(), params.nBins.data(), min.data(), max.data());
+  for (size_t iAxis = 0; iAxis < axes.size(); iAxis++) {
+    histogram->GetAxis(iAxis)->SetName(params.variables[iAxis].c_str());
+    histogram->GetAxis(iAxis)->SetTitle(params.variables[iAxis].c_str());
+  }
+  if (weighted) histogram->Sumw2();
+
+  vector<int> axesBins(axes.size());
+  for (auto &[bin, content] : bins) {
+    GetAxesBins(bin, axesBins.data());
+    Long64_t histogramBin = histogram->GetBin(axesBins.data(), true);
+    histogram->SetBinContent(histogramBin, content.first);
+    if (weighted) histogram->SetBinError2(histogramBin, content.second);
+  }
+
+  // like for ToTH2D(), statistics are those of the filled values rather than of bin centers
+  histogram->SetEntries(entries);
+  THnSparseStats::Put(histogram, sumw, sumw2, sumwx, sumwx2);
+  return histogram;
+}
+
+TH2D *SparseHistogram::ToTH2D(const string &name) const {
+  if (axes.size() != 2) {
+    fatal() << "Sparse histogram " << params.name << " with " << axes.size() << " axes can't be saved as TH2D" << endl;
+    exit(1);
+  }
+  auto histogram = new TH2D(name.c_str(), name.c_str(), axes[0].nBins, axes[0].min, axes[0].max, axes[1].nBins,
+                            axes[1].min, axes[1].max);
+  histogram->SetDirectory(nullptr);
+  histogram->GetXaxis()->SetTitle(params.variables[0].c_str());
+  histogram->GetYaxis()->SetTitle(params.variables[1].c_str());
+  if (weighted) histogram->Sumw2();
+
+  int axesBins[2];
+  double *histogramSumw2 = weighted ? histogram->GetSumw2()->GetArray() : nullptr;
+  for (auto &[bin, content] : bins) {
+    GetAxesBins(bin, axesBins);
+    int histogramBin = histogram->GetBin(axesBins[0], axesBins[1]);
+    histogram->SetBinContent(histogramBin, content.first);
+    if (histogramSumw2) histogramSumw2[histogramBin] = content.second;
+  }
+
+  // setting bin contents resets statistics, so they're restored at the end
+  histogram->SetEntries(entries);
+  double stats[7] = {sumw, sumw2, sumwx[0], sumwx2[0], sumwx[1], sumwx2[1], sumwxy};
+  histogram->PutStats(stats);
+  return histogram;
+}
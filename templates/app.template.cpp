@@ -1,5 +1,6 @@
 #include "ConfigManager.hpp"
 #include "CutFlowManager.hpp"
+#include "EventLoop.hpp"
 #include "EventReader.hpp"
 #include "EventWriter.hpp"
 #include "ExtensionsHelpers.hpp"
@@ -14,6 +15,85 @@
 
 using namespace std;
 
+// Everything that is filled in the event loop goes into a worker. If you set nThreads > 1 in your config, the event
+// loop will run on several threads, each with its own worker, and at the end all workers are merged into one.
+struct Worker {
+  Worker(int iWorker, bool multithreaded) {
+    // Create event reader and writer, which will handle input/output trees for you.
+    // With multiple threads, each worker writes its own part of the output, merged in EventWriter::Save()
+    eventReader = make_shared<EventReader>();
+    eventWriter = make_shared<EventWriter>(eventReader, multithreaded ? iWorker : -1);
+
+    // Create a CutFlowManager to keep track of how many events passed cuts
+    cutFlowManager = make_shared<CutFlowManager>(eventReader, eventWriter);
+
+    // If you want to fill some histograms, use HistogramsHandler to automatically create histograms
+    // you need based on the config file, make them accessible to your HistogramFiller and save them at the end
+    histogramsHandler = make_shared<HistogramsHandler>();
+
+    // Create a HistogramFiller to fill default histograms
+    histogramsFiller = make_unique<HistogramsFiller>(histogramsHandler);
+
+    // If you also created your custom HistogramFiller, construct it here to use it later on in the event loop
+    // histogramsFiller = make_unique<MyHistogramsFiller>(histogramsHandler);
+
+    // Workers are created before the event loop starts, so this is a good place to read parameters from the config
+    // once, rather than for every event (the config can also be read from the event loop, on any thread).
+    auto& config = ConfigManager::GetInstance();
+    config.GetValue("myParameter", myParameter);
+
+    cutFlowManager->RegisterCut("initial");
+    cutFlowManager->RegisterCut("trigger");
+    cutFlowManager->RegisterCut("nMuons");
+  }
+
+  // Tell the event loop how to combine outputs of two workers
+  void Merge(Worker &other) {
+    histogramsHandler->Merge(*other.histogramsHandler);
+    cutFlowManager->Merge(*other.cutFlowManager);
+    eventWriter->Merge(*other.eventWriter);
+  }
+
+  shared_ptr<EventReader> eventReader;
+  shared_ptr<EventWriter> eventWriter;
+  shared_ptr<CutFlowManager> cutFlowManager;
+  shared_ptr<HistogramsHandler> histogramsHandler;
+  unique_ptr<HistogramsFiller> histogramsFiller;
+  int myParameter;
+};
+
+// This function will be called for each event
+void ProcessEvent(Worker &worker, const shared_ptr<Event> &event) {
+  // If you want to do something with one of the collections, extract it here and loop over it
+  auto physicsObjects = event->GetCollection("Muon");
+  for (auto physicsObject : *physicsObjects) {
+    float pt = physicsObject->Get("pt");
+    info() << "Physics object pt: " << pt << endl;
+    // If you also created your custom PhysicsObject class, you can convert the physics object to your object type
+    // auto myPhysicsObject = asMyPhysicsObject(physicsObject);
+
+    // do something with physicsObject (or myPhysicsObject)
+    // ...
+  }
+
+  // If you want to fill some histograms with your HistogramFiller, you can pass the event to it
+  // worker.histogramsFiller->Fill(event);
+
+  // You can apply some cuts on the event and update the cut flow
+  worker.cutFlowManager->UpdateCutFlow("initial");
+
+  bool passesTrigger = event->Get("HLT_IsoMu27");
+  if(!passesTrigger) return;
+  worker.cutFlowManager->UpdateCutFlow("trigger");
+
+  int nMuons = event->GetCollection("Muon")->size();
+  if(nMuons < 2) return;
+  worker.cutFlowManager->UpdateCutFlow("nMuons");
+
+  // If you want to store this event in the output tree, add it to the eventWriter
+  worker.eventWriter->AddCurrentEvent("Events");
+}
+
 int main(int argc, char **argv) {
   // Define required and optional arguments for your app
   vector<string> requiredArgs = {"config"};
@@ -22,32 +102,10 @@ int main(int argc, char **argv) {
   // Initialize the config with the arguments
   auto args = make_unique<ArgsManager>(argc, argv, requiredArgs, optionalArgs);
   ConfigManager::Initialize(args);
-  auto& config = ConfigManager::GetInstance();
-
-  // Create event reader and writer, which will handle input/output trees for you
-  auto eventReader = make_shared<EventReader>();
-  auto eventWriter = make_shared<EventWriter>(eventReader);
-  
-  // Create a CutFlowManager to keep track of how many events passed cuts
-  auto cutFlowManager = make_shared<CutFlowManager>(eventReader, eventWriter);
-
-  // If you want to fill some histograms, use HistogramsHandler to automatically create histograms
-  // you need based on the config file, make them accessible to your HistogramFiller and save them at the end
-  auto histogramsHandler = make_shared<HistogramsHandler>();
-  
-  // Create a HistogramFiller to fill default histograms
-  auto histogramsFiller = make_unique<HistogramsFiller>(histogramsHandler);
-  
-  // If you also created your custom HistogramFiller, construct it here to use it later on in the event loop
-  // auto histogramsFiller = make_unique<MyHistogramsFiller>(histogramsHandler);
 
   // In case you're worried about the performance of your app, you can also create a profiler
   Profiler &profiler = Profiler::GetInstance();
 
-  // You can also read any additional parameter from the config file
-  int myParameter;
-  config.GetValue("myParameter", myParameter);
-
   // You can use logger functionalities to print different types of messages
   info() << "Print some info" << endl;
   warn() << "Print some warning" << endl;
@@ -64,54 +122,21 @@ int main(int argc, char **argv) {
   sleep(2);  // perform some task
   profiler.Stop("my_second_measurement");
 
-  cutFlowManager->RegisterCut("initial");
-  cutFlowManager->RegisterCut("trigger");
-  cutFlowManager->RegisterCut("nMuons");
-
-  // Start the event loop
-  for (int iEvent = 0; iEvent < eventReader->GetNevents(); iEvent++) {
-    // Get the event
-    auto event = eventReader->GetEvent(iEvent);
-
-    // If you want to do something with one of the collections, extract it here and loop over it
-    auto physicsObjects = event->GetCollection("Muon");
-    for (auto physicsObject : *physicsObjects) {
-      float pt = physicsObject->Get("pt");
-      info() << "Physics object pt: " << pt << endl;
-      // If you also created your custom PhysicsObject class, you can convert the physics object to your object type
-      // auto myPhysicsObject = asMyPhysicsObject(physicsObject);
-
-      // do something with physicsObject (or myPhysicsObject)
-      // ...
-    }
-
-    // If you want to fill some histograms with your HistogramFiller, you can pass the event to it
-    // histogramsFiller->Fill(event);
-
-    // You can apply some cuts on the event and update the cut flow
-    cutFlowManager->UpdateCutFlow("initial");
-
-    bool passesTrigger = event->Get("HLT_IsoMu27");
-    if(!passesTrigger) continue;
-    cutFlowManager->UpdateCutFlow("trigger");
-
-    int nMuons = event->GetCollection("Muon")->size();
-    if(nMuons < 2) continue;
-    cutFlowManager->UpdateCutFlow("nMuons");
-
-    // If you want to store this event in the output tree, add it to the eventWriter
-    eventWriter->AddCurrentEvent("Events");
-  }
+  // Run the event loop. It creates workers, calls ProcessEvent for each event and returns the merged worker
+  EventLoop eventLoop;
+  bool multithreaded = eventLoop.GetNthreads() > 1;
+  auto worker = eventLoop.Run<Worker>([multithreaded](int iWorker) { return make_shared<Worker>(iWorker, multithreaded); },
+                                      ProcessEvent);
 
   // Tell histogram handler to store histograms
-  histogramsHandler->SaveHistograms();
+  worker->histogramsHandler->SaveHistograms();
 
   // Tell CutFlowManager to save the cut flow
-  cutFlowManager->SaveCutFlow();
-  cutFlowManager->Print();
+  worker->cutFlowManager->SaveCutFlow();
+  worker->cutFlowManager->Print();
 
   // Tell EventWriter to save the output tree
-  eventWriter->Save();
+  worker->eventWriter->Save();
 
   // Print results of time measurements
   profiler.Print();
@@ -121,4 +146,4 @@ int main(int argc, char **argv) {
   logger.Print();
 
   return 0;
-}
\ No newline at end of file
+}
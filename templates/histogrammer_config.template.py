@@ -26,6 +26,13 @@ histParams2D = (
   ("hit_xy", 100  , -20 , 20  , 100 , -20 , 20  ,   ""),
 )
 
+# define sparse N-dim histograms, for very fine binnings in which most bins stay empty (you will have to fill them in
+# your HistogramsFiller). Only filled bins are kept in memory. Output type can be "THnSparse" or "TH2D" (only for 2 axes).
+sparseHistParams = (
+#  name          axes: (variable, bins, min, max)                       output        dir
+  # ("abcd_plane", (("dxy", 2000, 0, 20), ("dz", 2000, 0, 20)),        "THnSparse",  "abcd"),
+)
+
 # specify name of the branch containing event weights
 weightsBranchName = "genWeight"
 